@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "connection.hpp"
+
+Connection::Connection()
+{
+	//Initialize
+	mHost = NULL;
+	mPeer = NULL;
+	mAddress.host = 0;
+	mAddress.port = 0;
+	mHandler = NULL;
+	mState = CONNECTION_WAITING;
+	mStateTime = 0;
+	mRetryDelay = 0;
+	mRoom = -1;
+	mSlot = -1;
+	mToken = 0;
+	mSessionChange = SESSION_SAME;
+	for( int i = 0; i < INPUT_HISTORY; ++i )
+	{
+		mHistory[ i ].tick = -1;
+		mHistory[ i ].buttons = 0;
+	}
+	mNewestTick = 0;
+	mRound = 0;
+	mAckTick = 0;
+	mInputTime = 0;
+	mPingTime = 0;
+}
+
+Connection::~Connection()
+{
+	//Shut down
+	close();
+}
+
+bool Connection::init( const char* hostName, int port, PacketHandler handler )
+{
+	if( enet_initialize() != 0 )
+	{
+		printf( "An error occurred while initializing ENet!\n" );
+		return false;
+	}
+
+	//Only one outgoing connection is needed
+	mHost = enet_host_create( NULL, 1, CHANNEL_COUNT, 0, 0 );
+	if( mHost == NULL )
+	{
+		printf( "An error occurred while trying to create an ENet client host!\n" );
+		return false;
+	}
+
+	enet_address_set_host( &mAddress, hostName );
+	mAddress.port = port;
+	mHandler = handler;
+
+	//Attempt straight away
+	mState = CONNECTION_WAITING;
+	mStateTime = enet_time_get();
+	mRetryDelay = 0;
+	return true;
+}
+
+void Connection::update()
+{
+	if( mHost == NULL )
+	{
+		return;
+	}
+
+	enet_uint32 now = enet_time_get();
+	if( mState == CONNECTION_WAITING && now - mStateTime >= mRetryDelay )
+	{
+		connect();
+	}
+
+	ENetEvent event;
+	while( mHost != NULL && enet_host_service( mHost, &event, 0 ) > 0 )
+	{
+		switch( event.type )
+		{
+			case ENET_EVENT_TYPE_CONNECT:
+				//Notice a dead link within a few seconds instead of ENet's default
+				enet_peer_timeout( mPeer, 0, 2000, 5000 );
+				mState = CONNECTION_CONNECTED;
+				mStateTime = now;
+
+				//It may be a restarted server with a clock of its own
+				mSync.reset();
+				mPingTime = 0;
+				break;
+
+			case ENET_EVENT_TYPE_RECEIVE:
+			{
+				WelcomeMsg welcome;
+				ClockSample sample;
+				if( decodeWelcome( event.packet->data, event.packet->dataLength, welcome ) )
+				{
+					mRoom = welcome.room;
+					mSlot = welcome.slot;
+					mToken = welcome.token;
+					mRetryDelay = 0;
+					printf( "Seated in room %d, seat %d%s.\n", mRoom, mSlot, welcome.resumed ? " again" : "" );
+
+					//Catch a held seat up on whatever it missed, a fresh one joins the room's round from the start
+					if( welcome.resumed )
+					{
+						mAckTick = welcome.lastInputTick;
+						sendInputs();
+					}
+					else
+					{
+						mSessionChange = SESSION_NEW;
+					}
+				}
+				else if( decodePong( event.packet->data, event.packet->dataLength, sample ) )
+				{
+					mSync.addSample( sample, (uint32_t)mClock.nowMicros() );
+				}
+				else if( mHandler != NULL )
+				{
+					mHandler( event.packet->data, event.packet->dataLength );
+				}
+				enet_packet_destroy( event.packet );
+				break;
+			}
+
+			case ENET_EVENT_TYPE_DISCONNECT:
+				mPeer = NULL;
+				retry( mState == CONNECTION_CONNECTED ? "Lost the connection to the server" : "Connection to the server failed" );
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	//Give up on an attempt that hangs
+	if( mState == CONNECTION_CONNECTING && now - mStateTime > CONNECT_TIMEOUT )
+	{
+		retry( "Connection to the server timed out" );
+	}
+
+	//Inputs go unreliably, so keep sending the ones not played yet when no new tick carries them
+	if( mState == CONNECTION_CONNECTED && mSlot >= 0 && mAckTick < mNewestTick && now - mInputTime >= INPUT_RESEND_INTERVAL )
+	{
+		sendInputs();
+	}
+
+	//Keep pinging, a lost ping or pong is just a missing sample
+	enet_uint32 interval = mSync.getSamples() < CLOCK_SAMPLES ? PING_INTERVAL_FAST : PING_INTERVAL;
+	if( mState == CONNECTION_CONNECTED && ( mPingTime == 0 || now - mPingTime >= interval ) )
+	{
+		ClockSample ping = { (uint32_t)mClock.nowMicros(), 0, 0 };
+		unsigned char data[ MAX_MESSAGE_SIZE ];
+		int length = encodePing( ping, data );
+		enet_peer_send( mPeer, CHANNEL_UNRELIABLE, enet_packet_create( data, length, 0 ) );
+		mPingTime = now;
+	}
+}
+
+void Connection::sendInput( const InputCmd& input )
+{
+	//Remember it in case it has to be replayed
+	mHistory[ input.tick % INPUT_HISTORY ] = input;
+	if( input.tick > mNewestTick )
+	{
+		mNewestTick = input.tick;
+	}
+
+	if( mState != CONNECTION_CONNECTED || mSlot < 0 )
+	{
+		return;
+	}
+	sendInputs();
+}
+
+void Connection::acknowledge( int tick )
+{
+	if( tick > mAckTick && tick <= mNewestTick )
+	{
+		mAckTick = tick;
+	}
+}
+
+void Connection::sendHash( const HashReport& report )
+{
+	if( mState != CONNECTION_CONNECTED || mSlot < 0 )
+	{
+		return;
+	}
+
+	//Reliable, the server holds it until it has played the tick it covers
+	unsigned char data[ MAX_MESSAGE_SIZE ];
+	int length = encodeHash( report, data );
+	enet_peer_send( mPeer, CHANNEL_RELIABLE, enet_packet_create( data, length, ENET_PACKET_FLAG_RELIABLE ) );
+}
+
+void Connection::close()
+{
+	if( mHost == NULL )
+	{
+		return;
+	}
+
+	//Say goodbye if possible, the server would time us out anyway
+	if( mPeer != NULL && mState == CONNECTION_CONNECTED )
+	{
+		enet_peer_disconnect_now( mPeer, 0 );
+	}
+	enet_host_destroy( mHost );
+	mHost = NULL;
+	mPeer = NULL;
+	enet_deinitialize();
+}
+
+SessionChange Connection::takeSessionChange()
+{
+	SessionChange change = mSessionChange;
+	mSessionChange = SESSION_SAME;
+	return change;
+}
+
+void Connection::newRound( int round )
+{
+	for( int i = 0; i < INPUT_HISTORY; ++i )
+	{
+		mHistory[ i ].tick = -1;
+	}
+	mNewestTick = 0;
+	mRound = round;
+	mAckTick = 0;
+}
+
+ConnectionState Connection::getState()
+{
+	return mState;
+}
+
+int Connection::getRoom()
+{
+	return mRoom;
+}
+
+int Connection::getSlot()
+{
+	return mSlot;
+}
+
+void Connection::connect()
+{
+	//The token asks the server for our old seat
+	mPeer = enet_host_connect( mHost, &mAddress, CHANNEL_COUNT, mToken );
+	if( mPeer == NULL )
+	{
+		retry( "No available peers for initiating an ENet connection" );
+		return;
+	}
+	mSlot = -1;
+	mState = CONNECTION_CONNECTING;
+	mStateTime = enet_time_get();
+}
+
+void Connection::retry( const char* reason )
+{
+	if( mPeer != NULL )
+	{
+		enet_peer_reset( mPeer );
+		mPeer = NULL;
+	}
+
+	//Back off exponentially, with some jitter so clients do not retry in lockstep
+	mRetryDelay = mRetryDelay == 0 ? RETRY_DELAY_MIN : mRetryDelay * 2;
+	if( mRetryDelay > RETRY_DELAY_MAX )
+	{
+		mRetryDelay = RETRY_DELAY_MAX;
+	}
+	mRetryDelay += rand() % ( mRetryDelay / 4 + 1 );
+
+	printf( "%s, retrying in %u ms.\n", reason, (unsigned)mRetryDelay );
+	mState = CONNECTION_WAITING;
+	mStateTime = enet_time_get();
+}
+
+void Connection::sendInputs()
+{
+	//Ticks older than the history are gone
+	InputBatch batch;
+	batch.round = mRound & 0xff;
+	batch.firstTick = mAckTick + 1;
+	if( batch.firstTick < mNewestTick - INPUT_HISTORY + 1 )
+	{
+		batch.firstTick = mNewestTick - INPUT_HISTORY + 1;
+	}
+
+	//Oldest first, so a server far behind still gets the ticks it needs next
+	batch.count = 0;
+	for( int tick = batch.firstTick; tick <= mNewestTick && batch.count < INPUT_BATCH; ++tick )
+	{
+		const InputCmd& input = mHistory[ tick % INPUT_HISTORY ];
+		if( input.tick != tick )
+		{
+			break;
+		}
+		batch.buttons[ batch.count++ ] = input.buttons;
+	}
+	mInputTime = enet_time_get();
+	if( batch.count == 0 )
+	{
+		return;
+	}
+
+	unsigned char data[ MAX_MESSAGE_SIZE ];
+	int length = encodeInputBatch( batch, data );
+	enet_peer_send( mPeer, CHANNEL_UNRELIABLE, enet_packet_create( data, length, 0 ) );
+}
+
+ClockSync& Connection::getClockSync()
+{
+	return mSync;
+}
+
+uint32_t Connection::getBytesSent()
+{
+	return mHost != NULL ? mHost->totalSentData : 0;
+}
+
+uint32_t Connection::getBytesReceived()
+{
+	return mHost != NULL ? mHost->totalReceivedData : 0;
+}
@@ -0,0 +1,136 @@
+//Background connection to the server that reconnects on its own
+#ifndef CONNECTION_HPP
+#define CONNECTION_HPP
+
+#include <enet/enet.h>
+#include "clock_sync.hpp"
+#include "performance_clock.hpp"
+#include "protocol.hpp"
+
+//Milliseconds a connection attempt may take before it is abandoned
+const enet_uint32 CONNECT_TIMEOUT = 3000;
+
+//Shortest and longest wait between attempts
+const enet_uint32 RETRY_DELAY_MIN = 250;
+const enet_uint32 RETRY_DELAY_MAX = 8000;
+
+//Inputs remembered for replaying to the server after a reconnect
+const int INPUT_HISTORY = 1024;
+
+//Milliseconds between resends of inputs the server has not played, while no new ones are being sent
+const enet_uint32 INPUT_RESEND_INTERVAL = 50;
+
+//Milliseconds between clock pings, quicker until the first few are back
+const enet_uint32 PING_INTERVAL = 1000;
+const enet_uint32 PING_INTERVAL_FAST = 100;
+
+//Where the connection is at
+enum ConnectionState
+{
+    CONNECTION_WAITING,
+    CONNECTION_CONNECTING,
+    CONNECTION_CONNECTED
+};
+
+//What changed about the session since the last check
+enum SessionChange
+{
+    SESSION_SAME,
+
+    //The server seated us afresh, whatever was played before is gone
+    SESSION_NEW
+};
+
+//Called with every message that is not for the connection itself
+typedef void (*PacketHandler)( const unsigned char* data, size_t length );
+
+class Connection
+{
+    public:
+        //Initializes variables
+        Connection();
+
+        //Closes the connection
+        ~Connection();
+
+        //Creates the client host, the first attempt is made by the next update
+        bool init( const char* hostName, int port, PacketHandler handler );
+
+        //Connects, retries and reads packets without blocking, call every frame
+        void update();
+
+        //Sends one tick of input along with every earlier one the server has not played, or keeps it for after the next reconnect
+        void sendInput( const InputCmd& input );
+
+        //Takes the newest input tick the server has played, older ones are no longer sent
+        void acknowledge( int tick );
+
+        //Sends a state hash if connected, a missed one is not worth replaying
+        void sendHash( const HashReport& report );
+
+        //Disconnects and destroys the host
+        void close();
+
+        //Reports a session change once
+        SessionChange takeSessionChange();
+
+        //Forgets the inputs of the last round, the next one numbers its ticks from one again
+        void newRound( int round );
+
+        //Connection accessors
+        ConnectionState getState();
+        int getRoom();
+        int getSlot();
+
+        //The server's clock as the pings worked it out
+        ClockSync& getClockSync();
+
+        //Bytes sent and received since init, ENet's headers and resends included
+        uint32_t getBytesSent();
+        uint32_t getBytesReceived();
+
+    private:
+        //Starts an attempt
+        void connect();
+
+        //Drops the attempt or connection and waits before the next one
+        void retry( const char* reason );
+
+        //Sends the remembered inputs newer than the acknowledged tick, at most INPUT_BATCH of them
+        void sendInputs();
+
+        //The client host and the server peer
+        ENetHost* mHost;
+        ENetPeer* mPeer;
+        ENetAddress mAddress;
+        PacketHandler mHandler;
+
+        //State and when it was entered
+        ConnectionState mState;
+        enet_uint32 mStateTime;
+
+        //Wait before the next attempt, doubled after each failure
+        enet_uint32 mRetryDelay;
+
+        //Seat and the token that gets it back
+        int mRoom;
+        int mSlot;
+        enet_uint32 mToken;
+        SessionChange mSessionChange;
+
+        //Recent inputs indexed by tick, and the newest tick in there
+        InputCmd mHistory[ INPUT_HISTORY ];
+        int mNewestTick;
+
+        //Round the inputs are numbered in, the newest tick the server has played and when inputs were last sent
+        int mRound;
+        int mAckTick;
+        enet_uint32 mInputTime;
+
+        //Offset to the server's clock, the clock pings are stamped with and when the last one left
+        ClockSync mSync;
+        PerformanceClock mClock;
+        enet_uint32 mPingTime;
+};
+
+#endif
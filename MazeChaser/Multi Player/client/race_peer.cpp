@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include "race_peer.hpp"
+
+RacePeer::RacePeer()
+{
+	//Initialize
+	mHost = NULL;
+	mPeer = NULL;
+	mAddress.host = ENET_HOST_ANY;
+	mAddress.port = RACE_PORT;
+	mHosting = false;
+	mConnected = false;
+	mGone = false;
+	mAttemptTime = 0;
+}
+
+RacePeer::~RacePeer()
+{
+	//Shut down
+	close();
+}
+
+bool RacePeer::init( const char* hostName )
+{
+	if( enet_initialize() != 0 )
+	{
+		printf( "An error occurred while initializing ENet!\n" );
+		return false;
+	}
+
+	//Either side only ever talks to the other one
+	mHosting = hostName == NULL;
+	if( mHosting )
+	{
+		mAddress.host = ENET_HOST_ANY;
+		mAddress.port = RACE_PORT;
+		mHost = enet_host_create( &mAddress, 1, CHANNEL_COUNT, 0, 0 );
+	}
+	else
+	{
+		enet_address_set_host( &mAddress, hostName );
+		mAddress.port = RACE_PORT;
+		mHost = enet_host_create( NULL, 1, CHANNEL_COUNT, 0, 0 );
+	}
+	if( mHost == NULL )
+	{
+		printf( "An error occurred while trying to create an ENet race host!\n" );
+		return false;
+	}
+
+	printf( mHosting ? "Waiting for the other racer on port %d.\n" : "Joining the race on port %d.\n", RACE_PORT );
+	return true;
+}
+
+void RacePeer::update( RollbackSession& session )
+{
+	if( mHost == NULL )
+	{
+		return;
+	}
+
+	//Keep knocking until the host answers
+	enet_uint32 now = enet_time_get();
+	if( !mHosting && mPeer == NULL && !mGone && ( mAttemptTime == 0 || now - mAttemptTime >= RACE_RETRY_DELAY ) )
+	{
+		mPeer = enet_host_connect( mHost, &mAddress, CHANNEL_COUNT, 0 );
+		mAttemptTime = now;
+	}
+
+	ENetEvent event;
+	while( enet_host_service( mHost, &event, 0 ) > 0 )
+	{
+		switch( event.type )
+		{
+			case ENET_EVENT_TYPE_CONNECT:
+				//The host is player 0, and the race starts for both the moment the link is up
+				mPeer = event.peer;
+				enet_peer_timeout( mPeer, 0, 2000, 5000 );
+				mConnected = true;
+				session.start( mHosting ? 0 : 1 );
+				printf( "Racing as player %d.\n", session.getLocalPlayer() + 1 );
+				break;
+
+			case ENET_EVENT_TYPE_RECEIVE:
+			{
+				RaceInputMsg msg;
+				if( mConnected && decodeRaceInput( event.packet->data, event.packet->dataLength, msg ) )
+				{
+					session.takeInputs( msg );
+				}
+				enet_packet_destroy( event.packet );
+				break;
+			}
+
+			case ENET_EVENT_TYPE_DISCONNECT:
+				//A race cannot be picked up again, the other side's state is gone
+				mPeer = NULL;
+				if( mConnected )
+				{
+					mConnected = false;
+					mGone = true;
+					printf( "The other racer left.\n" );
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+void RacePeer::send( RollbackSession& session )
+{
+	if( !mConnected )
+	{
+		return;
+	}
+
+	RaceInputMsg msg;
+	session.fillInputs( msg );
+	unsigned char data[ MAX_MESSAGE_SIZE ];
+	int length = encodeRaceInput( msg, data );
+	enet_peer_send( mPeer, CHANNEL_UNRELIABLE, enet_packet_create( data, length, 0 ) );
+	enet_host_flush( mHost );
+}
+
+void RacePeer::close()
+{
+	if( mHost == NULL )
+	{
+		return;
+	}
+
+	//Say goodbye, but do not wait for it
+	if( mPeer != NULL )
+	{
+		enet_peer_disconnect_now( mPeer, 0 );
+		mPeer = NULL;
+	}
+	enet_host_destroy( mHost );
+	mHost = NULL;
+	enet_deinitialize();
+}
+
+bool RacePeer::isHost()
+{
+	return mHosting;
+}
+
+bool RacePeer::isConnected()
+{
+	return mConnected;
+}
+
+bool RacePeer::isGone()
+{
+	return mGone;
+}
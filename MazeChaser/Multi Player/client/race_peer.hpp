@@ -0,0 +1,51 @@
+//Direct link between the two peers of a rollback race, one hosts and the other joins
+#ifndef RACE_PEER_HPP
+#define RACE_PEER_HPP
+
+#include <enet/enet.h>
+#include "rollback.hpp"
+
+//Milliseconds between attempts to reach the host
+const enet_uint32 RACE_RETRY_DELAY = 1000;
+
+class RacePeer
+{
+    public:
+        //Initializes variables
+        RacePeer();
+
+        //Closes the link
+        ~RacePeer();
+
+        //Listens on RACE_PORT when hostName is NULL, otherwise keeps trying to reach that host
+        bool init( const char* hostName );
+
+        //Connects and hands every input message to the session without blocking, call every frame
+        void update( RollbackSession& session );
+
+        //Sends the inputs the other peer still lacks, unreliably since every message repeats the ones before it
+        void send( RollbackSession& session );
+
+        //Disconnects and destroys the host
+        void close();
+
+        //Link accessors
+        bool isHost();
+        bool isConnected();
+
+        //Whether the other peer connected once and then left
+        bool isGone();
+
+    private:
+        ENetHost* mHost;
+        ENetPeer* mPeer;
+        ENetAddress mAddress;
+        bool mHosting;
+        bool mConnected;
+        bool mGone;
+
+        //When the last attempt to reach the host was made
+        enet_uint32 mAttemptTime;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include <enet/enet.h>
+#include <stdlib.h>
+#include "block_allocator.hpp"
+
+//Block storage, handed out from the top of the free stack
+alignas( 16 ) static unsigned char gBlocks[ ALLOCATOR_BLOCK_COUNT ][ ALLOCATOR_BLOCK_SIZE ];
+static unsigned char* gFreeBlocks[ ALLOCATOR_BLOCK_COUNT ];
+static size_t gFreeCount = 0;
+
+//Usage counters
+static size_t gFallbacks = 0;
+
+static void* ENET_CALLBACK blockMalloc( size_t size )
+{
+	//Serve small requests from the free stack
+	if( size <= ALLOCATOR_BLOCK_SIZE && gFreeCount > 0 )
+	{
+		return gFreeBlocks[ --gFreeCount ];
+	}
+
+	++gFallbacks;
+	return malloc( size );
+}
+
+static void ENET_CALLBACK blockFree( void* memory )
+{
+	//Blocks go back on the stack, anything else came from the heap
+	unsigned char* block = (unsigned char*)memory;
+	if( block >= &gBlocks[ 0 ][ 0 ] && block < &gBlocks[ 0 ][ 0 ] + sizeof( gBlocks ) )
+	{
+		gFreeBlocks[ gFreeCount++ ] = block;
+	}
+	else
+	{
+		free( memory );
+	}
+}
+
+bool initializeENetWithBlocks()
+{
+	//Every block starts out free
+	gFreeCount = 0;
+	for( size_t i = 0; i < ALLOCATOR_BLOCK_COUNT; ++i )
+	{
+		gFreeBlocks[ gFreeCount++ ] = gBlocks[ i ];
+	}
+	gFallbacks = 0;
+
+	ENetCallbacks callbacks = { blockMalloc, blockFree, NULL };
+	return enet_initialize_with_callbacks( ENET_VERSION, &callbacks ) == 0;
+}
+
+size_t blockAllocatorFallbacks()
+{
+	return gFallbacks;
+}
+
+size_t blockAllocatorInUse()
+{
+	return ALLOCATOR_BLOCK_COUNT - gFreeCount;
+}
@@ -0,0 +1,23 @@
+//Fixed size block allocator for ENet's own bookkeeping
+#ifndef BLOCK_ALLOCATOR_HPP
+#define BLOCK_ALLOCATOR_HPP
+
+#include <stddef.h>
+
+//Requests up to this many bytes are served from preallocated blocks
+const size_t ALLOCATOR_BLOCK_SIZE = 256;
+
+//Number of preallocated blocks
+const size_t ALLOCATOR_BLOCK_COUNT = 8192;
+
+//Initializes ENet with the block allocator installed, returns false on failure
+//ENet must then only be called from one thread at a time
+bool initializeENetWithBlocks();
+
+//Allocations that went to the heap because they were too big or every block was in use
+size_t blockAllocatorFallbacks();
+
+//Blocks currently handed out
+size_t blockAllocatorInUse();
+
+#endif
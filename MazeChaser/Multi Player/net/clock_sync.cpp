@@ -0,0 +1,157 @@
+#include "clock_sync.hpp"
+
+ClockSync::ClockSync()
+{
+	reset();
+}
+
+void ClockSync::reset()
+{
+	for( int i = 0; i < CLOCK_SAMPLES; ++i )
+	{
+		mOffsets[ i ] = 0;
+		mRoundTrips[ i ] = 0;
+	}
+	mSamples = 0;
+}
+
+void ClockSync::addSample( const ClockSample& sample, uint32_t clientReceived )
+{
+	//Time on the wire, without the time the server held the ping
+	int roundTrip = (int)( ( clientReceived - sample.clientSent ) - ( sample.serverSent - sample.serverReceived ) );
+	if( roundTrip < 0 )
+	{
+		roundTrip = 0;
+	}
+
+	//Halfway between the offsets seen each way, taken in wrapping arithmetic so the clocks' starting points do not matter
+	uint32_t out = sample.serverReceived - sample.clientSent;
+	uint32_t back = sample.serverSent - clientReceived;
+	uint32_t offset = out + (uint32_t)( (int32_t)( back - out ) / 2 );
+
+	mOffsets[ mSamples % CLOCK_SAMPLES ] = offset;
+	mRoundTrips[ mSamples % CLOCK_SAMPLES ] = roundTrip;
+	++mSamples;
+}
+
+bool ClockSync::isSynced()
+{
+	return mSamples > 0;
+}
+
+uint32_t ClockSync::toServer( uint32_t clientTime )
+{
+	//The quickest ping waited least in queues, so its two halves were the most even
+	int count = mSamples < CLOCK_SAMPLES ? mSamples : CLOCK_SAMPLES;
+	int best = 0;
+	for( int i = 1; i < count; ++i )
+	{
+		if( mRoundTrips[ i ] < mRoundTrips[ best ] )
+		{
+			best = i;
+		}
+	}
+	return clientTime + mOffsets[ best ];
+}
+
+int ClockSync::getRoundTrip()
+{
+	int count = mSamples < CLOCK_SAMPLES ? mSamples : CLOCK_SAMPLES;
+	if( count == 0 )
+	{
+		return 0;
+	}
+
+	int total = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		total += mRoundTrips[ i ];
+	}
+	return total / count;
+}
+
+int ClockSync::getSamples()
+{
+	return mSamples;
+}
+
+TickScheduler::TickScheduler( Clock& clock, int ticksPerSecond, int maxTicks ) : mClock( clock )
+{
+	mTicksPerSecond = ticksPerSecond;
+	mMaxTicks = maxTicks;
+	mLast = 0;
+	mCarry = 0;
+	mJump = 0;
+	mLead = INPUT_LEAD_TARGET * 16;
+	mRate = 1000;
+}
+
+void TickScheduler::reset()
+{
+	mLast = mClock.nowMicros();
+	mCarry = 0;
+	mJump = 0;
+	mLead = INPUT_LEAD_TARGET * 16;
+	mRate = 1000;
+}
+
+int TickScheduler::advance()
+{
+	//Microseconds times ticks per second times the rate is a billion per tick
+	uint64_t now = mClock.nowMicros();
+	mCarry += ( now - mLast ) * mTicksPerSecond * mRate;
+	mLast = now;
+
+	int ticks = mCarry / 1000000000;
+	mCarry -= (uint64_t)ticks * 1000000000;
+	if( ticks > mMaxTicks )
+	{
+		ticks = mMaxTicks;
+	}
+
+	ticks += mJump;
+	mJump = 0;
+	return ticks;
+}
+
+void TickScheduler::jump( int ticks )
+{
+	if( ticks > 0 )
+	{
+		mJump += ticks;
+	}
+}
+
+void TickScheduler::steer( int lead )
+{
+	//Smooth out the jitter, then lean against what is left of the error
+	mLead += ( lead * 16 - mLead ) / 8;
+	int rate = 1000 + ( INPUT_LEAD_TARGET * 16 - mLead ) * TICK_RATE_GAIN / 16;
+	if( rate < 1000 - TICK_RATE_RANGE )
+	{
+		rate = 1000 - TICK_RATE_RANGE;
+	}
+	if( rate > 1000 + TICK_RATE_RANGE )
+	{
+		rate = 1000 + TICK_RATE_RANGE;
+	}
+	mRate = rate;
+}
+
+int TickScheduler::getRate()
+{
+	return mRate;
+}
+
+int roundTickTarget( ClockSync& sync, const Snapshot& snapshot, uint32_t clientNow, int ticksPerSecond )
+{
+	if( !sync.isSynced() )
+	{
+		return snapshot.phaseTicks + INPUT_LEAD_TARGET;
+	}
+
+	//Where the server's round will be when an input sent now gets there, half a round trip from now on its clock
+	uint32_t arrival = sync.toServer( clientNow ) + sync.getRoundTrip() / 2;
+	int64_t sinceSnapshot = (int32_t)( arrival - snapshot.serverTime );
+	return snapshot.phaseTicks + (int)( sinceSnapshot * ticksPerSecond / 1000000 ) + INPUT_LEAD_TARGET;
+}
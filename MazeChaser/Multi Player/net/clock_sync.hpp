@@ -0,0 +1,97 @@
+//Shared time with the server and a tick rate that keeps inputs arriving just before the server plays them
+#ifndef CLOCK_SYNC_HPP
+#define CLOCK_SYNC_HPP
+
+#include <stdint.h>
+#include "clock.hpp"
+#include "protocol.hpp"
+
+//Pings remembered, the quickest of them gives the offset
+const int CLOCK_SAMPLES = 8;
+
+//Ticks early an input should reach the server, enough to ride out a little jitter
+const int INPUT_LEAD_TARGET = 2;
+
+//Most the tick rate is sped up or slowed down, in thousandths
+const int TICK_RATE_RANGE = 50;
+
+//Thousandths the tick rate changes by per tick of lead missing or to spare
+const int TICK_RATE_GAIN = 20;
+
+//Offset and round trip to the server from NTP style pings
+class ClockSync
+{
+    public:
+        //Initializes variables
+        ClockSync();
+
+        //Forgets every sample, for a new server
+        void reset();
+
+        //Takes a returned ping and the client time it came back at
+        void addSample( const ClockSample& sample, uint32_t clientReceived );
+
+        //Whether any ping has come back
+        bool isSynced();
+
+        //Server clock at a client time
+        uint32_t toServer( uint32_t clientTime );
+
+        //Mean round trip in microseconds, not counting the server's own delay
+        int getRoundTrip();
+
+        //Samples taken
+        int getSamples();
+
+    private:
+        //Server minus client clock and round trip of each kept sample
+        uint32_t mOffsets[ CLOCK_SAMPLES ];
+        int mRoundTrips[ CLOCK_SAMPLES ];
+
+        //Samples taken, the newest overwriting the oldest
+        int mSamples;
+};
+
+//Hands out ticks like a FixedStep, but runs a little fast or slow to hold the server's input lead at INPUT_LEAD_TARGET
+class TickScheduler
+{
+    public:
+        //Initializes variables, a stall of more than maxTicks is dropped rather than caught up
+        TickScheduler( Clock& clock, int ticksPerSecond, int maxTicks );
+
+        //Starts counting from now at the normal rate
+        void reset();
+
+        //Number of ticks to simulate since the last call
+        int advance();
+
+        //Hands out extra ticks on the next advance, to start a round already ahead of the server
+        void jump( int ticks );
+
+        //Takes how many ticks early the server says an input arrived
+        void steer( int lead );
+
+        //Rate ticks are handed out at, in thousandths of the normal one
+        int getRate();
+
+    private:
+        Clock& mClock;
+        int mTicksPerSecond;
+        int mMaxTicks;
+
+        //Clock at the last advance, and the part of a tick carried over from it in billionths
+        uint64_t mLast;
+        uint64_t mCarry;
+
+        //Extra ticks for the next advance
+        int mJump;
+
+        //Lead smoothed over the last few reports in sixteenths of a tick, and the rate it sets
+        int mLead;
+        int mRate;
+};
+
+//Ticks into the round the client should have played by now for its next input to reach the server INPUT_LEAD_TARGET ticks early
+int roundTickTarget( ClockSync& sync, const Snapshot& snapshot, uint32_t clientNow, int ticksPerSecond );
+
+#endif
@@ -0,0 +1,111 @@
+#include "interest.hpp"
+
+InterestBox interestBox( int dotX, int dotY, int levelWidth, int levelHeight, int margin )
+{
+	//Where the client puts its camera
+	InterestBox box = { dotX - INTEREST_VIEW_WIDTH / 2, dotY - INTEREST_VIEW_HEIGHT / 2, INTEREST_VIEW_WIDTH, INTEREST_VIEW_HEIGHT };
+	if( box.x > levelWidth - box.w )
+	{
+		box.x = levelWidth - box.w;
+	}
+	if( box.y > levelHeight - box.h )
+	{
+		box.y = levelHeight - box.h;
+	}
+	if( box.x < 0 )
+	{
+		box.x = 0;
+	}
+	if( box.y < 0 )
+	{
+		box.y = 0;
+	}
+
+	box.x -= margin;
+	box.y -= margin;
+	box.w += margin * 2;
+	box.h += margin * 2;
+	return box;
+}
+
+bool insideBox( const InterestBox& box, int x, int y )
+{
+	return x >= box.x && x < box.x + box.w && y >= box.y && y < box.y + box.h;
+}
+
+InterestGrid::InterestGrid()
+{
+	mCellSize = 1;
+	mColumns = 0;
+	mRows = 0;
+}
+
+void InterestGrid::create( int levelWidth, int levelHeight, int cellSize, int capacity )
+{
+	mCellSize = cellSize;
+	mColumns = ( levelWidth + cellSize - 1 ) / cellSize;
+	mRows = ( levelHeight + cellSize - 1 ) / cellSize;
+	mFirst.assign( mColumns * mRows, -1 );
+	mNext.assign( capacity, -1 );
+	mX.assign( capacity, 0 );
+	mY.assign( capacity, 0 );
+}
+
+void InterestGrid::clear()
+{
+	for( int i = 0; i < (int)mFirst.size(); ++i )
+	{
+		mFirst[ i ] = -1;
+	}
+}
+
+//Cell column or row of a coordinate, clamped into the grid
+static int cellOf( int n, int cellSize, int cells )
+{
+	int cell = n < 0 ? 0 : n / cellSize;
+	return cell < cells ? cell : cells - 1;
+}
+
+void InterestGrid::insert( int id, int x, int y )
+{
+	if( id < 0 || id >= (int)mNext.size() || mFirst.empty() )
+	{
+		return;
+	}
+
+	int cell = cellOf( y, mCellSize, mRows ) * mColumns + cellOf( x, mCellSize, mColumns );
+	mX[ id ] = x;
+	mY[ id ] = y;
+	mNext[ id ] = mFirst[ cell ];
+	mFirst[ cell ] = id;
+}
+
+int InterestGrid::query( const InterestBox& box, int* found, int maxFound )
+{
+	if( mFirst.empty() )
+	{
+		return 0;
+	}
+
+	//Only the cells the box overlaps, the rest of the level is never looked at
+	int left = cellOf( box.x, mCellSize, mColumns );
+	int right = cellOf( box.x + box.w - 1, mCellSize, mColumns );
+	int top = cellOf( box.y, mCellSize, mRows );
+	int bottom = cellOf( box.y + box.h - 1, mCellSize, mRows );
+
+	int count = 0;
+	for( int row = top; row <= bottom; ++row )
+	{
+		for( int column = left; column <= right; ++column )
+		{
+			for( int id = mFirst[ row * mColumns + column ]; id >= 0 && count < maxFound; id = mNext[ id ] )
+			{
+				if( insideBox( box, mX[ id ], mY[ id ] ) )
+				{
+					found[ count++ ] = id;
+				}
+			}
+		}
+	}
+	return count;
+}
@@ -0,0 +1,64 @@
+//Which dots are near enough a client's camera for it to hear about, found through a coarse grid over the level
+#ifndef INTEREST_HPP
+#define INTEREST_HPP
+
+#include <vector>
+
+//The client's camera, centred on its own dot and kept inside the level
+const int INTEREST_VIEW_WIDTH = 640;
+const int INTEREST_VIEW_HEIGHT = 320;
+
+//Pixels around the camera a dot has to come within to be sent, and the further pixels it has to go past to stop being sent,
+//so a dot on the edge does not flicker in and out
+const int INTEREST_ENTER_MARGIN = 320;
+const int INTEREST_EXIT_MARGIN = 160;
+
+//Side of a grid cell in pixels, about a camera so a query only touches a few cells
+const int INTEREST_CELL_SIZE = 640;
+
+//A box in level pixels
+struct InterestBox
+{
+    int x, y, w, h;
+};
+
+//The box a client should hear about, its camera grown by margin on every side
+InterestBox interestBox( int dotX, int dotY, int levelWidth, int levelHeight, int margin );
+
+//Whether a point is inside a box
+bool insideBox( const InterestBox& box, int x, int y );
+
+//Ids bucketed by the cell their point is in, refilled every tick without touching the heap
+class InterestGrid
+{
+    public:
+        //Initializes variables
+        InterestGrid();
+
+        //Sizes the grid to cover the level, for ids below capacity
+        void create( int levelWidth, int levelHeight, int cellSize, int capacity );
+
+        //Empties every cell
+        void clear();
+
+        //Puts an id in the cell under a point, ids outside the level go in the nearest cell
+        void insert( int id, int x, int y );
+
+        //Writes up to maxFound ids whose point is inside the box into found, returns how many
+        int query( const InterestBox& box, int* found, int maxFound );
+
+    private:
+        int mCellSize;
+        int mColumns;
+        int mRows;
+
+        //First id of each cell and the id after each one in its cell, -1 ends a cell
+        std::vector<int> mFirst;
+        std::vector<int> mNext;
+
+        //Point each id was inserted at
+        std::vector<int> mX;
+        std::vector<int> mY;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include <math.h>
+#include "link_budget.hpp"
+
+LinkBudget planLink( uint32_t rttMs, double loss, double throttle, int ticksPerSecond )
+{
+	//What a TCP flow would get on the same link, full size packets over the round trip slowed by the square root of the loss
+	double rate = LINK_BYTES_MAX;
+	if( loss > 0.0 && rttMs > 0 )
+	{
+		rate = MAX_MESSAGE_SIZE / ( rttMs / 1000.0 * sqrt( 2.0 * loss / 3.0 ) );
+	}
+	if( rate > LINK_BYTES_MAX )
+	{
+		rate = LINK_BYTES_MAX;
+	}
+
+	//ENet already drops unreliable packets when the round trip climbs, so the throttle is the quickest sign of congestion
+	rate *= throttle;
+
+	LinkBudget budget;
+	budget.bytesPerSecond = rate < LINK_BYTES_MIN ? LINK_BYTES_MIN : (int)rate;
+
+	//A full view every tick if it fits, else slow down to SNAPSHOT_INTERVAL_FULL before dropping dots and further only when no other dot fits
+	for( budget.interval = 1; budget.interval <= SNAPSHOT_INTERVAL_MAX; ++budget.interval )
+	{
+		int bytes = budget.bytesPerSecond * budget.interval / ticksPerSecond - LINK_PACKET_OVERHEAD;
+		budget.players = ROOM_PLAYERS;
+		while( budget.players > 1 && snapshotSize( budget.players ) > bytes )
+		{
+			--budget.players;
+		}
+		if( budget.players >= VIEW_PLAYERS || ( budget.interval >= SNAPSHOT_INTERVAL_FULL && budget.players > 1 ) )
+		{
+			return budget;
+		}
+	}
+	budget.interval = SNAPSHOT_INTERVAL_MAX;
+	return budget;
+}
+
+bool sameLink( const LinkBudget& a, const LinkBudget& b )
+{
+	return a.interval == b.interval && a.players == b.players;
+}
@@ -0,0 +1,42 @@
+//How much a peer's link can carry, worked out from what ENet measures, and how snapshots are cut to fit it
+#ifndef LINK_BUDGET_HPP
+#define LINK_BUDGET_HPP
+
+#include <stdint.h>
+#include "protocol.hpp"
+
+//Most snapshot bytes a second a peer is sent, a full view every tick fits
+const int LINK_BYTES_MAX = 16000;
+
+//Dots a view is budgeted for, the interest filter keeps most views to fewer and a more crowded one takes turns by priority
+const int VIEW_PLAYERS = 8;
+
+//Least a peer is budgeted however bad its link looks
+const int LINK_BYTES_MIN = 800;
+
+//UDP, IP and ENet headers around every snapshot
+const int LINK_PACKET_OVERHEAD = 40;
+
+//Ticks between snapshots a peer is slowed to before its snapshots lose dots, and the slowest it ever gets
+const int SNAPSHOT_INTERVAL_FULL = 3;
+const int SNAPSHOT_INTERVAL_MAX = 6;
+
+//What a peer is sent
+struct LinkBudget
+{
+    //Snapshot bytes a second the link is thought to carry
+    int bytesPerSecond;
+
+    //Ticks between its snapshots, and the most dots each carries with its own one
+    int interval;
+    int players;
+};
+
+//Budgets a link from its round trip in milliseconds, the fraction of packets it loses and the fraction of
+//unreliable packets ENet's throttle still lets through
+LinkBudget planLink( uint32_t rttMs, double loss, double throttle, int ticksPerSecond );
+
+//Whether two budgets send the same snapshots
+bool sameLink( const LinkBudget& a, const LinkBudget& b );
+
+#endif
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <new>
+#include "packet_pool.hpp"
+
+PacketPool::PacketPool()
+{
+	//Initialize
+	mStorage = NULL;
+	mLocalCount = 0;
+}
+
+PacketPool::~PacketPool()
+{
+	//Deallocate
+	delete[] mStorage;
+}
+
+bool PacketPool::init()
+{
+	if( mStorage != NULL )
+	{
+		return true;
+	}
+
+	mStorage = new( std::nothrow ) PacketBuffer[ CAPACITY ];
+	if( mStorage == NULL )
+	{
+		printf( "Unable to allocate %d packet buffers!\n", (int)CAPACITY );
+		return false;
+	}
+
+	//Every buffer starts out with the owner
+	for( size_t i = 0; i < CAPACITY; ++i )
+	{
+		mStorage[ i ].pool = this;
+		mStorage[ i ].length = 0;
+		mLocal[ mLocalCount++ ] = &mStorage[ i ];
+	}
+	return true;
+}
+
+PacketBuffer* PacketPool::acquire()
+{
+	//Collect what ENet returned once the local stack runs dry
+	if( mLocalCount == 0 )
+	{
+		PacketBuffer* buffer;
+		while( mLocalCount < CAPACITY && mReturned.pop( buffer ) )
+		{
+			mLocal[ mLocalCount++ ] = buffer;
+		}
+	}
+
+	if( mLocalCount == 0 )
+	{
+		return NULL;
+	}
+	return mLocal[ --mLocalCount ];
+}
+
+void PacketPool::release( PacketBuffer* buffer )
+{
+	mLocal[ mLocalCount++ ] = buffer;
+}
+
+ENetPacket* PacketPool::wrap( PacketBuffer* buffer, enet_uint32 flags )
+{
+	//Point ENet at the buffer instead of letting it copy
+	ENetPacket* packet = enet_packet_create( buffer->data, buffer->length, flags | ENET_PACKET_FLAG_NO_ALLOCATE );
+	if( packet != NULL )
+	{
+		packet->userData = buffer;
+		packet->freeCallback = onFree;
+	}
+	return packet;
+}
+
+void PacketPool::giveBack( PacketBuffer* buffer )
+{
+	buffer->pool->mReturned.push( buffer );
+}
+
+size_t PacketPool::inFlight() const
+{
+	return CAPACITY - mLocalCount - mReturned.size();
+}
+
+void ENET_CALLBACK PacketPool::onFree( ENetPacket* packet )
+{
+	//Hand the buffer back to the owner thread
+	giveBack( (PacketBuffer*)packet->userData );
+}
@@ -0,0 +1,69 @@
+//Preallocated buffers for outgoing packets that ENet sends without copying
+#ifndef PACKET_POOL_HPP
+#define PACKET_POOL_HPP
+
+#include <enet/enet.h>
+#include "protocol.hpp"
+#include "spsc_queue.hpp"
+
+class PacketPool;
+
+//One encoded message, owned by the pool while free and by ENet while in flight
+struct PacketBuffer
+{
+    //Pool to return to once ENet lets go
+    PacketPool* pool;
+
+    //Encoded length
+    int length;
+
+    //Encoded message
+    unsigned char data[ MAX_MESSAGE_SIZE ];
+};
+
+class PacketPool
+{
+    public:
+        //Number of buffers in the pool
+        static const size_t CAPACITY = 1024;
+
+        //Initializes variables
+        PacketPool();
+
+        //Deallocates every buffer
+        ~PacketPool();
+
+        //Allocates every buffer up front, call before the pool is shared between threads
+        bool init();
+
+        //Takes a free buffer, NULL if all of them are in flight (owner thread only)
+        PacketBuffer* acquire();
+
+        //Gives back a buffer that was never handed to ENet (owner thread only)
+        void release( PacketBuffer* buffer );
+
+        //Wraps a buffer in a packet that returns it here when ENet destroys it (network thread only)
+        static ENetPacket* wrap( PacketBuffer* buffer, enet_uint32 flags );
+
+        //Returns a buffer that could not be wrapped to its pool (network thread only)
+        static void giveBack( PacketBuffer* buffer );
+
+        //Buffers not currently free (owner thread only)
+        size_t inFlight() const;
+
+    private:
+        //Called by ENet when the last peer is done with a wrapped packet
+        static void ENET_CALLBACK onFree( ENetPacket* packet );
+
+        //The buffers themselves
+        PacketBuffer* mStorage;
+
+        //Buffers the owner thread can take without synchronization
+        PacketBuffer* mLocal[ CAPACITY ];
+        size_t mLocalCount;
+
+        //Buffers ENet has finished with, pushed by the network thread
+        SpscQueue<PacketBuffer*, CAPACITY> mReturned;
+};
+
+#endif
@@ -0,0 +1,305 @@
+#include "protocol.hpp"
+
+//Encoded size of one dot in a snapshot
+static const int PLAYER_STATE_SIZE = 1 + 4 + 4 + 1 + 1 + 4 + 1 + 4 + 4 + 1;
+
+//Encoded size of a snapshot before its dots
+static const int SNAPSHOT_HEADER_SIZE = 1 + 4 + 4 + 1 + 4 + 4 + 1;
+
+//Relays are sent the whole room at once, and a seat goes on the wire as one byte
+static_assert( SNAPSHOT_HEADER_SIZE + ROOM_PLAYERS * PLAYER_STATE_SIZE <= MAX_MESSAGE_SIZE, "A full room must fit in one snapshot" );
+static_assert( ROOM_PLAYERS <= 256, "Seats must fit in a byte" );
+
+int snapshotSize( int playerCount )
+{
+	return SNAPSHOT_HEADER_SIZE + playerCount * PLAYER_STATE_SIZE;
+}
+
+int byteToInt( const unsigned char* byte )
+{
+	int n = 0;
+
+	n = n + ( byte[ 0 ] & 0x000000ff );
+	n = n + ( ( byte[ 1 ] & 0x000000ff ) << 8 );
+	n = n + ( ( byte[ 2 ] & 0x000000ff ) << 16 );
+	n = n + ( ( byte[ 3 ] & 0x000000ff ) << 24 );
+
+	return n;
+}
+
+void intToByte( int n, unsigned char* result )
+{
+	result[ 0 ] = n & 0x000000ff;
+	result[ 1 ] = ( n & 0x0000ff00 ) >> 8;
+	result[ 2 ] = ( n & 0x00ff0000 ) >> 16;
+	result[ 3 ] = ( n & 0xff000000 ) >> 24;
+}
+
+int encodeWelcome( const WelcomeMsg& msg, unsigned char* out )
+{
+	out[ 0 ] = MSG_WELCOME;
+	out[ 1 ] = (unsigned char)msg.room;
+	out[ 2 ] = (unsigned char)msg.slot;
+	intToByte( (int)msg.token, out + 3 );
+	intToByte( msg.lastInputTick, out + 7 );
+	out[ 11 ] = msg.resumed ? 1 : 0;
+	return 12;
+}
+
+int encodeInputBatch( const InputBatch& batch, unsigned char* out )
+{
+	out[ 0 ] = MSG_INPUT;
+	out[ 1 ] = (unsigned char)batch.round;
+	intToByte( batch.firstTick, out + 2 );
+	out[ 6 ] = (unsigned char)batch.count;
+
+	//Low nibble first
+	for( int i = 0; i < batch.count; i += 2 )
+	{
+		unsigned char high = i + 1 < batch.count ? batch.buttons[ i + 1 ] & 0x0f : 0;
+		out[ 7 + i / 2 ] = ( batch.buttons[ i ] & 0x0f ) | ( high << 4 );
+	}
+	return 7 + ( batch.count + 1 ) / 2;
+}
+
+//Snapshots and interest changes share a dot's layout
+static void encodePlayer( const PlayerState& player, unsigned char* out )
+{
+	out[ 0 ] = (unsigned char)player.slot;
+	intToByte( player.x, out + 1 );
+	intToByte( player.y, out + 5 );
+	out[ 9 ] = (unsigned char)(signed char)player.velX;
+	out[ 10 ] = (unsigned char)(signed char)player.velY;
+	intToByte( player.lastInputTick, out + 11 );
+	out[ 15 ] = (unsigned char)(signed char)( player.inputLead < -127 ? -127 : player.inputLead > 127 ? 127 : player.inputLead );
+	intToByte( player.score, out + 16 );
+	intToByte( player.energy, out + 20 );
+	out[ 24 ] = (unsigned char)player.outcome;
+}
+
+//Returns false for a seat that does not exist, clients keep dots by seat so it would write past them
+static bool decodePlayer( const unsigned char* in, PlayerState& player )
+{
+	player.slot = in[ 0 ];
+	player.x = byteToInt( in + 1 );
+	player.y = byteToInt( in + 5 );
+	player.velX = (signed char)in[ 9 ];
+	player.velY = (signed char)in[ 10 ];
+	player.lastInputTick = byteToInt( in + 11 );
+	player.inputLead = (signed char)in[ 15 ];
+	player.score = byteToInt( in + 16 );
+	player.energy = byteToInt( in + 20 );
+	player.outcome = in[ 24 ];
+	return player.slot < ROOM_PLAYERS;
+}
+
+int encodeSnapshot( const Snapshot& snapshot, unsigned char* out )
+{
+	out[ 0 ] = MSG_SNAPSHOT;
+	intToByte( snapshot.tick, out + 1 );
+	intToByte( snapshot.round, out + 5 );
+	out[ 9 ] = (unsigned char)snapshot.phase;
+	intToByte( snapshot.phaseTicks, out + 10 );
+	intToByte( (int)snapshot.serverTime, out + 14 );
+	out[ 18 ] = (unsigned char)snapshot.playerCount;
+
+	int length = SNAPSHOT_HEADER_SIZE;
+	for( int i = 0; i < snapshot.playerCount; ++i )
+	{
+		encodePlayer( snapshot.players[ i ], out + length );
+		length += PLAYER_STATE_SIZE;
+	}
+	return length;
+}
+
+//Both hash messages share a layout
+static int encodeHashReport( unsigned char type, const HashReport& report, unsigned char* out )
+{
+	out[ 0 ] = type;
+	intToByte( report.tick, out + 1 );
+	intToByte( (int)report.hash, out + 5 );
+	return 9;
+}
+
+static bool decodeHashReport( unsigned char type, const unsigned char* data, size_t length, HashReport& report )
+{
+	if( length < 9 || data[ 0 ] != type )
+	{
+		return false;
+	}
+	report.tick = byteToInt( data + 1 );
+	report.hash = (uint32_t)byteToInt( data + 5 );
+	return true;
+}
+
+int encodeHash( const HashReport& report, unsigned char* out )
+{
+	return encodeHashReport( MSG_HASH, report, out );
+}
+
+int encodeDesync( const HashReport& report, unsigned char* out )
+{
+	return encodeHashReport( MSG_DESYNC, report, out );
+}
+
+int encodeRaceInput( const RaceInputMsg& msg, unsigned char* out )
+{
+	out[ 0 ] = MSG_RACE_INPUT;
+	intToByte( msg.ackTick, out + 1 );
+	intToByte( msg.check.tick, out + 5 );
+	intToByte( (int)msg.check.hash, out + 9 );
+	intToByte( msg.firstTick, out + 13 );
+	out[ 17 ] = msg.count;
+	for( int i = 0; i < msg.count; ++i )
+	{
+		out[ 18 + i ] = msg.buttons[ i ];
+	}
+	return 18 + msg.count;
+}
+
+int encodePing( const ClockSample& sample, unsigned char* out )
+{
+	out[ 0 ] = MSG_PING;
+	intToByte( (int)sample.clientSent, out + 1 );
+	return 5;
+}
+
+int encodePong( const ClockSample& sample, unsigned char* out )
+{
+	out[ 0 ] = MSG_PONG;
+	intToByte( (int)sample.clientSent, out + 1 );
+	intToByte( (int)sample.serverReceived, out + 5 );
+	intToByte( (int)sample.serverSent, out + 9 );
+	return 13;
+}
+
+int encodeInterest( const InterestChange& change, unsigned char* out )
+{
+	out[ 0 ] = MSG_INTEREST;
+	intToByte( change.tick, out + 1 );
+	out[ 5 ] = change.entered ? 1 : 0;
+	encodePlayer( change.player, out + 6 );
+	return 6 + PLAYER_STATE_SIZE;
+}
+
+bool decodeWelcome( const unsigned char* data, size_t length, WelcomeMsg& msg )
+{
+	if( length < 12 || data[ 0 ] != MSG_WELCOME )
+	{
+		return false;
+	}
+	msg.room = data[ 1 ];
+	msg.slot = data[ 2 ];
+	msg.token = (uint32_t)byteToInt( data + 3 );
+	msg.lastInputTick = byteToInt( data + 7 );
+	msg.resumed = data[ 11 ] != 0;
+	return true;
+}
+
+bool decodeInputBatch( const unsigned char* data, size_t length, InputBatch& batch )
+{
+	if( length < 7 || data[ 0 ] != MSG_INPUT || data[ 6 ] > INPUT_BATCH || length < 7 + (size_t)( data[ 6 ] + 1 ) / 2 )
+	{
+		return false;
+	}
+	batch.round = data[ 1 ];
+	batch.firstTick = byteToInt( data + 2 );
+	batch.count = data[ 6 ];
+	for( int i = 0; i < batch.count; ++i )
+	{
+		batch.buttons[ i ] = ( data[ 7 + i / 2 ] >> ( i % 2 * 4 ) ) & 0x0f;
+	}
+	return true;
+}
+
+bool decodeSnapshot( const unsigned char* data, size_t length, Snapshot& snapshot )
+{
+	if( length < (size_t)SNAPSHOT_HEADER_SIZE || data[ 0 ] != MSG_SNAPSHOT )
+	{
+		return false;
+	}
+	snapshot.tick = byteToInt( data + 1 );
+	snapshot.round = byteToInt( data + 5 );
+	snapshot.phase = data[ 9 ];
+	snapshot.phaseTicks = byteToInt( data + 10 );
+	snapshot.serverTime = (uint32_t)byteToInt( data + 14 );
+	snapshot.playerCount = data[ 18 ];
+	if( snapshot.playerCount > ROOM_PLAYERS || length < (size_t)snapshotSize( snapshot.playerCount ) )
+	{
+		return false;
+	}
+
+	const unsigned char* in = data + SNAPSHOT_HEADER_SIZE;
+	for( int i = 0; i < snapshot.playerCount; ++i )
+	{
+		if( !decodePlayer( in, snapshot.players[ i ] ) )
+		{
+			return false;
+		}
+		in += PLAYER_STATE_SIZE;
+	}
+	return true;
+}
+
+bool decodeHash( const unsigned char* data, size_t length, HashReport& report )
+{
+	return decodeHashReport( MSG_HASH, data, length, report );
+}
+
+bool decodeDesync( const unsigned char* data, size_t length, HashReport& report )
+{
+	return decodeHashReport( MSG_DESYNC, data, length, report );
+}
+
+bool decodeRaceInput( const unsigned char* data, size_t length, RaceInputMsg& msg )
+{
+	if( length < 18 || data[ 0 ] != MSG_RACE_INPUT || data[ 17 ] > RACE_INPUT_BATCH || length < 18 + (size_t)data[ 17 ] )
+	{
+		return false;
+	}
+	msg.ackTick = byteToInt( data + 1 );
+	msg.check.tick = byteToInt( data + 5 );
+	msg.check.hash = (uint32_t)byteToInt( data + 9 );
+	msg.firstTick = byteToInt( data + 13 );
+	msg.count = data[ 17 ];
+	for( int i = 0; i < msg.count; ++i )
+	{
+		msg.buttons[ i ] = data[ 18 + i ];
+	}
+	return true;
+}
+
+bool decodePing( const unsigned char* data, size_t length, ClockSample& sample )
+{
+	if( length < 5 || data[ 0 ] != MSG_PING )
+	{
+		return false;
+	}
+	sample.clientSent = (uint32_t)byteToInt( data + 1 );
+	sample.serverReceived = 0;
+	sample.serverSent = 0;
+	return true;
+}
+
+bool decodePong( const unsigned char* data, size_t length, ClockSample& sample )
+{
+	if( length < 13 || data[ 0 ] != MSG_PONG )
+	{
+		return false;
+	}
+	sample.clientSent = (uint32_t)byteToInt( data + 1 );
+	sample.serverReceived = (uint32_t)byteToInt( data + 5 );
+	sample.serverSent = (uint32_t)byteToInt( data + 9 );
+	return true;
+}
+
+bool decodeInterest( const unsigned char* data, size_t length, InterestChange& change )
+{
+	if( length < (size_t)( 6 + PLAYER_STATE_SIZE ) || data[ 0 ] != MSG_INTEREST )
+	{
+		return false;
+	}
+	change.tick = byteToInt( data + 1 );
+	change.entered = data[ 5 ] != 0;
+	return decodePlayer( data + 6, change.player );
+}
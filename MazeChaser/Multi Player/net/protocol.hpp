@@ -0,0 +1,202 @@
+//Wire format shared by the client and the server
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include "race.hpp"
+
+//Port the server listens on
+const int SERVER_PORT = 8123;
+
+//Port the host of a head to head race listens on
+const int RACE_PORT = 8124;
+
+//Port a spectator relay serves its viewers on
+const int RELAY_PORT = 8126;
+
+//Connect data of a relay watching a room, or'd with the room, session tokens never have this bit
+const uint32_t SPECTATE_DATA = 0x80000000u;
+
+//Ticks between the snapshots of every dot a room sends its relays
+const int SPECTATE_INTERVAL = 2;
+
+//ENet channels, one for messages that must arrive and one for ones that may be dropped
+const int CHANNEL_RELIABLE = 0;
+const int CHANNEL_UNRELIABLE = 1;
+const int CHANNEL_COUNT = 2;
+
+//Most dots a room can hold, few enough that a snapshot of all of them still fits in one message
+const int ROOM_PLAYERS = 32;
+
+//Largest message either side will encode
+const int MAX_MESSAGE_SIZE = 1200;
+
+//First byte of every packet
+enum MessageType
+{
+    MSG_WELCOME = 1,
+    MSG_INPUT = 2,
+    MSG_SNAPSHOT = 3,
+    MSG_HASH = 4,
+    MSG_DESYNC = 5,
+    MSG_RACE_INPUT = 6,
+    MSG_PING = 7,
+    MSG_PONG = 8,
+    MSG_INTEREST = 9
+};
+
+//Most ticks of input one race message carries
+const int RACE_INPUT_BATCH = 32;
+
+//Most ticks of input one input message carries, a second of them
+const int INPUT_BATCH = 64;
+
+//Tells a freshly connected client where it was seated
+struct WelcomeMsg
+{
+    int room;
+    int slot;
+
+    //Passed as connect data on a reconnect to get the same seat back
+    uint32_t token;
+
+    //Last input tick the server has for this seat, newer ones need to be sent
+    int lastInputTick;
+
+    //Whether the seat survived from an earlier connection
+    bool resumed;
+};
+
+//The keys a player held during one of its ticks
+struct InputCmd
+{
+    int tick;
+    uint8_t buttons;
+};
+
+//Every input the server has not played yet, sent unreliably each tick so a lost message is covered by the next
+struct InputBatch
+{
+    //Round the ticks are numbered in, wrapping at 256
+    int round;
+
+    //Tick of buttons[ 0 ], the rest follow one tick apart
+    int firstTick;
+    int count;
+
+    //Only the four direction bits of each go on the wire, two ticks to a byte
+    uint8_t buttons[ INPUT_BATCH ];
+};
+
+//Running state hash of a dot after one of its ticks, sent by the client and
+//echoed back with the server's own hash when the two disagree
+struct HashReport
+{
+    int tick;
+    uint32_t hash;
+};
+
+//One NTP style exchange, every time in microseconds of the sender's own clock, wrapping around
+struct ClockSample
+{
+    //When the client sent the ping, all a ping carries
+    uint32_t clientSent;
+
+    //When the server took the ping and sent the pong back
+    uint32_t serverReceived;
+    uint32_t serverSent;
+};
+
+//A run of one race peer's inputs, resent until the other peer acknowledges them
+struct RaceInputMsg
+{
+    //Newest tick up to which the sender has every input of the receiver
+    int ackTick;
+
+    //Race hash after the sender's newest settled tick that is a multiple of HASH_INTERVAL, tick 0 when there is none yet
+    HashReport check;
+
+    //Tick of buttons[ 0 ]
+    int firstTick;
+    int count;
+    uint8_t buttons[ RACE_INPUT_BATCH ];
+};
+
+//One dot as the server last simulated it
+struct PlayerState
+{
+    int slot;
+    int x, y;
+    int velX, velY;
+
+    //Last input tick the server applied for this dot
+    int lastInputTick;
+
+    //Ticks the newest input arrived before the server played it, negative if it came late
+    int inputLead;
+
+    //Standing in the current round, an Outcome
+    int score;
+    int energy;
+    int outcome;
+};
+
+//Every dot in a room at one server tick
+struct Snapshot
+{
+    int tick;
+
+    //Round of the room, its MatchPhase and the ticks spent in that phase
+    int round;
+    int phase;
+    int phaseTicks;
+
+    //Server clock when the tick was simulated, in wrapping microseconds
+    uint32_t serverTime;
+
+    int playerCount;
+    PlayerState players[ ROOM_PLAYERS ];
+};
+
+//A dot coming into or going out of a client's view, sent reliably so the client never keeps drawing one it no longer hears of
+struct InterestChange
+{
+    //Server tick of the change
+    int tick;
+    bool entered;
+
+    //The dot as it was then
+    PlayerState player;
+};
+
+//Encoded size of a snapshot carrying the given number of dots
+int snapshotSize( int playerCount );
+
+//Little endian integer packing
+int byteToInt( const unsigned char* byte );
+void intToByte( int n, unsigned char* result );
+
+//Encoders write into out (at least MAX_MESSAGE_SIZE bytes) and return the encoded length
+int encodeWelcome( const WelcomeMsg& msg, unsigned char* out );
+int encodeInputBatch( const InputBatch& batch, unsigned char* out );
+int encodeSnapshot( const Snapshot& snapshot, unsigned char* out );
+int encodeHash( const HashReport& report, unsigned char* out );
+int encodeDesync( const HashReport& report, unsigned char* out );
+int encodeRaceInput( const RaceInputMsg& msg, unsigned char* out );
+int encodePing( const ClockSample& sample, unsigned char* out );
+int encodePong( const ClockSample& sample, unsigned char* out );
+int encodeInterest( const InterestChange& change, unsigned char* out );
+
+//Decoders return false if the data is not a complete message of that type
+bool decodeWelcome( const unsigned char* data, size_t length, WelcomeMsg& msg );
+bool decodeInputBatch( const unsigned char* data, size_t length, InputBatch& batch );
+bool decodeSnapshot( const unsigned char* data, size_t length, Snapshot& snapshot );
+bool decodeHash( const unsigned char* data, size_t length, HashReport& report );
+bool decodeDesync( const unsigned char* data, size_t length, HashReport& report );
+bool decodeRaceInput( const unsigned char* data, size_t length, RaceInputMsg& msg );
+bool decodePing( const unsigned char* data, size_t length, ClockSample& sample );
+bool decodePong( const unsigned char* data, size_t length, ClockSample& sample );
+bool decodeInterest( const unsigned char* data, size_t length, InterestChange& change );
+
+#endif
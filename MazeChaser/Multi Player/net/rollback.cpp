@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include "rollback.hpp"
+
+RollbackSession::RollbackSession( int window )
+{
+	mWindow = window;
+	mSaved.create( sizeof( RaceState ), ROLLBACK_RING );
+	start( 0 );
+}
+
+void RollbackSession::start( int localPlayer )
+{
+	mLocal = localPlayer;
+	resetRace( mState );
+	mSaved.clear();
+
+	//The first ticks of both players fall inside the input delay, so both peers know them to be empty
+	for( int i = 0; i < ROLLBACK_RING; ++i )
+	{
+		mLocalInputs[ i ] = 0;
+		mRemoteInputs[ i ] = 0;
+		mRemoteTicks[ i ] = i <= ROLLBACK_INPUT_DELAY ? i : -1;
+		mUsedInputs[ i ] = 0;
+		mHashes[ i ] = 0;
+		mHashTicks[ i ] = -1;
+	}
+	mLocalNewest = ROLLBACK_INPUT_DELAY;
+	mRemoteConfirmed = ROLLBACK_INPUT_DELAY;
+	mRollbackTo = 0;
+	mPeerAck = ROLLBACK_INPUT_DELAY;
+	mAckOwed = false;
+	mRollbacks = 0;
+	mResimulatedTicks = 0;
+	mPeerCheck.tick = 0;
+	mPeerCheck.hash = 0;
+	mDesyncTick = 0;
+}
+
+bool RollbackSession::canAdvance()
+{
+	return mState.tick + 1 - mRemoteConfirmed <= mWindow;
+}
+
+void RollbackSession::advance( uint8_t localButtons, CollisionGrid& walls, int levelWidth, int levelHeight )
+{
+	//The keys held now are played ROLLBACK_INPUT_DELAY ticks from now
+	++mLocalNewest;
+	mLocalInputs[ mLocalNewest % ROLLBACK_RING ] = localButtons;
+
+	rollback( walls, levelWidth, levelHeight );
+	simulate( walls, levelWidth, levelHeight );
+	checkPeer();
+}
+
+void RollbackSession::rollback( CollisionGrid& walls, int levelWidth, int levelHeight )
+{
+	//Go back to just before the first wrong guess and play forward with what is known now
+	if( mRollbackTo > 0 )
+	{
+		int newest = mState.tick;
+		mSaved.restore( mRollbackTo - 1, &mState );
+		while( mState.tick < newest )
+		{
+			simulate( walls, levelWidth, levelHeight );
+			++mResimulatedTicks;
+		}
+		++mRollbacks;
+		mRollbackTo = 0;
+		checkPeer();
+	}
+}
+
+bool RollbackSession::isOver()
+{
+	//A guess can finish the other dot, so only the race as of the settled tick counts
+	int tick = settledTick();
+	if( tick == mState.tick )
+	{
+		return raceOver( mState );
+	}
+	RaceState settled;
+	return mSaved.restore( tick, &settled ) && raceOver( settled );
+}
+
+void RollbackSession::simulate( CollisionGrid& walls, int levelWidth, int levelHeight )
+{
+	mSaved.save( mState.tick, &mState );
+
+	int tick = mState.tick + 1;
+	uint8_t buttons[ RACE_PLAYERS ];
+	buttons[ mLocal ] = mLocalInputs[ tick % ROLLBACK_RING ];
+	buttons[ 1 - mLocal ] = remoteInput( tick );
+	mUsedInputs[ tick % ROLLBACK_RING ] = buttons[ 1 - mLocal ];
+
+	stepRace( mState, buttons, walls, levelWidth, levelHeight );
+	mHashes[ tick % ROLLBACK_RING ] = hashRace( mState );
+	mHashTicks[ tick % ROLLBACK_RING ] = tick;
+}
+
+int RollbackSession::settledTick()
+{
+	//Simulated, every input known, and not waiting on a rollback
+	int tick = mState.tick < mRemoteConfirmed ? mState.tick : mRemoteConfirmed;
+	if( mRollbackTo > 0 && mRollbackTo - 1 < tick )
+	{
+		tick = mRollbackTo - 1;
+	}
+	return tick;
+}
+
+void RollbackSession::checkPeer()
+{
+	if( mPeerCheck.tick == 0 || mPeerCheck.tick > settledTick() )
+	{
+		return;
+	}
+
+	//Only the first difference matters, everything after it differs too
+	int index = mPeerCheck.tick % ROLLBACK_RING;
+	if( mHashTicks[ index ] == mPeerCheck.tick && mHashes[ index ] != mPeerCheck.hash && mDesyncTick == 0 )
+	{
+		mDesyncTick = mPeerCheck.tick;
+		printf( "Race desynced by tick %d! Local hash %08x, other racer's %08x\n", mDesyncTick, mHashes[ index ], mPeerCheck.hash );
+	}
+	mPeerCheck.tick = 0;
+}
+
+uint8_t RollbackSession::remoteInput( int tick )
+{
+	if( mRemoteTicks[ tick % ROLLBACK_RING ] == tick )
+	{
+		return mRemoteInputs[ tick % ROLLBACK_RING ];
+	}
+
+	//Players mostly keep holding what they held
+	return mRemoteInputs[ mRemoteConfirmed % ROLLBACK_RING ];
+}
+
+void RollbackSession::addRemoteInput( int tick, uint8_t buttons )
+{
+	//Already known, or too far ahead to keep
+	if( tick <= mRemoteConfirmed || mRemoteTicks[ tick % ROLLBACK_RING ] == tick || tick >= mRemoteConfirmed + ROLLBACK_RING )
+	{
+		return;
+	}
+	mRemoteInputs[ tick % ROLLBACK_RING ] = buttons;
+	mRemoteTicks[ tick % ROLLBACK_RING ] = tick;
+	while( mRemoteTicks[ ( mRemoteConfirmed + 1 ) % ROLLBACK_RING ] == mRemoteConfirmed + 1 )
+	{
+		++mRemoteConfirmed;
+	}
+
+	//A tick already played on a wrong guess has to be played again
+	if( tick <= mState.tick && mUsedInputs[ tick % ROLLBACK_RING ] != buttons && ( mRollbackTo == 0 || tick < mRollbackTo ) )
+	{
+		mRollbackTo = tick;
+	}
+}
+
+void RollbackSession::takeInputs( const RaceInputMsg& msg )
+{
+	if( msg.ackTick > mPeerAck && msg.ackTick <= mLocalNewest )
+	{
+		mPeerAck = msg.ackTick;
+	}
+	for( int i = 0; i < msg.count; ++i )
+	{
+		addRemoteInput( msg.firstTick + i, msg.buttons[ i ] );
+	}
+
+	//Inputs come again until the other peer hears they arrived
+	if( msg.count > 0 )
+	{
+		mAckOwed = true;
+	}
+
+	//Keep the newest hash, it waits until this side has settled its tick
+	if( msg.check.tick > mPeerCheck.tick )
+	{
+		mPeerCheck = msg.check;
+	}
+	checkPeer();
+}
+
+void RollbackSession::fillInputs( RaceInputMsg& msg )
+{
+	//Oldest unacknowledged first, the rest go with the next message
+	msg.ackTick = mRemoteConfirmed;
+	mAckOwed = false;
+
+	//The newest settled tick on the hash interval, if it is still held
+	msg.check.tick = settledTick() / HASH_INTERVAL * HASH_INTERVAL;
+	msg.check.hash = mHashes[ msg.check.tick % ROLLBACK_RING ];
+	if( msg.check.tick == 0 || mHashTicks[ msg.check.tick % ROLLBACK_RING ] != msg.check.tick )
+	{
+		msg.check.tick = 0;
+	}
+	msg.firstTick = mPeerAck + 1;
+	msg.count = mLocalNewest - mPeerAck;
+	if( msg.count > RACE_INPUT_BATCH )
+	{
+		msg.count = RACE_INPUT_BATCH;
+	}
+	for( int i = 0; i < msg.count; ++i )
+	{
+		msg.buttons[ i ] = mLocalInputs[ ( msg.firstTick + i ) % ROLLBACK_RING ];
+	}
+}
+
+bool RollbackSession::isAcknowledged()
+{
+	return mPeerAck >= mLocalNewest;
+}
+
+bool RollbackSession::owesAck()
+{
+	return mAckOwed;
+}
+
+const RaceState& RollbackSession::getState()
+{
+	return mState;
+}
+
+int RollbackSession::getLocalPlayer()
+{
+	return mLocal;
+}
+
+int RollbackSession::getConfirmedTick()
+{
+	return mRemoteConfirmed;
+}
+
+int RollbackSession::getRollbacks()
+{
+	return mRollbacks;
+}
+
+int RollbackSession::getResimulatedTicks()
+{
+	return mResimulatedTicks;
+}
+
+int RollbackSession::getDesyncTick()
+{
+	return mDesyncTick;
+}
@@ -0,0 +1,124 @@
+//Rollback netcode for a head to head race, the other peer's keys are guessed and the race is rerun when a guess was wrong,
+//or with a window of 0 plain lockstep where nothing is ever guessed
+#ifndef ROLLBACK_HPP
+#define ROLLBACK_HPP
+
+#include <stdint.h>
+#include "collision_grid.hpp"
+#include "protocol.hpp"
+#include "race.hpp"
+#include "state_hash.hpp"
+#include "state_ring.hpp"
+
+//Most ticks the race may run past the other peer's newest known input
+const int ROLLBACK_WINDOW = 16;
+
+//Ticks between pressing a key and it taking effect, hides most of a short round trip without any rollback
+const int ROLLBACK_INPUT_DELAY = 2;
+
+//Ticks of inputs and saved states kept, comfortably more than can ever be rolled back
+const int ROLLBACK_RING = 64;
+
+class RollbackSession
+{
+    public:
+        //Initializes variables, the race may run up to window ticks past the other peer's newest known input
+        RollbackSession( int window );
+
+        //Starts a race as player 0 or 1
+        void start( int localPlayer );
+
+        //Whether the next tick can be simulated without guessing more than the window ahead
+        bool canAdvance();
+
+        //Reruns the race from the first wrong guess if there was one, then simulates the next tick with the keys held now
+        void advance( uint8_t localButtons, CollisionGrid& walls, int levelWidth, int levelHeight );
+
+        //Reruns the race from the first wrong guess if there was one, without simulating a new tick
+        void rollback( CollisionGrid& walls, int levelWidth, int levelHeight );
+
+        //Whether the race is over as of a tick whose every input is known, so no rollback can change how it ended
+        bool isOver();
+
+        //Takes the other peer's inputs and acknowledgement
+        void takeInputs( const RaceInputMsg& msg );
+
+        //Fills a message with the local inputs the other peer has not acknowledged
+        void fillInputs( RaceInputMsg& msg );
+
+        //Whether the other peer has acknowledged every local input
+        bool isAcknowledged();
+
+        //Whether the other peer sent inputs since the last message told it which ones this side has
+        bool owesAck();
+
+        //The race as of the newest simulated tick
+        const RaceState& getState();
+
+        //Session accessors
+        int getLocalPlayer();
+        int getConfirmedTick();
+        int getRollbacks();
+        int getResimulatedTicks();
+
+        //First tick whose hash differed from the other peer's, 0 while the races agree
+        int getDesyncTick();
+
+    private:
+        //Takes the other peer's input for one tick
+        void addRemoteInput( int tick, uint8_t buttons );
+
+        //The other peer's input for a tick, or the newest one known in a row if it has not arrived
+        uint8_t remoteInput( int tick );
+
+        //Saves the state and simulates one tick
+        void simulate( CollisionGrid& walls, int levelWidth, int levelHeight );
+
+        //Newest tick no input still to come can change
+        int settledTick();
+
+        //Compares the other peer's hash once this side has settled that tick
+        void checkPeer();
+
+        int mLocal;
+        int mWindow;
+        RaceState mState;
+
+        //State as each tick started
+        StateRing mSaved;
+
+        //Local inputs for tick t in slot t % ROLLBACK_RING, and the newest tick that has one
+        uint8_t mLocalInputs[ ROLLBACK_RING ];
+        int mLocalNewest;
+
+        //Remote inputs, the tick each slot holds, and the newest tick up to which every one is known
+        uint8_t mRemoteInputs[ ROLLBACK_RING ];
+        int mRemoteTicks[ ROLLBACK_RING ];
+        int mRemoteConfirmed;
+
+        //Remote input each simulated tick used
+        uint8_t mUsedInputs[ ROLLBACK_RING ];
+
+        //First simulated tick whose guess turned out wrong, 0 if none
+        int mRollbackTo;
+
+        //Newest local tick the other peer has
+        int mPeerAck;
+
+        //Whether inputs arrived since the last message was filled
+        bool mAckOwed;
+
+        //Rollbacks done and ticks rerun by them
+        int mRollbacks;
+        int mResimulatedTicks;
+
+        //Race hash after each simulated tick and the tick each slot holds
+        uint32_t mHashes[ ROLLBACK_RING ];
+        int mHashTicks[ ROLLBACK_RING ];
+
+        //The other peer's newest hash not checked yet, and the first tick found to differ
+        HashReport mPeerCheck;
+        int mDesyncTick;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "snapshot_priority.hpp"
+
+PriorityAccumulator::PriorityAccumulator()
+{
+	for( int viewer = 0; viewer < ROOM_PLAYERS; ++viewer )
+	{
+		reset( viewer );
+	}
+}
+
+void PriorityAccumulator::reset( int viewer )
+{
+	for( int other = 0; other < ROOM_PLAYERS; ++other )
+	{
+		mPriority[ viewer ][ other ] = 0;
+	}
+}
+
+void PriorityAccumulator::accumulate( int viewer, int other, int distance )
+{
+	//Near dots pile up quickly, but even the farthest one comes round eventually
+	mPriority[ viewer ][ other ] += 1 + PRIORITY_GAIN * PRIORITY_NEAR / ( PRIORITY_NEAR + distance );
+}
+
+int PriorityAccumulator::pick( int viewer, const bool* candidates, int count, int* picked )
+{
+	bool taken[ ROOM_PLAYERS ] = {};
+	int found = 0;
+	while( found < count )
+	{
+		int best = -1;
+		for( int other = 0; other < ROOM_PLAYERS; ++other )
+		{
+			if( candidates[ other ] && !taken[ other ] && other != viewer && ( best < 0 || mPriority[ viewer ][ other ] > mPriority[ viewer ][ best ] ) )
+			{
+				best = other;
+			}
+		}
+		if( best < 0 )
+		{
+			break;
+		}
+		taken[ best ] = true;
+		mPriority[ viewer ][ best ] = 0;
+		picked[ found++ ] = best;
+	}
+	return found;
+}
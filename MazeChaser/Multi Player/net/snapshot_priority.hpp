@@ -0,0 +1,33 @@
+//Which other dots each seat hears about when its snapshots cannot carry them all
+#ifndef SNAPSHOT_PRIORITY_HPP
+#define SNAPSHOT_PRIORITY_HPP
+
+#include "protocol.hpp"
+
+//Distance in pixels at which a dot gains priority half as fast as one right beside the viewer
+const int PRIORITY_NEAR = 512;
+
+//Priority a dot right beside the viewer gains a tick, one far away gains 1
+const int PRIORITY_GAIN = 16;
+
+class PriorityAccumulator
+{
+    public:
+        //Initializes variables
+        PriorityAccumulator();
+
+        //Forgets what a seat is owed, for a new client in it
+        void reset( int viewer );
+
+        //Adds a tick of priority for another dot at the given distance from a viewer's dot
+        void accumulate( int viewer, int other, int distance );
+
+        //Picks up to count of the candidate seats, those owed most first, and starts them over, returns how many
+        int pick( int viewer, const bool* candidates, int count, int* picked );
+
+    private:
+        //What each viewer is owed of every other seat
+        int mPriority[ ROOM_PLAYERS ][ ROOM_PLAYERS ];
+};
+
+#endif
@@ -0,0 +1,60 @@
+//Lock-free queue for handing items from exactly one producer thread to exactly one consumer thread
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <stddef.h>
+
+template<typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert( CAPACITY > 0 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "SpscQueue capacity must be a power of two" );
+
+    public:
+        //Initializes an empty queue
+        SpscQueue() : mHead( 0 ), mTail( 0 ) {}
+
+        //Copies an item in, returns false if the queue is full (producer only)
+        bool push( const T& item )
+        {
+            size_t tail = mTail.load( std::memory_order_relaxed );
+            if( tail - mHead.load( std::memory_order_acquire ) == CAPACITY )
+            {
+                return false;
+            }
+            mItems[ tail & ( CAPACITY - 1 ) ] = item;
+            mTail.store( tail + 1, std::memory_order_release );
+            return true;
+        }
+
+        //Copies the oldest item out, returns false if the queue is empty (consumer only)
+        bool pop( T& item )
+        {
+            size_t head = mHead.load( std::memory_order_relaxed );
+            if( head == mTail.load( std::memory_order_acquire ) )
+            {
+                return false;
+            }
+            item = mItems[ head & ( CAPACITY - 1 ) ];
+            mHead.store( head + 1, std::memory_order_release );
+            return true;
+        }
+
+        //Number of queued items, only a hint while the other side is running
+        size_t size() const
+        {
+            return mTail.load( std::memory_order_acquire ) - mHead.load( std::memory_order_acquire );
+        }
+
+    private:
+        //Read position, only advanced by the consumer
+        alignas( 64 ) std::atomic<size_t> mHead;
+
+        //Write position, only advanced by the producer
+        alignas( 64 ) std::atomic<size_t> mTail;
+
+        //Ring storage
+        alignas( 64 ) T mItems[ CAPACITY ];
+};
+
+#endif
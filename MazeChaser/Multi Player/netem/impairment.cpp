@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <string.h>
+#include "impairment.hpp"
+
+static const ImpairmentProfile PROFILES[] =
+{
+	//name, delay, jitter, loss, duplicate, reorder, rate, queue
+	{ "clean", 0, 0, 0.0, 0.0, 0.0, 0, 0 },
+	{ "lan", 1, 1, 0.0, 0.0, 0.0, 0, 0 },
+	{ "wifi", 15, 10, 1.0, 0.2, 1.0, 0, 0 },
+	{ "dsl", 30, 5, 0.5, 0.0, 0.0, 64000, 200 },
+	{ "transatlantic", 60, 8, 0.5, 0.0, 0.5, 0, 0 },
+	{ "mobile", 80, 40, 3.0, 0.5, 5.0, 32000, 300 },
+	{ "awful", 150, 60, 10.0, 1.0, 10.0, 8000, 500 }
+};
+
+const ImpairmentProfile* findProfile( const char* name )
+{
+	for( size_t i = 0; i < sizeof( PROFILES ) / sizeof( PROFILES[ 0 ] ); ++i )
+	{
+		if( strcmp( PROFILES[ i ].name, name ) == 0 )
+		{
+			return &PROFILES[ i ];
+		}
+	}
+	return NULL;
+}
+
+void printProfiles()
+{
+	for( size_t i = 0; i < sizeof( PROFILES ) / sizeof( PROFILES[ 0 ] ); ++i )
+	{
+		const ImpairmentProfile& profile = PROFILES[ i ];
+		printf( "%-14s %3d+-%-3d ms, %4.1f%% loss, %3.1f%% duplicated, %4.1f%% reordered", profile.name, profile.delayMs, profile.jitterMs, profile.lossPercent, profile.duplicatePercent, profile.reorderPercent );
+		if( profile.rateBytes > 0 )
+		{
+			printf( ", %d B/s with %d ms of queue", profile.rateBytes, profile.queueMs );
+		}
+		printf( "\n" );
+	}
+}
+
+ImpairedLink::ImpairedLink()
+{
+	init( PROFILES[ 0 ], 1 );
+}
+
+void ImpairedLink::init( const ImpairmentProfile& profile, uint32_t seed )
+{
+	mProfile = profile;
+	mState = seed != 0 ? seed : 1;
+	mFreeAt = 0;
+	mLastDue = 0;
+	memset( &mStats, 0, sizeof( mStats ) );
+}
+
+uint32_t ImpairedLink::random()
+{
+	mState ^= mState << 13;
+	mState ^= mState >> 17;
+	mState ^= mState << 5;
+	return mState;
+}
+
+bool ImpairedLink::chance( double percent )
+{
+	return random() % 1000000 < percent * 10000.0;
+}
+
+int ImpairedLink::send( uint64_t nowMicros, int size, uint64_t* due )
+{
+	++mStats.packets;
+	mStats.bytes += size;
+
+	//Every draw happens for every packet, so a packet's fate only depends on the seed and how many came before it
+	bool lost = chance( mProfile.lossPercent );
+	bool duplicated = chance( mProfile.duplicatePercent );
+	bool reordered = chance( mProfile.reorderPercent );
+	int copies = duplicated ? 2 : 1;
+	int jitter[ IMPAIRMENT_COPIES ];
+	for( int i = 0; i < IMPAIRMENT_COPIES; ++i )
+	{
+		jitter[ i ] = mProfile.jitterMs > 0 ? (int)( random() % ( 2 * mProfile.jitterMs * 1000 + 1 ) ) - mProfile.jitterMs * 1000 : 0;
+	}
+	if( lost )
+	{
+		++mStats.lost;
+		return 0;
+	}
+
+	//A capped link sends one packet after another and drops what would wait too long
+	uint64_t start = nowMicros;
+	if( mProfile.rateBytes > 0 )
+	{
+		if( mFreeAt > nowMicros + (uint64_t)mProfile.queueMs * 1000 )
+		{
+			++mStats.queueDropped;
+			return 0;
+		}
+		start = mFreeAt > nowMicros ? mFreeAt : nowMicros;
+		mFreeAt = start + (uint64_t)size * 1000000 / mProfile.rateBytes;
+		start = mFreeAt;
+	}
+
+	for( int i = 0; i < copies; ++i )
+	{
+		int64_t delay = (int64_t)mProfile.delayMs * 1000 + jitter[ i ];
+		due[ i ] = start + ( delay > 0 ? delay : 0 );
+
+		//Jitter alone keeps packets in order, only a reordered one may overtake
+		if( due[ i ] < mLastDue )
+		{
+			if( reordered )
+			{
+				++mStats.reordered;
+			}
+			else
+			{
+				due[ i ] = mLastDue;
+			}
+		}
+		else
+		{
+			mLastDue = due[ i ];
+		}
+
+		++mStats.delivered;
+		mStats.deliveredBytes += size;
+		mStats.delayMicros += due[ i ] - nowMicros;
+	}
+	if( duplicated )
+	{
+		++mStats.duplicated;
+	}
+	return copies;
+}
+
+const LinkStats& ImpairedLink::getStats()
+{
+	return mStats;
+}
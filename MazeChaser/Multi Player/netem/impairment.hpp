@@ -0,0 +1,86 @@
+//A seeded model of a bad link, deciding for every packet whether it arrives, how many times and when
+#ifndef IMPAIRMENT_HPP
+#define IMPAIRMENT_HPP
+
+#include <stdint.h>
+
+//How bad a link is, the same both ways
+struct ImpairmentProfile
+{
+    const char* name;
+
+    //One way delay and how far either side of it a packet may land, in milliseconds
+    int delayMs;
+    int jitterMs;
+
+    //Percent of packets lost, sent twice, and let past the ones before them
+    double lossPercent;
+    double duplicatePercent;
+    double reorderPercent;
+
+    //Bytes a second the link carries, 0 for no cap, and milliseconds of packets it queues before dropping more
+    int rateBytes;
+    int queueMs;
+};
+
+//The named profile, NULL if there is none
+const ImpairmentProfile* findProfile( const char* name );
+
+//Prints every profile
+void printProfiles();
+
+//What a link did with its packets
+struct LinkStats
+{
+    int packets;
+    int bytes;
+
+    //Packets dropped at random and for want of queue room
+    int lost;
+    int queueDropped;
+
+    int duplicated;
+    int reordered;
+
+    //Copies sent on, their bytes and the microseconds the link held them in total
+    int delivered;
+    int deliveredBytes;
+    uint64_t delayMicros;
+};
+
+//Most copies one packet can turn into
+const int IMPAIRMENT_COPIES = 2;
+
+class ImpairedLink
+{
+    public:
+        //Initializes variables
+        ImpairedLink();
+
+        //Starts the link over with a profile, the same seed and packets always give the same fates
+        void init( const ImpairmentProfile& profile, uint32_t seed );
+
+        //Decides the fate of a packet sent at nowMicros, writes when each copy arrives into due and returns how many there are
+        int send( uint64_t nowMicros, int size, uint64_t* due );
+
+        //Totals since init
+        const LinkStats& getStats();
+
+    private:
+        //Xorshift
+        uint32_t random();
+
+        //True percent times in a hundred
+        bool chance( double percent );
+
+        ImpairmentProfile mProfile;
+        uint32_t mState;
+
+        //When the link is done sending what it has queued, and when the newest packet in order arrives
+        uint64_t mFreeAt;
+        uint64_t mLastDue;
+
+        LinkStats mStats;
+};
+
+#endif
@@ -0,0 +1,398 @@
+//UDP proxy between clients and the server that makes the link as bad as a profile says, the same way every run for a seed
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <queue>
+#include <vector>
+#include "impairment.hpp"
+
+//Port clients connect to instead of the server's
+const int NETEM_PORT = 8125;
+
+//Most clients passed through at once
+const int NETEM_FLOWS = 64;
+
+//Largest datagram passed on
+const int NETEM_DATAGRAM = 2048;
+
+//Milliseconds between reports
+const int NETEM_REPORT_INTERVAL = 1000;
+
+//Milliseconds a client may go quiet before its flow is freed
+const int NETEM_FLOW_TIMEOUT = 30000;
+
+//One client and its own socket to the server, so the server tells clients apart as it would without the proxy
+struct Flow
+{
+	bool used;
+	struct sockaddr_in client;
+	int upstream;
+	uint64_t lastHeard;
+
+	//Client to server and server to client
+	ImpairedLink up;
+	ImpairedLink down;
+};
+
+//A packet held by the link until it is due
+struct Pending
+{
+	uint64_t due;
+
+	//Order it was held in, so packets due together leave in order
+	uint64_t order;
+
+	int flow;
+	bool toServer;
+	std::vector<unsigned char> data;
+};
+
+//Soonest due first
+struct PendingLater
+{
+	bool operator()( const Pending& a, const Pending& b ) const
+	{
+		return a.due != b.due ? a.due > b.due : a.order > b.order;
+	}
+};
+
+//Cleared by Ctrl+C to print the totals and stop
+volatile sig_atomic_t gRunning = 1;
+
+void stop( int )
+{
+	gRunning = 0;
+}
+
+//Microseconds of the monotonic clock
+uint64_t nowMicros()
+{
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+//Adds one link's totals to another's
+void addStats( LinkStats& total, const LinkStats& stats )
+{
+	total.packets += stats.packets;
+	total.bytes += stats.bytes;
+	total.lost += stats.lost;
+	total.queueDropped += stats.queueDropped;
+	total.duplicated += stats.duplicated;
+	total.reordered += stats.reordered;
+	total.delivered += stats.delivered;
+	total.deliveredBytes += stats.deliveredBytes;
+	total.delayMicros += stats.delayMicros;
+}
+
+//Prints one direction, the change since last against seconds
+void printDirection( const char* name, const LinkStats& now, const LinkStats& last, double seconds )
+{
+	int delivered = now.delivered - last.delivered;
+	printf( "  %-6s %6d packets, %8.0f B/s in, %8.0f B/s out, %4d lost, %4d queue drops, %3d duplicated, %3d reordered, %6.1f ms held\n",
+		name, now.packets - last.packets, ( now.bytes - last.bytes ) / seconds, ( now.deliveredBytes - last.deliveredBytes ) / seconds,
+		now.lost - last.lost, now.queueDropped - last.queueDropped, now.duplicated - last.duplicated, now.reordered - last.reordered,
+		delivered > 0 ? ( now.delayMicros - last.delayMicros ) / 1000.0 / delivered : 0.0 );
+}
+
+//Prints what every flow's links, and those of flows already freed, did since the last report
+void report( Flow* flows, const LinkStats& freedUp, const LinkStats& freedDown, LinkStats& lastUp, LinkStats& lastDown, double seconds, const char* title )
+{
+	LinkStats up = freedUp;
+	LinkStats down = freedDown;
+	int clients = 0;
+	for( int i = 0; i < NETEM_FLOWS; ++i )
+	{
+		addStats( up, flows[ i ].up.getStats() );
+		addStats( down, flows[ i ].down.getStats() );
+		if( flows[ i ].used )
+		{
+			++clients;
+		}
+	}
+
+	printf( "%s, %d clients\n", title, clients );
+	printDirection( "up", up, lastUp, seconds );
+	printDirection( "down", down, lastDown, seconds );
+	fflush( stdout );
+	lastUp = up;
+	lastDown = down;
+}
+
+int main( int argc, char* args[] )
+{
+	const ImpairmentProfile* named = findProfile( "lan" );
+	uint32_t seed = 1;
+	int listenPort = NETEM_PORT;
+	const char* serverName = "127.0.0.1";
+	int serverPort = 8123;
+	int seconds = 0;
+
+	//Overrides of the profile, negative for none
+	int delayMs = -1;
+	int jitterMs = -1;
+	double lossPercent = -1.0;
+	double duplicatePercent = -1.0;
+	double reorderPercent = -1.0;
+	int rateBytes = -1;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		bool value = i + 1 < argc;
+		if( strcmp( args[ i ], "-s" ) == 0 && value ) seed = strtoul( args[ ++i ], NULL, 10 );
+		else if( strcmp( args[ i ], "-l" ) == 0 && value ) listenPort = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-t" ) == 0 && value ) serverName = args[ ++i ];
+		else if( strcmp( args[ i ], "-p" ) == 0 && value ) serverPort = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-d" ) == 0 && value ) seconds = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-delay" ) == 0 && value ) delayMs = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-jitter" ) == 0 && value ) jitterMs = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-loss" ) == 0 && value ) lossPercent = atof( args[ ++i ] );
+		else if( strcmp( args[ i ], "-dup" ) == 0 && value ) duplicatePercent = atof( args[ ++i ] );
+		else if( strcmp( args[ i ], "-reorder" ) == 0 && value ) reorderPercent = atof( args[ ++i ] );
+		else if( strcmp( args[ i ], "-rate" ) == 0 && value ) rateBytes = atoi( args[ ++i ] );
+		else if( args[ i ][ 0 ] != '-' && findProfile( args[ i ] ) != NULL ) named = findProfile( args[ i ] );
+		else
+		{
+			fprintf( stderr, "Usage: %s [profile] [-s seed] [-l port] [-t server] [-p port] [-d seconds]\n", args[ 0 ] );
+			fprintf( stderr, "         [-delay ms] [-jitter ms] [-loss %%] [-dup %%] [-reorder %%] [-rate bytes/s]\n\nProfiles:\n" );
+			printProfiles();
+			return 1;
+		}
+	}
+
+	ImpairmentProfile profile = *named;
+	if( delayMs >= 0 ) profile.delayMs = delayMs;
+	if( jitterMs >= 0 ) profile.jitterMs = jitterMs;
+	if( lossPercent >= 0.0 ) profile.lossPercent = lossPercent;
+	if( duplicatePercent >= 0.0 ) profile.duplicatePercent = duplicatePercent;
+	if( reorderPercent >= 0.0 ) profile.reorderPercent = reorderPercent;
+	if( rateBytes >= 0 ) profile.rateBytes = rateBytes;
+	if( profile.rateBytes > 0 && profile.queueMs == 0 ) profile.queueMs = 200;
+
+	//Where the server is
+	struct sockaddr_in server;
+	memset( &server, 0, sizeof( server ) );
+	server.sin_family = AF_INET;
+	server.sin_port = htons( serverPort );
+	struct hostent* host = gethostbyname( serverName );
+	if( host == NULL || host->h_addrtype != AF_INET )
+	{
+		fprintf( stderr, "Unable to resolve %s!\n", serverName );
+		return 1;
+	}
+	memcpy( &server.sin_addr, host->h_addr_list[ 0 ], sizeof( server.sin_addr ) );
+
+	//Where clients reach us
+	int listener = socket( AF_INET, SOCK_DGRAM, 0 );
+	struct sockaddr_in address;
+	memset( &address, 0, sizeof( address ) );
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl( INADDR_ANY );
+	address.sin_port = htons( listenPort );
+	if( listener < 0 || bind( listener, (struct sockaddr*)&address, sizeof( address ) ) < 0 )
+	{
+		fprintf( stderr, "Unable to listen on port %d!\n", listenPort );
+		return 1;
+	}
+
+	signal( SIGINT, stop );
+	signal( SIGTERM, stop );
+	printf( "Passing port %d to %s:%d as %s, seed %u\n", listenPort, serverName, serverPort, profile.name, seed );
+	printf( "  %d+-%d ms, %.1f%% loss, %.1f%% duplicated, %.1f%% reordered", profile.delayMs, profile.jitterMs, profile.lossPercent, profile.duplicatePercent, profile.reorderPercent );
+	if( profile.rateBytes > 0 )
+	{
+		printf( ", %d B/s with %d ms of queue", profile.rateBytes, profile.queueMs );
+	}
+	printf( "\n" );
+
+	static Flow flows[ NETEM_FLOWS ];
+	for( int i = 0; i < NETEM_FLOWS; ++i )
+	{
+		flows[ i ].used = false;
+		flows[ i ].upstream = -1;
+	}
+	int flowsOpened = 0;
+
+	std::priority_queue<Pending, std::vector<Pending>, PendingLater> pending;
+	uint64_t order = 0;
+
+	uint64_t start = nowMicros();
+	uint64_t lastReport = start;
+	LinkStats lastUp;
+	LinkStats lastDown;
+	LinkStats freedUp;
+	LinkStats freedDown;
+	memset( &lastUp, 0, sizeof( lastUp ) );
+	memset( &lastDown, 0, sizeof( lastDown ) );
+	memset( &freedUp, 0, sizeof( freedUp ) );
+	memset( &freedDown, 0, sizeof( freedDown ) );
+
+	unsigned char buffer[ NETEM_DATAGRAM ];
+	while( gRunning && ( seconds == 0 || nowMicros() - start < (uint64_t)seconds * 1000000 ) )
+	{
+		//Sleep until the next packet is due or anything arrives
+		struct pollfd fds[ NETEM_FLOWS + 1 ];
+		int flowOf[ NETEM_FLOWS + 1 ];
+		int count = 0;
+		fds[ count ].fd = listener;
+		fds[ count ].events = POLLIN;
+		flowOf[ count++ ] = -1;
+		for( int i = 0; i < NETEM_FLOWS; ++i )
+		{
+			if( flows[ i ].used )
+			{
+				fds[ count ].fd = flows[ i ].upstream;
+				fds[ count ].events = POLLIN;
+				flowOf[ count++ ] = i;
+			}
+		}
+		int timeout = NETEM_REPORT_INTERVAL;
+		uint64_t now = nowMicros();
+		if( !pending.empty() )
+		{
+			timeout = pending.top().due > now ? (int)( ( pending.top().due - now ) / 1000 ) : 0;
+		}
+		if( poll( fds, count, timeout ) < 0 )
+		{
+			continue;
+		}
+		now = nowMicros();
+
+		for( int i = 0; i < count; ++i )
+		{
+			if( !( fds[ i ].revents & POLLIN ) )
+			{
+				continue;
+			}
+
+			struct sockaddr_in from;
+			socklen_t fromLength = sizeof( from );
+			ssize_t length = recvfrom( fds[ i ].fd, buffer, sizeof( buffer ), 0, (struct sockaddr*)&from, &fromLength );
+			if( length <= 0 )
+			{
+				continue;
+			}
+
+			//Find or open the client's flow
+			int flow = flowOf[ i ];
+			bool toServer = flow < 0;
+			if( toServer )
+			{
+				int free = -1;
+				for( int f = 0; f < NETEM_FLOWS && flow < 0; ++f )
+				{
+					if( flows[ f ].used && flows[ f ].client.sin_addr.s_addr == from.sin_addr.s_addr && flows[ f ].client.sin_port == from.sin_port )
+					{
+						flow = f;
+					}
+					else if( !flows[ f ].used && free < 0 )
+					{
+						free = f;
+					}
+				}
+				if( flow < 0 && free >= 0 )
+				{
+					int upstream = socket( AF_INET, SOCK_DGRAM, 0 );
+					if( upstream < 0 )
+					{
+						continue;
+					}
+
+					//Each flow's links get their own seeds in the order clients turn up, so a run is repeatable
+					flow = free;
+					flows[ flow ].used = true;
+					flows[ flow ].client = from;
+					flows[ flow ].upstream = upstream;
+					flows[ flow ].up.init( profile, seed + flowsOpened * 2 );
+					flows[ flow ].down.init( profile, seed + flowsOpened * 2 + 1 );
+					++flowsOpened;
+					printf( "Client %s:%d joined\n", inet_ntoa( from.sin_addr ), ntohs( from.sin_port ) );
+				}
+				if( flow < 0 )
+				{
+					continue;
+				}
+				flows[ flow ].lastHeard = now;
+			}
+
+			//Hold every copy the link lets through until it is due
+			uint64_t due[ IMPAIRMENT_COPIES ];
+			ImpairedLink& link = toServer ? flows[ flow ].up : flows[ flow ].down;
+			int copies = link.send( now, (int)length, due );
+			for( int c = 0; c < copies; ++c )
+			{
+				Pending packet;
+				packet.due = due[ c ];
+				packet.order = order++;
+				packet.flow = flow;
+				packet.toServer = toServer;
+				packet.data.assign( buffer, buffer + length );
+				pending.push( packet );
+			}
+		}
+
+		//Send on whatever is due
+		while( !pending.empty() && pending.top().due <= now )
+		{
+			const Pending& packet = pending.top();
+			Flow& flow = flows[ packet.flow ];
+			if( flow.used )
+			{
+				if( packet.toServer )
+				{
+					sendto( flow.upstream, packet.data.data(), packet.data.size(), 0, (struct sockaddr*)&server, sizeof( server ) );
+				}
+				else
+				{
+					sendto( listener, packet.data.data(), packet.data.size(), 0, (struct sockaddr*)&flow.client, sizeof( flow.client ) );
+				}
+			}
+			pending.pop();
+		}
+
+		//Free the flows of clients that went away, keeping their stats in the totals
+		for( int i = 0; i < NETEM_FLOWS; ++i )
+		{
+			if( flows[ i ].used && now - flows[ i ].lastHeard > (uint64_t)NETEM_FLOW_TIMEOUT * 1000 )
+			{
+				addStats( freedUp, flows[ i ].up.getStats() );
+				addStats( freedDown, flows[ i ].down.getStats() );
+				flows[ i ].up.init( profile, 0 );
+				flows[ i ].down.init( profile, 0 );
+				printf( "Client %s:%d went quiet\n", inet_ntoa( flows[ i ].client.sin_addr ), ntohs( flows[ i ].client.sin_port ) );
+				close( flows[ i ].upstream );
+				flows[ i ].upstream = -1;
+				flows[ i ].used = false;
+			}
+		}
+
+		if( now - lastReport >= (uint64_t)NETEM_REPORT_INTERVAL * 1000 )
+		{
+			report( flows, freedUp, freedDown, lastUp, lastDown, ( now - lastReport ) / 1000000.0, "Last second" );
+			lastReport = now;
+		}
+	}
+
+	//Totals for the whole run
+	memset( &lastUp, 0, sizeof( lastUp ) );
+	memset( &lastDown, 0, sizeof( lastDown ) );
+	report( flows, freedUp, freedDown, lastUp, lastDown, ( nowMicros() - start ) / 1000000.0, "Whole run" );
+
+	for( int i = 0; i < NETEM_FLOWS; ++i )
+	{
+		if( flows[ i ].upstream >= 0 )
+		{
+			close( flows[ i ].upstream );
+		}
+	}
+	close( listener );
+	return 0;
+}
@@ -0,0 +1,281 @@
+//Watches one room of the server and passes its snapshots on to any number of spectators, optionally held back by a delay
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <enet/enet.h>
+#include "match.hpp"
+#include "protocol.hpp"
+
+//Most spectators served at once
+const int RELAY_VIEWERS = 256;
+
+//Longest delay in seconds, the snapshots it holds back are kept in a ring
+const int RELAY_MAX_DELAY = 60;
+
+//Snapshots held for the longest delay, with room for the ones arriving while the oldest is due
+const int RELAY_FRAMES = ( RELAY_MAX_DELAY + 1 ) * TICKS_PER_SECOND / SPECTATE_INTERVAL;
+
+//Milliseconds between reports
+const int RELAY_REPORT_INTERVAL = 1000;
+
+//Milliseconds to wait before trying the server again
+const int RELAY_RETRY_DELAY = 2000;
+
+//One snapshot as it came from the server
+struct Frame
+{
+	//When it arrived
+	enet_uint32 received;
+
+	int length;
+	unsigned char data[ MAX_MESSAGE_SIZE ];
+};
+
+//Traffic since the last report
+struct RelayStats
+{
+	int snapshotsIn;
+	int bytesIn;
+	int snapshotsOut;
+	int bytesOut;
+	int stale;
+	int overflowed;
+};
+
+//Cleared by Ctrl+C to stop
+volatile sig_atomic_t gRunning = 1;
+
+void stop( int )
+{
+	gRunning = 0;
+}
+
+//Starts connecting to the server, asking to watch a room
+ENetPeer* connectUpstream( ENetHost* host, const ENetAddress& address, int room )
+{
+	ENetPeer* peer = enet_host_connect( host, &address, CHANNEL_COUNT, SPECTATE_DATA | room );
+	if( peer == NULL )
+	{
+		printf( "No available peers for watching the server!\n" );
+	}
+	return peer;
+}
+
+int main( int argc, char* args[] )
+{
+	const char* serverName = "127.0.0.1";
+	int serverPort = SERVER_PORT;
+	int listenPort = RELAY_PORT;
+	int room = 0;
+	int delaySeconds = 0;
+	for( int i = 1; i < argc; ++i )
+	{
+		bool value = i + 1 < argc;
+		if( strcmp( args[ i ], "-p" ) == 0 && value ) serverPort = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-l" ) == 0 && value ) listenPort = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-r" ) == 0 && value ) room = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-d" ) == 0 && value ) delaySeconds = atoi( args[ ++i ] );
+		else if( args[ i ][ 0 ] != '-' ) serverName = args[ i ];
+		else
+		{
+			fprintf( stderr, "Usage: %s [server] [-p port] [-r room] [-l port] [-d delay seconds]\n", args[ 0 ] );
+			return 1;
+		}
+	}
+	if( delaySeconds < 0 || delaySeconds > RELAY_MAX_DELAY || room < 0 )
+	{
+		fprintf( stderr, "The delay has to be 0 to %d seconds and the room not negative.\n", RELAY_MAX_DELAY );
+		return 1;
+	}
+
+	if( enet_initialize() != 0 )
+	{
+		printf( "An error occurred while initializing ENet!\n" );
+		return 1;
+	}
+
+	//One peer to the server, or to another relay, and many to the spectators
+	ENetAddress upstreamAddress;
+	enet_address_set_host( &upstreamAddress, serverName );
+	upstreamAddress.port = serverPort;
+	ENetHost* upstream = enet_host_create( NULL, 1, CHANNEL_COUNT, 0, 0 );
+
+	ENetAddress listenAddress;
+	listenAddress.host = ENET_HOST_ANY;
+	listenAddress.port = listenPort;
+	ENetHost* downstream = enet_host_create( &listenAddress, RELAY_VIEWERS, CHANNEL_COUNT, 0, 0 );
+	if( upstream == NULL || downstream == NULL )
+	{
+		printf( "An error occurred while trying to create the relay's ENet hosts!\n" );
+		return 1;
+	}
+
+	Frame* frames = new Frame[ RELAY_FRAMES ];
+	int oldest = 0;
+	int held = 0;
+
+	//Newest snapshot let out, sent reliably to each spectator as it joins, every snapshot being the whole room
+	Frame keyframe;
+	keyframe.length = 0;
+	int newestTick = 0;
+
+	ENetPeer* server = connectUpstream( upstream, upstreamAddress, room );
+	bool connected = false;
+	enet_uint32 retryTime = 0;
+	int viewers = 0;
+
+	RelayStats stats = {};
+	enet_uint32 reportTime = enet_time_get();
+
+	printf( "Relaying room %d of %s:%d on port %d with a delay of %d seconds.\n", room, serverName, serverPort, listenPort, delaySeconds );
+	signal( SIGINT, stop );
+	while( gRunning )
+	{
+		enet_uint32 now = enet_time_get();
+		if( server == NULL && now - retryTime >= (enet_uint32)RELAY_RETRY_DELAY )
+		{
+			server = connectUpstream( upstream, upstreamAddress, room );
+			retryTime = now;
+		}
+
+		//Hold every snapshot newer than the last one, late ones are already out of date
+		ENetEvent event;
+		while( enet_host_service( upstream, &event, 0 ) > 0 )
+		{
+			switch( event.type )
+			{
+				case ENET_EVENT_TYPE_CONNECT:
+					printf( "Watching room %d.\n", room );
+					connected = true;
+
+					//A restarted server counts its ticks from zero again
+					newestTick = 0;
+					break;
+
+				case ENET_EVENT_TYPE_RECEIVE:
+				{
+					Snapshot snapshot;
+					if( !decodeSnapshot( event.packet->data, event.packet->dataLength, snapshot ) || event.packet->dataLength > (size_t)MAX_MESSAGE_SIZE )
+					{
+						enet_packet_destroy( event.packet );
+						break;
+					}
+					++stats.snapshotsIn;
+					stats.bytesIn += event.packet->dataLength;
+					if( snapshot.tick <= newestTick )
+					{
+						++stats.stale;
+						enet_packet_destroy( event.packet );
+						break;
+					}
+					newestTick = snapshot.tick;
+
+					//Should the ring ever fill, the oldest snapshot is dropped
+					if( held == RELAY_FRAMES )
+					{
+						oldest = ( oldest + 1 ) % RELAY_FRAMES;
+						--held;
+						++stats.overflowed;
+					}
+					Frame& frame = frames[ ( oldest + held ) % RELAY_FRAMES ];
+					frame.received = now;
+					frame.length = event.packet->dataLength;
+					memcpy( frame.data, event.packet->data, frame.length );
+					++held;
+					enet_packet_destroy( event.packet );
+					break;
+				}
+
+				case ENET_EVENT_TYPE_DISCONNECT:
+					printf( connected ? "Lost the server, trying again.\n" : "Could not reach the server, trying again.\n" );
+					connected = false;
+					server = NULL;
+					retryTime = now;
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		//Let out every snapshot that has been held long enough, one packet shared by every spectator
+		while( held > 0 && now - frames[ oldest ].received >= (enet_uint32)delaySeconds * 1000 )
+		{
+			Frame& frame = frames[ oldest ];
+			if( viewers > 0 )
+			{
+				ENetPacket* packet = enet_packet_create( frame.data, frame.length, 0 );
+				if( packet != NULL )
+				{
+					enet_host_broadcast( downstream, CHANNEL_UNRELIABLE, packet );
+					stats.snapshotsOut += viewers;
+					stats.bytesOut += frame.length * viewers;
+				}
+			}
+			keyframe.length = frame.length;
+			memcpy( keyframe.data, frame.data, frame.length );
+			oldest = ( oldest + 1 ) % RELAY_FRAMES;
+			--held;
+		}
+
+		//Spectators only ever listen, so all there is to do is count them and start each one off
+		while( enet_host_service( downstream, &event, 1 ) > 0 )
+		{
+			switch( event.type )
+			{
+				case ENET_EVENT_TYPE_CONNECT:
+					++viewers;
+					enet_peer_timeout( event.peer, 0, 2000, 5000 );
+					if( keyframe.length > 0 )
+					{
+						ENetPacket* packet = enet_packet_create( keyframe.data, keyframe.length, ENET_PACKET_FLAG_RELIABLE );
+						if( packet != NULL && enet_peer_send( event.peer, CHANNEL_RELIABLE, packet ) < 0 )
+						{
+							enet_packet_destroy( packet );
+						}
+					}
+					break;
+
+				case ENET_EVENT_TYPE_RECEIVE:
+					enet_packet_destroy( event.packet );
+					break;
+
+				case ENET_EVENT_TYPE_DISCONNECT:
+					--viewers;
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		if( now - reportTime >= (enet_uint32)RELAY_REPORT_INTERVAL )
+		{
+			float seconds = ( now - reportTime ) / 1000.f;
+			printf( "%s viewers %d held %d in %.0f/s %.0f B/s out %.0f/s %.0f B/s stale %d overflowed %d\n",
+				connected ? "watching" : "waiting", viewers, held, stats.snapshotsIn / seconds, stats.bytesIn / seconds,
+				stats.snapshotsOut / seconds, stats.bytesOut / seconds, stats.stale, stats.overflowed );
+			stats = RelayStats();
+			reportTime = now;
+		}
+	}
+
+	//Say goodbye to everybody before going
+	if( server != NULL )
+	{
+		enet_peer_disconnect_now( server, 0 );
+	}
+	for( size_t i = 0; i < downstream->peerCount; ++i )
+	{
+		if( downstream->peers[ i ].state == ENET_PEER_STATE_CONNECTED )
+		{
+			enet_peer_disconnect_now( &downstream->peers[ i ], 0 );
+		}
+	}
+	enet_host_destroy( downstream );
+	enet_host_destroy( upstream );
+	enet_deinitialize();
+	delete[] frames;
+	return 0;
+}
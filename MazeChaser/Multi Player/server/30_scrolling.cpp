@@ -8,8 +8,21 @@ and may not be redistributed without written permission.*/
 #include<SDL2/SDL_mixer.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string>
 #include <sstream>
+#include <vector>
+#include "clock.hpp"
+#include "collision_grid.hpp"
+#include "interest.hpp"
+#include "level.hpp"
+#include "match.hpp"
+#include "metrics.hpp"
+#include "netthread.hpp"
+#include "performance_clock.hpp"
+#include "rules.hpp"
+#include "snapshot_priority.hpp"
+#include "state_hash.hpp"
 
 //The dimensions of the level
 const int LEVEL_WIDTH = 12800;
@@ -82,8 +95,14 @@ class Dot
 		//Takes key presses and adjusts the dot's velocity
 		void handleEvent( SDL_Event& e );
 
+		//Puts the dot back at the start, keeping the keys held
+		void respawn();
+
+		//Sets the velocity from a remote player's held keys
+		void setButtons( Uint8 buttons );
+
 		//Moves the dot
-		void move( SDL_Rect wall[] );
+		void move( CollisionGrid& walls );
 
 		//Shows the dot on the screen relative to the camera
 		void render( int camX, int camY );
@@ -126,10 +145,95 @@ SDL_Renderer* gRenderer = NULL;
 //Globally used font
 TTF_Font *gFont = NULL;
 
-ENetAddress address;
-ENetHost* server;
-ENetEvent event;
-ENetPeer* peer1;
+//Ticks of input a seat can send ahead of the round
+const int INPUT_BUFFER = 64;
+
+//A match of up to ROOM_PLAYERS dots fed by one pair of network queues
+struct Room
+{
+	//The dots, seat 0 of room 0 is the player at this window
+	Dot players[ ROOM_PLAYERS ];
+
+	//Whether each seat is taken
+	bool joined[ ROOM_PLAYERS ] = {};
+
+	//Last input tick applied to each seat
+	int lastInputTick[ ROOM_PLAYERS ] = {};
+
+	//Inputs that came before the tick that plays them, a seat's input for tick t in slot t % INPUT_BUFFER
+	InputCmd pending[ ROOM_PLAYERS ][ INPUT_BUFFER ] = {};
+
+	//Ticks the newest input of each seat arrived before it was played, negative if it came late
+	int inputLead[ ROOM_PLAYERS ] = {};
+
+	//Score and energy of each seat in the current round
+	PlayerStats stats[ ROOM_PLAYERS ] = {};
+
+	//Steps each seat took this round, to check against its client's reports
+	StateHistory history[ ROOM_PLAYERS ];
+
+	//Whether each seat has already been reported as desynced this round
+	bool desynced[ ROOM_PLAYERS ] = {};
+
+	//Hash report of each seat for a tick not played yet, tick 0 when there is none
+	HashReport pendingHash[ ROOM_PLAYERS ] = {};
+
+	//How often each seat is sent a snapshot and how many dots it carries, and ticks since its last one,
+	//a seat played at this window has no link and an interval of 0
+	LinkBudget link[ ROOM_PLAYERS ] = {};
+	int sinceSnapshot[ ROOM_PLAYERS ] = {};
+
+	//Which other dots each seat is owed news of
+	PriorityAccumulator priority;
+
+	//Seated dots by where they are, and which dots each seat's client has been told are in view
+	InterestGrid grid;
+	bool interested[ ROOM_PLAYERS ][ ROOM_PLAYERS ] = {};
+
+	//The round every seat plays together
+	Match match = { PHASE_MENU, 0, 0 };
+
+	//Ticks simulated so far
+	int tick = 0;
+};
+
+//The network thread and the rooms it feeds
+NetThread gNet;
+Room gRooms[ MAX_ROOMS ];
+
+//Tick timings and network figures served to mcstat
+ServerMetrics gMetrics;
+
+//Microseconds since a performance counter reading
+Uint64 microsSince( Uint64 start );
+
+//Puts every seat of a room back at the start of a new round
+void startRound( Room& room );
+
+//Forgets the inputs and hash a seat sent ahead
+void clearPending( Room& room, int slot );
+
+//Steps a seat's dot with one of its inputs and records the step
+void playInput( Room& room, int slot, const InputCmd& input, CollisionGrid& walls );
+
+//Plays a seat's held inputs in order up to a tick, as far as they have arrived
+void playInputs( Room& room, int slot, int upToTick, CollisionGrid& walls );
+
+//Compares a seat's reported hash with the server's own for that tick and reports a desync once a round
+void checkHash( Room& room, int id, int slot, const HashReport& report );
+
+//Copies a seat's dot and round figures into a snapshot entry
+void fillPlayer( Room& room, int slot, PlayerState& player );
+
+//Works out which dots each client is near, tells it of those coming into or going out of view and adds to what it is owed of them
+void updateInterest( Room& room, int id );
+
+//Applies a room's queued network commands, advances its round and queues each seat's snapshot stamped with the server clock
+void updateRoom( int id, CollisionGrid& walls, uint32_t serverTime );
+
+//The walls of the level and the grid the dots collide against
+Level gLevel;
+CollisionGrid gWalls;
 
 //Scene textures
 LTexture gDotTexture;
@@ -138,6 +242,7 @@ LTexture gCTexture;
 LTexture gGMTexture;
 LTexture gTimeTextTexture;
 LTexture gPromptTextTexture;
+LTexture gPhaseTextTexture;
 
 //The music that will be played
 Mix_Music *gMusic = NULL;
@@ -310,6 +415,12 @@ Dot::Dot()
     mVelY = 0;
 }
 
+void Dot::respawn()
+{
+    mPosX = 10496;
+    mPosY = 32;
+}
+
 void Dot::handleEvent( SDL_Event& e )
 {
     //If a key was pressed
@@ -338,7 +449,18 @@ void Dot::handleEvent( SDL_Event& e )
     }
 }
 
-void Dot::move( SDL_Rect wall[] )
+void Dot::setButtons( Uint8 buttons )
+{
+    //Hold each direction at full speed
+    mVelX = 0;
+    mVelY = 0;
+    if( buttons & INPUT_UP ) mVelY -= DOT_VEL;
+    if( buttons & INPUT_DOWN ) mVelY += DOT_VEL;
+    if( buttons & INPUT_LEFT ) mVelX -= DOT_VEL;
+    if( buttons & INPUT_RIGHT ) mVelX += DOT_VEL;
+}
+
+void Dot::move( CollisionGrid& walls )
 {
     //Move the dot left or right
     mPosX += mVelX;
@@ -346,16 +468,7 @@ void Dot::move( SDL_Rect wall[] )
 	//Move the dot up or down
     mPosY += mVelY;
     mCollider.y = mPosY;
-	bool c = false;
-	// int i=0;
-	// while(i<18){
-	// 	c = c || checkCollision( mCollider, wall[i] );
-	// 	i++;
-	// }
-	for (int i = 0; i < 99; i++)
-	{
-		c = c || checkCollision( mCollider, wall[i] );
-	}
+	bool c = walls.hits( mCollider.x, mCollider.y, mCollider.w, mCollider.h );
 	
     //If the dot collided or went too far to the left or right
     if( ( mPosX < 0 ) || ( mPosX + DOT_WIDTH > LEVEL_WIDTH ) || c )
@@ -400,26 +513,6 @@ int Dot::getVelY()
 	return mVelY;
 }
 
-int byteToInt(unsigned char* byte) {
-
-        int n = 0;
-
-        n = n + (byte[0] & 0x000000ff);
-        n = n + ((byte[1] & 0x000000ff) << 8);
-        n = n + ((byte[2] & 0x000000ff) << 16);
-        n = n + ((byte[3] & 0x000000ff) << 24);
-
-
-        return n;
-    }
-void intToByte(int n, unsigned char* result) {
-
-        result[0] = n & 0x000000ff;
-        result[1] = (n & 0x0000ff00) >> 8;
-        result[2] = (n & 0x00ff0000) >> 16;
-        result[3] = (n & 0xff000000) >> 24; 
-    }
-
 bool init()
 {
 	//Initialization flag
@@ -487,6 +580,23 @@ bool loadMedia()
 	//Loading success flag
 	bool success = true;
 
+	//Load the walls and lay them on the collision grid
+	if( !loadLevel( "campus.lvl", gLevel ) )
+	{
+		printf( "Failed to load level!\n" );
+		success = false;
+	}
+	else
+	{
+		gWalls.build( gLevel, COLLISION_CELL );
+	}
+
+	//Cover the level with each room's interest grid
+	for( int i = 0; i < MAX_ROOMS; ++i )
+	{
+		gRooms[ i ].grid.create( LEVEL_WIDTH, LEVEL_HEIGHT, INTEREST_CELL_SIZE, ROOM_PLAYERS );
+	}
+
 	//Load music
 	gMusic = Mix_LoadMUS( "beat.wav" );
 	if( gMusic == NULL )
@@ -577,6 +687,7 @@ void close()
 	gGMTexture.free();
 	gTimeTextTexture.free();
 	gPromptTextTexture.free();
+	gPhaseTextTexture.free();
 
 	//Free the sound effects
 	Mix_FreeChunk( gScratch );
@@ -650,6 +761,374 @@ bool checkCollision( SDL_Rect a, SDL_Rect& b )
     return true;
 }
 
+Uint64 microsSince( Uint64 start )
+{
+	return ( SDL_GetPerformanceCounter() - start ) * 1000000 / SDL_GetPerformanceFrequency();
+}
+
+void startRound( Room& room )
+{
+	for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+	{
+		room.players[ slot ].respawn();
+		room.lastInputTick[ slot ] = 0;
+		resetStats( room.stats[ slot ] );
+		room.history[ slot ].reset();
+		room.desynced[ slot ] = false;
+		clearPending( room, slot );
+	}
+}
+
+void clearPending( Room& room, int slot )
+{
+	for( int i = 0; i < INPUT_BUFFER; ++i )
+	{
+		room.pending[ slot ][ i ].tick = 0;
+	}
+	room.inputLead[ slot ] = 0;
+	room.pendingHash[ slot ].tick = 0;
+}
+
+void playInput( Room& room, int slot, const InputCmd& input, CollisionGrid& walls )
+{
+	//Remote dots take one step per input so they follow the client's own simulation
+	PlayerStats& stats = room.stats[ slot ];
+	Dot& player = room.players[ slot ];
+	player.setButtons( input.buttons );
+	player.move( walls );
+	room.lastInputTick[ slot ] = input.tick;
+
+	//Score it against the client's own clock, which is its input tick
+	int zones = applyZones( stats, player.getPosX(), player.getPosY(), player.getVelX(), player.getVelY(), input.tick * 1000 / TICKS_PER_SECOND );
+	checkOutcome( stats, player.getPosX(), player.getPosY() );
+
+	DotState state = { input.tick, player.getPosX(), player.getPosY(), player.getVelX(), player.getVelY(), stats.score, stats.energy, zones };
+	room.history[ slot ].record( state );
+}
+
+void playInputs( Room& room, int slot, int upToTick, CollisionGrid& walls )
+{
+	//Inputs come in order, so a missing one is only late
+	for( int tick = room.lastInputTick[ slot ] + 1; tick <= upToTick && room.stats[ slot ].outcome == OUTCOME_NONE; ++tick )
+	{
+		InputCmd& input = room.pending[ slot ][ tick % INPUT_BUFFER ];
+		if( input.tick != tick )
+		{
+			break;
+		}
+		playInput( room, slot, input, walls );
+	}
+}
+
+void checkHash( Room& room, int id, int slot, const HashReport& report )
+{
+	//Compare the client's running hash with ours at the same tick, once per round per seat
+	DotState state;
+	uint32_t hash;
+	if( room.desynced[ slot ] || !room.history[ slot ].find( report.tick, state, hash ) || hash == report.hash )
+	{
+		return;
+	}
+	room.desynced[ slot ] = true;
+	gMetrics.recordDesync( id );
+	printf( "Room %d seat %d desynced by tick %d! Client hash %08x, server hash %08x\n", id, slot, report.tick, report.hash, hash );
+	room.history[ slot ].print( "server", report.tick );
+
+	//Tell the client so it can dump its side of the same tick
+	PacketBuffer* buffer = gNet.packets().acquire();
+	if( buffer != NULL )
+	{
+		HashReport reply = { report.tick, hash };
+		buffer->length = encodeDesync( reply, buffer->data );
+		OutPacket packet = { slot, CHANNEL_RELIABLE, buffer };
+		if( !gNet.outbound( id ).push( packet ) )
+		{
+			gNet.packets().release( buffer );
+		}
+	}
+}
+
+void fillPlayer( Room& room, int slot, PlayerState& player )
+{
+	player.slot = slot;
+	player.x = room.players[ slot ].getPosX();
+	player.y = room.players[ slot ].getPosY();
+	player.velX = room.players[ slot ].getVelX();
+	player.velY = room.players[ slot ].getVelY();
+	player.lastInputTick = room.lastInputTick[ slot ];
+	player.inputLead = room.inputLead[ slot ];
+	player.score = room.stats[ slot ].score;
+	player.energy = room.stats[ slot ].energy;
+	player.outcome = room.stats[ slot ].outcome;
+}
+
+void updateInterest( Room& room, int id )
+{
+	//Bucket the seated dots, so each client only looks near its own camera
+	room.grid.clear();
+	for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+	{
+		if( room.joined[ slot ] )
+		{
+			room.grid.insert( slot, room.players[ slot ].getPosX(), room.players[ slot ].getPosY() );
+		}
+	}
+
+	for( int viewer = 0; viewer < ROOM_PLAYERS; ++viewer )
+	{
+		//A seat played at this window has no client to tell
+		if( !room.joined[ viewer ] || room.link[ viewer ].interval == 0 )
+		{
+			continue;
+		}
+
+		//A dot comes into view inside the near box and stays in view until it leaves the wider one
+		int x = room.players[ viewer ].getPosX();
+		int y = room.players[ viewer ].getPosY();
+		InterestBox enter = interestBox( x, y, LEVEL_WIDTH, LEVEL_HEIGHT, INTEREST_ENTER_MARGIN );
+		InterestBox exit = interestBox( x, y, LEVEL_WIDTH, LEVEL_HEIGHT, INTEREST_ENTER_MARGIN + INTEREST_EXIT_MARGIN );
+		int found[ ROOM_PLAYERS ];
+		int count = room.grid.query( exit, found, ROOM_PLAYERS );
+		bool near[ ROOM_PLAYERS ] = {};
+		for( int i = 0; i < count; ++i )
+		{
+			int other = found[ i ];
+			if( other != viewer && ( room.interested[ viewer ][ other ] || insideBox( enter, room.players[ other ].getPosX(), room.players[ other ].getPosY() ) ) )
+			{
+				near[ other ] = true;
+			}
+		}
+
+		for( int other = 0; other < ROOM_PLAYERS; ++other )
+		{
+			//Changes go reliably, a client that misses a dot leaving would draw it where it was for good
+			if( near[ other ] != room.interested[ viewer ][ other ] )
+			{
+				InterestChange change;
+				change.tick = room.tick;
+				change.entered = near[ other ];
+				fillPlayer( room, other, change.player );
+
+				PacketBuffer* buffer = gNet.packets().acquire();
+				if( buffer == NULL )
+				{
+					continue;
+				}
+				buffer->length = encodeInterest( change, buffer->data );
+				OutPacket packet = { viewer, CHANNEL_RELIABLE, buffer };
+				if( !gNet.outbound( id ).push( packet ) )
+				{
+					gNet.packets().release( buffer );
+					continue;
+				}
+				room.interested[ viewer ][ other ] = near[ other ];
+			}
+
+			//The nearer a dot in view, the faster it is owed another mention
+			if( near[ other ] )
+			{
+				int distance = abs( room.players[ other ].getPosX() - x ) + abs( room.players[ other ].getPosY() - y );
+				room.priority.accumulate( viewer, other, distance );
+			}
+		}
+	}
+}
+
+void updateRoom( int id, CollisionGrid& walls, uint32_t serverTime )
+{
+	Room& room = gRooms[ id ];
+	Uint64 tickStart = SDL_GetPerformanceCounter();
+
+	//Apply everything the network thread decoded since the last tick
+	NetCommand command;
+	while( gNet.inbound( id ).pop( command ) )
+	{
+		switch( command.type )
+		{
+			case NET_JOIN:
+				room.players[ command.slot ] = Dot();
+				room.joined[ command.slot ] = true;
+				room.lastInputTick[ command.slot ] = 0;
+				resetStats( room.stats[ command.slot ] );
+				room.history[ command.slot ].reset();
+				room.desynced[ command.slot ] = false;
+				clearPending( room, command.slot );
+
+				//A new client starts on a full budget until its link has been measured
+				room.link[ command.slot ] = planLink( 0, 0.0, 1.0, TICKS_PER_SECOND );
+				room.sinceSnapshot[ command.slot ] = 0;
+				room.priority.reset( command.slot );
+				for( int other = 0; other < ROOM_PLAYERS; ++other )
+				{
+					room.interested[ command.slot ][ other ] = false;
+				}
+				break;
+
+			case NET_LINK:
+				room.link[ command.slot ] = command.link;
+				break;
+
+			case NET_LEAVE:
+				room.joined[ command.slot ] = false;
+				break;
+
+			case NET_INPUT:
+			{
+				//Inputs resent after a reconnect may already have been applied, and dots stay put between rounds
+				int slot = command.slot;
+				if( command.input.tick <= room.lastInputTick[ slot ] || room.match.phase != PHASE_PLAYING || room.stats[ slot ].outcome != OUTCOME_NONE )
+				{
+					break;
+				}
+
+				//Note how early it came for the client to steer by, the tick due now is phaseTicks + 1
+				room.inputLead[ slot ] = command.input.tick - ( room.match.phaseTicks + 1 );
+				if( room.inputLead[ slot ] < 0 )
+				{
+					gMetrics.recordLateInput( id );
+				}
+
+				//Hold it for its tick, a client so far ahead the buffer is full has the oldest ones played now
+				if( command.input.tick >= room.lastInputTick[ slot ] + INPUT_BUFFER )
+				{
+					playInputs( room, slot, command.input.tick - 1, walls );
+				}
+				room.pending[ slot ][ command.input.tick % INPUT_BUFFER ] = command.input;
+				break;
+			}
+
+			case NET_HASH:
+				//A hash of a tick still held is checked once that tick is played
+				if( command.report.tick > room.lastInputTick[ command.slot ] )
+				{
+					room.pendingHash[ command.slot ] = command.report;
+				}
+				else
+				{
+					checkHash( room, id, command.slot, command.report );
+				}
+				break;
+		}
+	}
+	room.tick++;
+
+	//Play every seat's inputs that are due, a late one as soon as it comes
+	if( room.match.phase == PHASE_PLAYING )
+	{
+		for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			playInputs( room, slot, room.match.phaseTicks + 1, walls );
+			if( room.pendingHash[ slot ].tick > 0 && room.pendingHash[ slot ].tick <= room.lastInputTick[ slot ] )
+			{
+				checkHash( room, id, slot, room.pendingHash[ slot ] );
+				room.pendingHash[ slot ].tick = 0;
+			}
+		}
+	}
+
+	//Start rounds while anyone is seated and end them once every seat is done
+	int seated = 0;
+	int finished = 0;
+	bool won = false;
+	for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+	{
+		if( room.joined[ slot ] )
+		{
+			++seated;
+			if( room.stats[ slot ].outcome != OUTCOME_NONE )
+			{
+				++finished;
+			}
+			if( room.stats[ slot ].outcome == OUTCOME_WON )
+			{
+				won = true;
+			}
+		}
+	}
+
+	MatchEvent event = MATCH_NONE;
+	if( seated == 0 )
+	{
+		event = MATCH_RESET;
+	}
+	else if( room.match.phase == PHASE_MENU || ( room.match.phase == PHASE_RESULTS && room.match.phaseTicks >= RESULTS_TICKS ) )
+	{
+		event = MATCH_START;
+	}
+	else if( finished == seated )
+	{
+		event = won ? MATCH_WIN : MATCH_LOSE;
+	}
+	if( updateMatch( room.match, event ) && room.match.phase == PHASE_COUNTDOWN )
+	{
+		startRound( room );
+	}
+
+	updateInterest( room, id );
+
+	//Each seat gets its own snapshot as often as its link allows, its own dot first and the nearby dots it is owed most after
+	Snapshot snapshot;
+	snapshot.tick = room.tick;
+	snapshot.round = room.match.round;
+	snapshot.phase = room.match.phase;
+	snapshot.phaseTicks = room.match.phaseTicks;
+	snapshot.serverTime = serverTime;
+	for( int viewer = 0; viewer < ROOM_PLAYERS; ++viewer )
+	{
+		if( !room.joined[ viewer ] || room.link[ viewer ].interval == 0 || ++room.sinceSnapshot[ viewer ] < room.link[ viewer ].interval )
+		{
+			continue;
+		}
+		room.sinceSnapshot[ viewer ] = 0;
+
+		snapshot.playerCount = 0;
+		fillPlayer( room, viewer, snapshot.players[ snapshot.playerCount++ ] );
+		int picked[ ROOM_PLAYERS ];
+		int count = room.priority.pick( viewer, room.interested[ viewer ], room.link[ viewer ].players - 1, picked );
+		for( int i = 0; i < count; ++i )
+		{
+			fillPlayer( room, picked[ i ], snapshot.players[ snapshot.playerCount++ ] );
+		}
+
+		PacketBuffer* buffer = gNet.packets().acquire();
+		if( buffer != NULL )
+		{
+			buffer->length = encodeSnapshot( snapshot, buffer->data );
+			OutPacket packet = { viewer, CHANNEL_UNRELIABLE, buffer };
+			if( !gNet.outbound( id ).push( packet ) )
+			{
+				gNet.packets().release( buffer );
+			}
+		}
+	}
+
+	//Relays get the whole room in one snapshot, so a spectator can follow anyone and join at any time
+	if( gNet.relays( id ) > 0 && room.tick % SPECTATE_INTERVAL == 0 )
+	{
+		snapshot.playerCount = 0;
+		for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			if( room.joined[ slot ] )
+			{
+				fillPlayer( room, slot, snapshot.players[ snapshot.playerCount++ ] );
+			}
+		}
+
+		PacketBuffer* buffer = gNet.packets().acquire();
+		if( buffer != NULL )
+		{
+			buffer->length = encodeSnapshot( snapshot, buffer->data );
+			OutPacket packet = { OUT_RELAYS, CHANNEL_UNRELIABLE, buffer };
+			if( !gNet.outbound( id ).push( packet ) )
+			{
+				gNet.packets().release( buffer );
+			}
+		}
+	}
+
+	gMetrics.publishRoom( id, seated, room.tick, gNet.inbound( id ).size(), gNet.outbound( id ).size(), microsSince( tickStart ) );
+}
+
 int main( int argc, char* args[] )
 {
 	//Start up SDL and create window
@@ -658,15 +1137,16 @@ int main( int argc, char* args[] )
 		printf( "Failed to initialize!\n" );
 	}
 	else
-	{	address = {0};
-        address.host = ENET_HOST_ANY; /* Bind the server to the default localhost.     */
-        address.port = 8123; /* Bind the server to port 7777. */
-        server = enet_host_create(&address, 3, 2, 0, 0);
-        if (server == NULL) {
-            printf("An error occurred while trying to create an ENet server host.\n");
-            //return 1;
-        }
-        printf("Started a server...\n");
+	{
+		//Keep the first seat for the player at this window and start networking
+		gNet.reserve( 0, 0 );
+		gNet.setMetrics( &gMetrics );
+		if( gNet.start( SERVER_PORT ) )
+		{
+			printf( "Started a server...\n" );
+		}
+		gMetrics.serve( STATS_SOCKET_PATH );
+
 		//Set texture filtering to linear
 		if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
 		{
@@ -686,624 +1166,28 @@ int main( int argc, char* args[] )
 			//Event handler
 			SDL_Event e;
 
-			//The dot that will be moving around on the screen
-			Dot dot;
+			//The dot that will be moving around on the screen, and the room it plays in
+			Room& home = gRooms[ 0 ];
+			Dot& dot = home.players[ 0 ];
+			PlayerStats& stats = home.stats[ 0 ];
+			home.joined[ 0 ] = true;
 
 			//Set text color as black
 			SDL_Color textColor = { 255, 255, 255, 255 };
 
-			//Current time start time
-			Uint32 startTime = 0;
-
-			//In memory text stream
+			//In memory text streams
 			std::stringstream timeText;
+			std::stringstream phaseText;
+
+			//Live time cut into fixed ticks
+			PerformanceClock clock;
+			FixedStep step( clock, TICKS_PER_SECOND, MAX_CATCH_UP_TICKS );
+			step.reset();
 
-			//Set the wall
-			SDL_Rect wall2;
-			wall2.x = 992;
-			wall2.y = 64;
-			wall2.w = 608;
-			wall2.h = 3648;
-
-			SDL_Rect wall1;
-			wall1.x = 1248;
-			wall1.y = 3712;
-			wall1.w = 352;
-			wall1.h = 512;
-
-			SDL_Rect wall3;
-			wall3.x = 832;
-			wall3.y = 3712;
-			wall3.w = 288;
-			wall3.h = 512;
-
-			SDL_Rect wall4;
-			wall4.x = 416;
-			wall4.y = 3456;
-			wall4.w = 704;
-			wall4.h = 640;
-
-			SDL_Rect wall5;
-			wall5.x = 416;
-			wall5.y = 4096;
-			wall5.w = 288;
-			wall5.h = 256;
-
-			SDL_Rect wall6;
-			wall6.x = 64;
-			wall6.y = 4256;
-			wall6.w = 640;
-			wall6.h = 96;
-
-			SDL_Rect wall7;
-			wall7.x = 64;
-			wall7.y = 4352;
-			wall7.w = 768;
-			wall7.h = 672;
-
-			SDL_Rect wall8;
-			wall8.x = 960;
-			wall8.y = 4352;
-			wall8.w = 640;
-			wall8.h = 672;
-
-			SDL_Rect wall9;
-			wall9.x = 64;
-			wall9.y = 5152;
-			wall9.w = 576;
-			wall9.h = 1184;
-
-			SDL_Rect wall10;
-			wall10.x = 640;
-			wall10.y = 5408;
-			wall10.w = 128;
-			wall10.h = 928;
-
-			SDL_Rect wall11;
-			wall11.x = 768;
-			wall11.y = 5152;
-			wall11.w = 512;
-			wall11.h = 1184;
-
-			SDL_Rect wall12;
-			wall12.x = 1280;
-			wall12.y = 5152;
-			wall12.w = 320;
-			wall12.h = 224;
-
-			SDL_Rect wall13;
-			wall13.x = 1280;
-			wall13.y = 5504;
-			wall13.w = 320;
-			wall13.h = 832;
-
-			SDL_Rect wall14;
-			wall14.x = 1728;
-			wall14.y = 64;
-			wall14.w = 1600;
-			wall14.h = 448;
-
-			SDL_Rect wall15;
-			wall15.x = 2688;
-			wall15.y = 512;
-			wall15.w = 640;
-			wall15.h = 224;
-
-			SDL_Rect wall16;
-			wall16.x = 3328;
-			wall16.y = 64;
-			wall16.w = 2560;
-			wall16.h = 416;
-
-			SDL_Rect wall17;
-			wall17.x = 3456;
-			wall17.y = 608;
-			wall17.w = 128;
-			wall17.h = 1436;
-
-			SDL_Rect wall18;
-			wall18.x = 3584;
-			wall18.y = 736;
-			wall18.w = 128;
-			wall18.h = 1312;
-
-			SDL_Rect wall19;
-			wall19.x = 3712;
-			wall19.y = 480;
-			wall19.w = 2176;
-			wall19.h = 1568;
-
-			SDL_Rect wall20;
-			wall20.x = 5888;
-			wall20.y = 1664;
-			wall20.w = 512;
-			wall20.h = 384;
-
-			SDL_Rect wall21;
-			wall21.x = 1728;
-			wall21.y = 640;
-			wall21.w = 832;
-			wall21.h = 1408;
-
-			SDL_Rect wall22;
-			wall22.x = 2688;
-			wall22.y = 864;
-			wall22.w = 640;
-			wall22.h = 1184;
-
-			SDL_Rect wall23;
-			wall23.x = 1728;
-			wall23.y = 2176;
-			wall23.w = 832;
-			wall23.h = 640;
-
-			SDL_Rect wall24;
-			wall24.x = 2688;
-			wall24.y = 2176;
-			wall24.w = 640;
-			wall24.h = 640;
-
-			SDL_Rect wall25;
-			wall25.x = 1728;
-			wall25.y = 2944;
-			wall25.w = 320;
-			wall25.h = 1536;
-
-			SDL_Rect wall26;
-			wall26.x = 2048;
-			wall26.y = 3008;
-			wall26.w = 128;
-			wall26.h = 1472;
-
-			SDL_Rect wall27;
-			wall27.x = 2176;
-			wall27.y = 2944;
-			wall27.w = 512;
-			wall27.h = 1536;
-
-			SDL_Rect wall28;
-			wall28.x = 2688;
-			wall28.y = 3072;
-			wall28.w = 128;
-			wall28.h = 1408;
-
-			SDL_Rect wall29;
-			wall29.x = 2816;
-			wall29.y = 2816;
-			wall29.w = 512;
-			wall29.h = 1184;
-
-			SDL_Rect wall30;
-			wall30.x = 2816;
-			wall30.y = 4000;
-			wall30.w = 256;
-			wall30.h = 480;
-
-			SDL_Rect wall31;
-			wall31.x = 1728;
-			wall31.y = 4608;
-			wall31.w = 1088;
-			wall31.h = 416;
-
-			SDL_Rect wall32;
-			wall32.x = 1728;
-			wall32.y = 5152;
-			wall32.w = 768;
-			wall32.h = 1056;
-
-			SDL_Rect wall33;
-			wall33.x = 2496;
-			wall33.y = 5152;
-			wall33.w = 448;
-			wall33.h = 1184;
-
-			SDL_Rect wall34;
-			wall34.x = 2944;
-			wall34.y = 4608;
-			wall34.w = 256;
-			wall34.h = 1728;
-
-			SDL_Rect wall35;
-			wall35.x = 3200;
-			wall35.y = 4128;
-			wall35.w = 9536;
-			wall35.h = 2208;
-
-			SDL_Rect wall36;
-			wall36.x = 1600;
-			wall36.y = 6336;
-			wall36.w = 768;
-			wall36.h = 16;
-
-			SDL_Rect wall37;
-			wall37.x = 3456;
-			wall37.y = 2176;
-			wall37.w = 3328;
-			wall37.h = 1824;
-
-			SDL_Rect wall38;
-			wall38.x = 6784;
-			wall38.y = 2431;
-			wall38.w = 256;
-			wall38.h = 1568;
-
-			SDL_Rect wall39;
-			wall39.x = 7040;
-			wall39.y = 2944;
-			wall39.w = 128;
-			wall39.h = 1056;
-
-			SDL_Rect wall40;
-			wall40.x = 6784;
-			wall40.y = 1792;
-			wall40.w = 128;
-			wall40.h = 256;
-
-			SDL_Rect wall41;
-			wall41.x = 6912;
-			wall41.y = 1792;
-			wall41.w = 256;
-			wall41.h = 512;
-
-			SDL_Rect wall42;
-			wall42.x = 7168;
-			wall42.y = 1792;
-			wall42.w = 768;
-			wall42.h = 2208;
-
-			SDL_Rect wall43;
-			wall43.x = 7936;
-			wall43.y = 2304;
-			wall43.w = 128;
-			wall43.h = 1696;
-
-			SDL_Rect wall44;
-			wall44.x = 8064;
-			wall44.y = 2240;
-			wall44.w = 128;
-			wall44.h = 1760;
-
-			SDL_Rect wall45;
-			wall45.x = 8064;
-			wall45.y = 1792;
-			wall45.w = 128;
-			wall45.h = 320;
-
-			SDL_Rect wall46;
-			wall46.x = 8192;
-			wall46.y = 1792;
-			wall46.w = 480;
-			wall46.h = 2208;
-
-			SDL_Rect wall47;
-			wall47.x = 8672;
-			wall47.y = 1280;
-			wall47.w = 1760;
-			wall47.h = 2720;
-
-			SDL_Rect wall48;
-			wall48.x = 10432;
-			wall48.y = 1280;
-			wall48.w = 608;
-			wall48.h = 1792;
-
-			SDL_Rect wall49;
-			wall49.x = 6016;
-			wall49.y = 256;
-			wall49.w = 512;
-			wall49.h = 1280;
-
-			SDL_Rect wall50;
-			wall50.x = 6528;
-			wall50.y = 256;
-			wall50.w = 128;
-			wall50.h = 1792;
-
-			SDL_Rect wall51;
-			wall51.x = 6656;
-			wall51.y = 256;
-			wall51.w = 1888;
-			wall51.h = 896;
-
-			SDL_Rect wall52;
-			wall52.x = 8544;
-			wall52.y = 256;
-			wall52.w = 960;
-			wall52.h = 256;
-
-			SDL_Rect wall53;
-			wall53.x = 5888;
-			wall53.y = 64;
-			wall53.w = 3744;
-			wall53.h = 64;
-
-			SDL_Rect wall54;
-			wall54.x = 6784;
-			wall54.y = 1280;
-			wall54.w = 832;
-			wall54.h = 384;
-
-			SDL_Rect wall55;
-			wall55.x = 7744;
-			wall55.y = 1280;
-			wall55.w = 800;
-			wall55.h = 384;
-
-			SDL_Rect wall56;
-			wall56.x = 9632;
-			wall56.y = 64;
-			wall56.w = 320;
-			wall56.h = 448;
-
-			SDL_Rect wall57;
-			wall57.x = 8672;
-			wall57.y = 640;
-			wall57.w = 1408;
-			wall57.h = 512;
-
-			SDL_Rect wall58;
-			wall58.x = 10080;
-			wall58.y = 192;
-			wall58.w = 512;
-			wall58.h = 960;
-
-			SDL_Rect wall59;
-			wall59.x = 10592;
-			wall59.y = 64;
-			wall59.w = 448;
-			wall59.h = 1088;
-
-			SDL_Rect wall60;
-			wall60.x = 11040;
-			wall60.y = 64;
-			wall60.w = 128;
-			wall60.h = 320;
-
-			SDL_Rect wall61;
-			wall61.x = 9952;
-			wall61.y = 48;
-			wall61.w = 512;
-			wall61.h = 16;
-
-			SDL_Rect wall62;
-			wall62.x = 11168;
-			wall62.y = 64;
-			wall62.w = 352;
-			wall62.h = 1088;
-
-			SDL_Rect wall63;
-			wall63.x = 11520;
-			wall63.y = 64;
-			wall63.w = 640;
-			wall63.h = 320;
-
-			SDL_Rect wall64;
-			wall64.x = 11648;
-			wall64.y = 512;
-			wall64.w = 512;
-			wall64.h = 640;
-
-			SDL_Rect wall65;
-			wall65.x = 12288;
-			wall65.y = 64;
-			wall65.w = 448;
-			wall65.h = 1088;
-
-			SDL_Rect wall66;
-			wall66.x = 11168;
-			wall66.y = 1280;
-			wall66.w = 352;
-			wall66.h = 832;
-
-			SDL_Rect wall67;
-			wall67.x = 11648;
-			wall67.y = 1280;
-			wall67.w = 512;
-			wall67.h = 832;
-
-			SDL_Rect wall68;
-			wall68.x = 11168;
-			wall68.y = 2240;
-			wall68.w = 992;
-			wall68.h = 320;
-
-			SDL_Rect wall69;
-			wall69.x = 12288;
-			wall69.y = 1280;
-			wall69.w = 448;
-			wall69.h = 2720;
-
-			SDL_Rect wall70;
-			wall70.x = 10560;
-			wall70.y = 3200;
-			wall70.w = 608;
-			wall70.h = 800;
-
-			SDL_Rect wall71;
-			wall71.x = 11168;
-			wall71.y = 2688;
-			wall71.w = 992;
-			wall71.h = 1312;
-
-			SDL_Rect wall72;
-			wall72.x = 416;
-			wall72.y = 64;
-			wall72.w = 576;
-			wall72.h = 3424;
-
-			SDL_Rect wall73;
-			wall73.x = 64;
-			wall73.y = 64;
-			wall73.w = 352;
-			wall73.h = 4192;
-
-			SDL_Rect wall74;
-			wall74.x = 704;
-			wall74.y = 4320;
-			wall74.w = 32;
-			wall74.h = 32;
-
-			SDL_Rect wall75;
-			wall75.x = 1600;
-			wall75.y = 6272;
-			wall75.w = 32;
-			wall75.h = 32;
-
-			SDL_Rect wall76;
-			wall76.x = 2656;
-			wall76.y = 512;
-			wall76.w = 32;
-			wall76.h = 32;
-
-			SDL_Rect wall77;
-			wall77.x = 3328;
-			wall77.y = 480;
-			wall77.w = 32;
-			wall77.h = 32;
-
-			SDL_Rect wall78;
-			wall78.x = 3680;
-			wall78.y = 480;
-			wall78.w = 32;
-			wall78.h = 32;
-
-			SDL_Rect wall79;
-			wall79.x = 5888;
-			wall79.y = 1632;
-			wall79.w = 32;
-			wall79.h = 32;
-
-			SDL_Rect wall80;
-			wall80.x = 2784;
-			wall80.y = 2816;
-			wall80.w = 32;
-			wall80.h = 32;
-
-			SDL_Rect wall81;
-			wall81.x = 3072;
-			wall81.y = 4000;
-			wall81.w = 32;
-			wall81.h = 32;
-
-			SDL_Rect wall82;
-			wall82.x = 2464;
-			wall82.y = 6208;
-			wall82.w = 32;
-			wall82.h = 32;
-
-			SDL_Rect wall83;
-			wall83.x = 2912;
-			wall83.y = 5120;
-			wall83.w = 32;
-			wall83.h = 32;
-
-			SDL_Rect wall84;
-			wall84.x = 3168;
-			wall84.y = 4576;
-			wall84.w = 32;
-			wall84.h = 32;
-
-			SDL_Rect wall85;
-			wall85.x = 6784;
-			wall85.y = 2400;
-			wall85.w = 32;
-			wall85.h = 32;
-
-			SDL_Rect wall86;
-			wall86.x = 6880;
-			wall86.y = 2048;
-			wall86.w = 32;
-			wall86.h = 32;
-
-			SDL_Rect wall87;
-			wall87.x = 7136;
-			wall87.y = 2304;
-			wall87.w = 32;
-			wall87.h = 32;
-
-			SDL_Rect wall88;
-			wall88.x = 8640;
-			wall88.y = 1760;
-			wall88.w = 32;
-			wall88.h = 32;
-
-			SDL_Rect wall89;
-			wall89.x = 10432;
-			wall89.y = 3072;
-			wall89.w = 32;
-			wall89.h = 32;
-
-			SDL_Rect wall90;
-			wall90.x = 6496;
-			wall90.y = 1536;
-			wall90.w = 32;
-			wall90.h = 32;
-
-			SDL_Rect wall91;
-			wall91.x = 6656;
-			wall91.y = 1152;
-			wall91.w = 32;
-			wall91.h = 32;
-
-			SDL_Rect wall92;
-			wall92.x = 8544;
-			wall92.y = 512;
-			wall92.w = 32;
-			wall92.h = 32;
-
-			SDL_Rect wall93;
-			wall93.x = 9600;
-			wall93.y = 128;
-			wall93.w = 32;
-			wall93.h = 32;
-
-			SDL_Rect wall94;
-			wall94.x = 5888;
-			wall94.y = 128;
-			wall94.w = 32;
-			wall94.h = 32;
-
-			SDL_Rect wall95;
-			wall95.x = 9952;
-			wall95.y = 64;
-			wall95.w = 32;
-			wall95.h = 32;
-
-			SDL_Rect wall96;
-			wall96.x = 10048;
-			wall96.y = 608;
-			wall96.w = 32;
-			wall96.h = 32;
-
-			SDL_Rect wall97;
-			wall97.x = 10560;
-			wall97.y = 160;
-			wall97.w = 32;
-			wall97.h = 32;
-
-			SDL_Rect wall98;
-			wall98.x = 11520;
-			wall98.y = 384;
-			wall98.w = 32;
-			wall98.h = 32;
-
-			SDL_Rect wall99;
-			wall99.x = 11136;
-			wall99.y = 3168;
-			wall99.w = 32;
-			wall99.h = 32;
-
-
-			SDL_Rect wall[] = {wall1, wall2, wall3, wall4, wall5, wall6, wall7, wall8, wall9, wall10, wall11, wall12, wall13, wall14, wall15, wall16, wall17, wall18, wall19, wall20, wall21, wall22, wall23, wall24, wall25, wall26, wall27, wall28, wall29, wall30, wall31, wall32, wall33, wall34, wall35, wall36, wall37, wall38, wall39, wall40, wall41, wall42, wall43, wall44, wall45, wall46, wall47, wall48, wall49, wall50, 
-				wall51, wall52, wall53, wall54, wall55, wall56, wall57, wall58, wall59, wall60, wall61, wall62, wall63, wall64, wall65, wall66, wall67, wall68, wall69, wall70, wall71, wall72, wall73, wall74, wall75, wall76, wall77, wall78, wall79, wall80, wall81, wall82, wall83, wall84, wall85, wall86, wall87, wall88, wall89, wall90, wall91, wall92, wall93, wall94, wall95, wall96, wall97, wall98, wall99};
 
 			//The camera area
 			SDL_Rect camera = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
 
-			int e1 = 0;
-			int score = 300;
-			int energy = 0;
-
 			//While application is running
 			while( !quit )
 			{
@@ -1315,11 +1199,6 @@ int main( int argc, char* args[] )
 					{
 						quit = true;
 					}
-					// //Reset start time on return keypress
-					// else if( e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_RETURN )
-					// {
-					// 	startTime = SDL_GetTicks();
-					// }
 					else{
 						Mix_PlayMusic( gMusic, -1 );
 					}
@@ -1328,8 +1207,38 @@ int main( int argc, char* args[] )
 					dot.handleEvent( e );
 				}
 
-				//Move the dot
-				dot.move( wall );
+				//Simulate every tick the clock says is due, rooms tick at the same rate whatever the frame rate
+				for( int due = step.advance(); due > 0; --due )
+				{
+					//Move the dot while the round is on and score it
+					Uint64 tickStart = SDL_GetPerformanceCounter();
+					if( home.match.phase == PHASE_PLAYING && stats.outcome == OUTCOME_NONE )
+					{
+						dot.move( gWalls );
+
+						int zones = applyZones( stats, dot.getPosX(), dot.getPosY(), dot.getVelX(), dot.getVelY(), home.match.phaseTicks * 1000 / TICKS_PER_SECOND );
+						if( zones & ZONE_ENERGY )
+						{
+							Mix_PlayChannel( -1, gHigh, 0 );
+						}
+						if( zones & ZONE_SCORE )
+						{
+							Mix_PlayChannel( -1, gMedium, 0 );
+						}
+						if( checkOutcome( stats, dot.getPosX(), dot.getPosY() ) != OUTCOME_NONE )
+						{
+							Mix_PlayChannel( -1, gScratch, 0 );
+						}
+					}
+
+					//Run every room's network traffic
+					for( int i = 0; i < MAX_ROOMS; ++i )
+					{
+						updateRoom( i, gWalls, (uint32_t)clock.nowMicros() );
+					}
+					gMetrics.publishPool( gNet.packets().inFlight() );
+					gMetrics.recordTick( microsSince( tickStart ) );
+				}
 
 				//Center the camera over the dot
 				camera.x = ( dot.getPosX() + Dot::DOT_WIDTH / 2 ) - SCREEN_WIDTH / 2;
@@ -1354,94 +1263,9 @@ int main( int argc, char* args[] )
 				}
 
 				//Set text to be rendered
-				int dX = dot.getPosX();
-				int dY = dot.getPosY();
-				int vX = dot.getVelX();
-				int vY = dot.getVelY();
-				if(dX > 7840 && dY > 1152 && dX < 7872 && dY < 1216 && (vX>5 || vX<-5)){
-					e1+=20;
-					score-=50;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 7104 && dY > 2848 && dX < 7168 && dY < 2912 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 11040 && dY > 576 && dX < 11104 && dY < 608 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 10528 && dY > 3072 && dX < 10560 && dY < 3136 && (vX>5 || vX<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 3392 && dY > 2720 && dX < 3456 && dY < 2752 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 1664 && dY > 512 && dX < 1728 && dY < 544 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 1120 && dY > 3776 && dX < 1184 && dY < 3808 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 1344 && dY > 5440 && dX < 1376 && dY < 5504 && (vX>5 || vX<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 8096 && dY > 2176 && dX < 8128 && dY < 2240 && (vX>5 || vX<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 6464 && dY > 1664 && dX < 6528 && dY < 1696 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 12160 && dY > 1536 && dX < 12224 && dY < 1568 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 3456 && dY > 4000 && dX < 3488 && dY < 4064 && (vX>5 || vX<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 640 && dY > 5312 && dX < 704 && dY < 5344 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 2688 && dY > 2976 && dX < 2752 && dY < 3008 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 3584 && dY > 640 && dX < 3648 && dY < 672 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 9024 && dY > 1152 && dX < 9344 && dY < 1216){}
-				else if(dX > 11104 && dY > 288 && dX < 11168 && dY < 608){}
-				else if(dX > 12480 && dY > 1152 && dX < 12800 && dY < 1216){}
-				else if(dX > 11424 && dY > 2176 && dX < 11744 && dY < 2240){}
-				else if(dX > 12512 && dY > 4000 && dX < 12832 && dY < 4064){}
-				else if(dX > 6368 && dY > 4064 && dX < 6688 && dY < 4128){}
-				else if(dX > 5952 && dY > 704 && dX < 6016 && dY < 1024){}
-				else if(dX > 7936 && dY > 2080 && dX < 8000 && dY < 2400){}
-				else if(dX > 2976 && dY > 2112 && dX < 3296 && dY < 2176){}
-				else if(dX > 768 && dY > 4000 && dX < 832 && dY < 4320){}
-				else{
-					energy = 300 - 0.01*(SDL_GetTicks() - startTime) + e1;
-				}
 				timeText.str( "" );
-				timeText << "Kiddy Bank : " << score ;
-				timeText << " | Energy left : " << energy ;
+				timeText << "Kiddy Bank : " << stats.score ;
+				timeText << " | Energy left : " << stats.energy ;
 				
 				//Render text
 				if( !gTimeTextTexture.loadFromRenderedText( timeText.str().c_str(), textColor ) )
@@ -1449,6 +1273,26 @@ int main( int argc, char* args[] )
 					printf( "Unable to render time texture!\n" );
 				}
 
+				//Set the banner of the room's phase
+				phaseText.str( "" );
+				switch( home.match.phase )
+				{
+					case PHASE_COUNTDOWN:
+					phaseText << countdownSeconds( home.match );
+					break;
+
+					case PHASE_RESULTS:
+					phaseText << "Round " << home.match.round << ( stats.outcome == OUTCOME_WON ? " won" : " lost" ) << " with " << stats.score << " | Next round soon";
+					break;
+
+					default:
+					break;
+				}
+				if( phaseText.str().size() > 0 && !gPhaseTextTexture.loadFromRenderedText( phaseText.str().c_str(), textColor ) )
+				{
+					printf( "Unable to render phase texture!\n" );
+				}
+
 				//Clear screen
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 				SDL_RenderClear( gRenderer );
@@ -1458,30 +1302,30 @@ int main( int argc, char* args[] )
 
 				//Render objects
 				dot.render( camera.x, camera.y );
+				for( int slot = 1; slot < ROOM_PLAYERS; ++slot )
+				{
+					if( gRooms[ 0 ].joined[ slot ] )
+					{
+						gRooms[ 0 ].players[ slot ].render( camera.x, camera.y );
+					}
+				}
 
 				//Render textures
 				gPromptTextTexture.render( ( SCREEN_WIDTH - gPromptTextTexture.getWidth() ) / 2, 0 );
 				gTimeTextTexture.render( ( SCREEN_WIDTH - gTimeTextTexture.getWidth() ) / 2, 32 );
 
-				//Render congrats
-				if(dX>3328 && dY>2400 && dX<3360 && dY<2528 && score>0 && energy>0){
-					gCTexture.render( 320, 32);
-					Mix_PlayChannel( -1, gScratch, 0 );
-					if(e.type == SDL_KEYUP){
-						SDL_Delay(1000);
-						quit = true;
-					}
+				//Render congrats or game over until the round is over, then the phase banner
+				if( home.match.phase != PHASE_RESULTS && stats.outcome == OUTCOME_WON )
+				{
+					gCTexture.render( 320, 32 );
 				}
-
-				//Render game over
-				if( score<0 || energy<=0 ){
-					gGMTexture.render( 160, 64);
-					Mix_PlayChannel( -1, gScratch, 0 );
-					if(e.type == SDL_KEYUP){
-						SDL_Delay(5000);
-						quit = true;
-					}
-					
+				else if( home.match.phase != PHASE_RESULTS && stats.outcome == OUTCOME_LOST )
+				{
+					gGMTexture.render( 160, 64 );
+				}
+				else if( phaseText.str().size() > 0 )
+				{
+					gPhaseTextTexture.render( ( SCREEN_WIDTH - gPhaseTextTexture.getWidth() ) / 2, ( SCREEN_HEIGHT - gPhaseTextTexture.getHeight() ) / 2 );
 				}
 
 				//Update screen
@@ -1490,7 +1334,9 @@ int main( int argc, char* args[] )
 		}
 	}
 
-	//Free resources and close SDL
+	//Stop networking, free resources and close SDL
+	gNet.stop();
+	gMetrics.stop();
 	close();
 
 	return 0;
@@ -0,0 +1,90 @@
+//Prints the stats a running server serves on its local socket
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "stats_socket.hpp"
+
+//Asks the server once and prints the reply, returns false if it could not be reached
+bool query( const char* path, bool json )
+{
+	struct sockaddr_un address;
+	memset( &address, 0, sizeof( address ) );
+	address.sun_family = AF_UNIX;
+	strncpy( address.sun_path, path, sizeof( address.sun_path ) - 1 );
+
+	int connection = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( connection < 0 || connect( connection, (struct sockaddr*)&address, sizeof( address ) ) < 0 )
+	{
+		fprintf( stderr, "Unable to reach a server on %s!\n", path );
+		if( connection >= 0 )
+		{
+			close( connection );
+		}
+		return false;
+	}
+
+	const char* request = json ? "json\n" : "text\n";
+	if( write( connection, request, strlen( request ) ) < 0 )
+	{
+		close( connection );
+		return false;
+	}
+
+	//The server closes the connection once the reply is written
+	char buffer[ 4096 ];
+	ssize_t length;
+	while( ( length = read( connection, buffer, sizeof( buffer ) ) ) > 0 )
+	{
+		fwrite( buffer, 1, length, stdout );
+	}
+	fflush( stdout );
+	close( connection );
+	return true;
+}
+
+int main( int argc, char* args[] )
+{
+	const char* path = STATS_SOCKET_PATH;
+	bool json = false;
+	int interval = 0;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		if( strcmp( args[ i ], "-j" ) == 0 )
+		{
+			json = true;
+		}
+		else if( strcmp( args[ i ], "-w" ) == 0 && i + 1 < argc )
+		{
+			interval = atoi( args[ ++i ] );
+		}
+		else if( args[ i ][ 0 ] != '-' )
+		{
+			path = args[ i ];
+		}
+		else
+		{
+			fprintf( stderr, "Usage: %s [-j] [-w seconds] [socket]\n", args[ 0 ] );
+			return 1;
+		}
+	}
+
+	//Print once, or keep printing every interval seconds
+	do
+	{
+		if( !query( path, json ) )
+		{
+			return 1;
+		}
+		if( interval > 0 )
+		{
+			printf( "\n" );
+			sleep( interval );
+		}
+	} while( interval > 0 );
+
+	return 0;
+}
@@ -0,0 +1,321 @@
+#include <SDL2/SDL.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "metrics.hpp"
+
+void DurationHistogram::record( uint64_t micros )
+{
+	int bucket = 0;
+	while( bucket < BUCKETS - 1 && ( (uint64_t)1 << bucket ) <= micros )
+	{
+		++bucket;
+	}
+	counts[ bucket ]++;
+	samples++;
+	totalMicros += micros;
+	if( micros > maxMicros )
+	{
+		maxMicros = micros;
+	}
+}
+
+uint64_t DurationHistogram::percentile( double fraction ) const
+{
+	uint64_t wanted = (uint64_t)( samples * fraction );
+	uint64_t seen = 0;
+	for( int bucket = 0; bucket < BUCKETS; ++bucket )
+	{
+		seen += counts[ bucket ];
+		if( seen > wanted )
+		{
+			return (uint64_t)1 << bucket;
+		}
+	}
+	return maxMicros;
+}
+
+ServerMetrics::ServerMetrics()
+{
+	//Initialize
+	mStartTime = SDL_GetPerformanceCounter();
+	memset( &mTickTime, 0, sizeof( mTickTime ) );
+	memset( mRooms, 0, sizeof( mRooms ) );
+	memset( mPeers, 0, sizeof( mPeers ) );
+	mSentBytesPerSecond = 0;
+	mReceivedBytesPerSecond = 0;
+	mPacketsInFlight = 0;
+	mBlocksInUse = 0;
+	mHeapFallbacks = 0;
+	mSocket = -1;
+	mRunning = false;
+}
+
+ServerMetrics::~ServerMetrics()
+{
+	//Shut down
+	stop();
+}
+
+void ServerMetrics::recordTick( uint64_t micros )
+{
+	std::lock_guard<std::mutex> guard( mLock );
+	mTickTime.record( micros );
+}
+
+void ServerMetrics::publishRoom( int room, int players, int tick, size_t inboundDepth, size_t outboundDepth, uint64_t micros )
+{
+	std::lock_guard<std::mutex> guard( mLock );
+	RoomStats& stats = mRooms[ room ];
+	stats.players = players;
+	stats.tick = tick;
+	stats.inboundDepth = inboundDepth;
+	stats.outboundDepth = outboundDepth;
+	stats.tickTime.record( micros );
+}
+
+void ServerMetrics::recordDesync( int room )
+{
+	std::lock_guard<std::mutex> guard( mLock );
+	++mRooms[ room ].desyncs;
+}
+
+void ServerMetrics::recordLateInput( int room )
+{
+	std::lock_guard<std::mutex> guard( mLock );
+	++mRooms[ room ].lateInputs;
+}
+
+void ServerMetrics::publishPool( size_t packetsInFlight )
+{
+	std::lock_guard<std::mutex> guard( mLock );
+	mPacketsInFlight = packetsInFlight;
+}
+
+void ServerMetrics::publishPeers( const PeerStats peers[ MAX_ROOMS ][ ROOM_PLAYERS ] )
+{
+	std::lock_guard<std::mutex> guard( mLock );
+	memcpy( mPeers, peers, sizeof( mPeers ) );
+}
+
+void ServerMetrics::publishHost( uint32_t sentBytesPerSecond, uint32_t receivedBytesPerSecond, size_t blocksInUse, size_t heapFallbacks )
+{
+	std::lock_guard<std::mutex> guard( mLock );
+	mSentBytesPerSecond = sentBytesPerSecond;
+	mReceivedBytesPerSecond = receivedBytesPerSecond;
+	mBlocksInUse = blocksInUse;
+	mHeapFallbacks = heapFallbacks;
+}
+
+bool ServerMetrics::serve( const char* path )
+{
+	//Replace a socket left behind by an earlier run
+	struct sockaddr_un address;
+	memset( &address, 0, sizeof( address ) );
+	address.sun_family = AF_UNIX;
+	strncpy( address.sun_path, path, sizeof( address.sun_path ) - 1 );
+	unlink( path );
+
+	mSocket = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( mSocket < 0 || bind( mSocket, (struct sockaddr*)&address, sizeof( address ) ) < 0 || listen( mSocket, 4 ) < 0 )
+	{
+		printf( "Unable to serve stats on %s! %s\n", path, strerror( errno ) );
+		if( mSocket >= 0 )
+		{
+			close( mSocket );
+			mSocket = -1;
+		}
+		return false;
+	}
+
+	mPath = path;
+	mRunning = true;
+	mThread = std::thread( &ServerMetrics::run, this );
+	return true;
+}
+
+void ServerMetrics::stop()
+{
+	if( !mRunning )
+	{
+		return;
+	}
+
+	mRunning = false;
+	mThread.join();
+	close( mSocket );
+	mSocket = -1;
+	unlink( mPath.c_str() );
+}
+
+void ServerMetrics::run()
+{
+	while( mRunning )
+	{
+		//Wake up regularly to notice stop()
+		struct pollfd listener = { mSocket, POLLIN, 0 };
+		if( poll( &listener, 1, 200 ) <= 0 )
+		{
+			continue;
+		}
+
+		int connection = accept( mSocket, NULL, NULL );
+		if( connection < 0 )
+		{
+			continue;
+		}
+
+		//The request is one word, "json" or anything else for text
+		char request[ 16 ] = { 0 };
+		struct pollfd reader = { connection, POLLIN, 0 };
+		if( poll( &reader, 1, 200 ) > 0 )
+		{
+			ssize_t length = read( connection, request, sizeof( request ) - 1 );
+			request[ length > 0 ? length : 0 ] = '\0';
+		}
+
+		std::string reply = strncmp( request, "json", 4 ) == 0 ? toJson() : toText();
+		size_t written = 0;
+		while( written < reply.size() )
+		{
+			ssize_t sent = write( connection, reply.data() + written, reply.size() - written );
+			if( sent <= 0 )
+			{
+				break;
+			}
+			written += sent;
+		}
+		close( connection );
+	}
+}
+
+void ServerMetrics::copyFigures( MetricsFigures& figures )
+{
+	std::lock_guard<std::mutex> guard( mLock );
+	figures.tickTime = mTickTime;
+	memcpy( figures.rooms, mRooms, sizeof( mRooms ) );
+	memcpy( figures.peers, mPeers, sizeof( mPeers ) );
+	figures.sentBytesPerSecond = mSentBytesPerSecond;
+	figures.receivedBytesPerSecond = mReceivedBytesPerSecond;
+	figures.packetsInFlight = mPacketsInFlight;
+	figures.blocksInUse = mBlocksInUse;
+	figures.heapFallbacks = mHeapFallbacks;
+}
+
+std::string ServerMetrics::toJson()
+{
+	MetricsFigures figures;
+	copyFigures( figures );
+	std::string out;
+	char line[ 512 ];
+
+	double uptime = (double)( SDL_GetPerformanceCounter() - mStartTime ) / SDL_GetPerformanceFrequency();
+	snprintf( line, sizeof( line ), "{\"uptime_s\":%.1f,\"ticks\":%llu,\"tick_us\":{\"mean\":%llu,\"p50\":%llu,\"p99\":%llu,\"max\":%llu,\"buckets\":[",
+		uptime, (unsigned long long)figures.tickTime.samples, (unsigned long long)( figures.tickTime.samples > 0 ? figures.tickTime.totalMicros / figures.tickTime.samples : 0 ),
+		(unsigned long long)figures.tickTime.percentile( 0.5 ), (unsigned long long)figures.tickTime.percentile( 0.99 ), (unsigned long long)figures.tickTime.maxMicros );
+	out += line;
+	for( int i = 0; i < DurationHistogram::BUCKETS; ++i )
+	{
+		snprintf( line, sizeof( line ), "%s%llu", i > 0 ? "," : "", (unsigned long long)figures.tickTime.counts[ i ] );
+		out += line;
+	}
+	out += "]},\"rooms\":[";
+
+	bool first = true;
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		const RoomStats& stats = figures.rooms[ room ];
+		snprintf( line, sizeof( line ), "%s{\"id\":%d,\"players\":%d,\"tick\":%d,\"inbound\":%zu,\"outbound\":%zu,\"desyncs\":%d,\"late_inputs\":%d,\"tick_us_mean\":%llu,\"tick_us_p99\":%llu,\"tick_us_max\":%llu}",
+			first ? "" : ",", room, stats.players, stats.tick, stats.inboundDepth, stats.outboundDepth, stats.desyncs, stats.lateInputs,
+			(unsigned long long)( stats.tickTime.samples > 0 ? stats.tickTime.totalMicros / stats.tickTime.samples : 0 ),
+			(unsigned long long)stats.tickTime.percentile( 0.99 ), (unsigned long long)stats.tickTime.maxMicros );
+		out += line;
+		first = false;
+	}
+	out += "],\"peers\":[";
+
+	first = true;
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			const PeerStats& peer = figures.peers[ room ][ slot ];
+			if( !peer.connected )
+			{
+				continue;
+			}
+			snprintf( line, sizeof( line ), "%s{\"room\":%d,\"slot\":%d,\"address\":\"%s\",\"rtt_ms\":%u,\"rtt_var_ms\":%u,\"loss\":%.4f,\"throttle\":%u,\"in_bytes_per_s\":%u,\"out_bytes_per_s\":%u,\"snapshot_interval\":%d,\"snapshot_players\":%d}",
+				first ? "" : ",", room, slot, peer.address, peer.rttMs, peer.rttVarianceMs, peer.loss, peer.throttle, peer.bytesIn, peer.bytesOut, peer.snapshotInterval, peer.snapshotPlayers );
+			out += line;
+			first = false;
+		}
+	}
+
+	snprintf( line, sizeof( line ), "],\"host\":{\"sent_bytes_per_s\":%u,\"received_bytes_per_s\":%u},\"pool\":{\"packets_in_flight\":%zu,\"blocks_in_use\":%zu,\"heap_fallbacks\":%zu}}\n",
+		figures.sentBytesPerSecond, figures.receivedBytesPerSecond, figures.packetsInFlight, figures.blocksInUse, figures.heapFallbacks );
+	out += line;
+	return out;
+}
+
+std::string ServerMetrics::toText()
+{
+	MetricsFigures figures;
+	copyFigures( figures );
+	std::string out;
+	char line[ 512 ];
+
+	int activeRooms = 0;
+	int players = 0;
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		if( figures.rooms[ room ].players > 0 )
+		{
+			++activeRooms;
+			players += figures.rooms[ room ].players;
+		}
+	}
+
+	double uptime = (double)( SDL_GetPerformanceCounter() - mStartTime ) / SDL_GetPerformanceFrequency();
+	snprintf( line, sizeof( line ), "uptime %.1f s, %llu ticks, %d rooms active, %d players\n", uptime, (unsigned long long)figures.tickTime.samples, activeRooms, players );
+	out += line;
+	snprintf( line, sizeof( line ), "tick   mean %llu us, p50 < %llu us, p99 < %llu us, max %llu us\n",
+		(unsigned long long)( figures.tickTime.samples > 0 ? figures.tickTime.totalMicros / figures.tickTime.samples : 0 ),
+		(unsigned long long)figures.tickTime.percentile( 0.5 ), (unsigned long long)figures.tickTime.percentile( 0.99 ), (unsigned long long)figures.tickTime.maxMicros );
+	out += line;
+
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		const RoomStats& stats = figures.rooms[ room ];
+		if( stats.players == 0 )
+		{
+			continue;
+		}
+		snprintf( line, sizeof( line ), "room %d %d players, tick %d, mean %llu us, p99 < %llu us, max %llu us, inbound %zu, outbound %zu, desyncs %d, late inputs %d\n",
+			room, stats.players, stats.tick, (unsigned long long)( stats.tickTime.samples > 0 ? stats.tickTime.totalMicros / stats.tickTime.samples : 0 ),
+			(unsigned long long)stats.tickTime.percentile( 0.99 ), (unsigned long long)stats.tickTime.maxMicros, stats.inboundDepth, stats.outboundDepth, stats.desyncs, stats.lateInputs );
+		out += line;
+	}
+
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			const PeerStats& peer = figures.peers[ room ][ slot ];
+			if( peer.connected )
+			{
+				snprintf( line, sizeof( line ), "peer %d/%d %s rtt %u +- %u ms, loss %.1f%%, throttle %u/%d, in %u B/s, out %u B/s, snapshots every %d ticks with %d dots\n",
+					room, slot, peer.address, peer.rttMs, peer.rttVarianceMs, peer.loss * 100.0, peer.throttle, ENET_PEER_PACKET_THROTTLE_SCALE, peer.bytesIn, peer.bytesOut, peer.snapshotInterval, peer.snapshotPlayers );
+				out += line;
+			}
+		}
+	}
+
+	snprintf( line, sizeof( line ), "host   sent %u B/s, received %u B/s\npool   %zu packets in flight, %zu blocks in use, %zu heap fallbacks\n",
+		figures.sentBytesPerSecond, figures.receivedBytesPerSecond, figures.packetsInFlight, figures.blocksInUse, figures.heapFallbacks );
+	out += line;
+	return out;
+}
@@ -0,0 +1,160 @@
+//Server health figures and the local socket that serves them
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "netthread.hpp"
+#include "stats_socket.hpp"
+
+//Counts durations in power of two buckets of microseconds
+struct DurationHistogram
+{
+    //Bucket i counts durations below 2^i microseconds that did not fit an earlier bucket
+    static const int BUCKETS = 24;
+
+    uint64_t counts[ BUCKETS ];
+    uint64_t samples;
+    uint64_t totalMicros;
+    uint64_t maxMicros;
+
+    //Adds one duration
+    void record( uint64_t micros );
+
+    //Upper bound of the bucket holding the given fraction of samples
+    uint64_t percentile( double fraction ) const;
+};
+
+//One room as its simulation last published it
+struct RoomStats
+{
+    int players;
+    int tick;
+    size_t inboundDepth;
+    size_t outboundDepth;
+    DurationHistogram tickTime;
+
+    //Seats whose client simulation parted from the server's
+    int desyncs;
+
+    //Inputs that reached the room after the tick that should have played them
+    int lateInputs;
+};
+
+//One peer as the network thread last saw it
+struct PeerStats
+{
+    bool connected;
+    char address[ 32 ];
+
+    //Smoothed round trip time and its variance
+    uint32_t rttMs;
+    uint32_t rttVarianceMs;
+
+    //Fraction of reliable packets ENet had to resend
+    double loss;
+
+    //Unreliable packets ENet lets through, out of ENET_PEER_PACKET_THROTTLE_SCALE
+    uint32_t throttle;
+
+    //Bytes moved during ENet's current one second window
+    uint32_t bytesIn;
+    uint32_t bytesOut;
+
+    //Ticks between the peer's snapshots and the most dots each carries
+    int snapshotInterval;
+    int snapshotPlayers;
+};
+
+//Every figure at one moment, copied out under the lock so formatting a report never holds up a tick
+struct MetricsFigures
+{
+    DurationHistogram tickTime;
+    RoomStats rooms[ MAX_ROOMS ];
+    PeerStats peers[ MAX_ROOMS ][ ROOM_PLAYERS ];
+    uint32_t sentBytesPerSecond;
+    uint32_t receivedBytesPerSecond;
+    size_t packetsInFlight;
+    size_t blocksInUse;
+    size_t heapFallbacks;
+};
+
+class ServerMetrics
+{
+    public:
+        //Initializes variables
+        ServerMetrics();
+
+        //Stops serving
+        ~ServerMetrics();
+
+        //Records one whole simulation tick (simulation thread)
+        void recordTick( uint64_t micros );
+
+        //Records one room's tick (simulation thread)
+        void publishRoom( int room, int players, int tick, size_t inboundDepth, size_t outboundDepth, uint64_t micros );
+
+        //Counts a seat that desynced (simulation thread)
+        void recordDesync( int room );
+
+        //Counts an input that came after its tick (simulation thread)
+        void recordLateInput( int room );
+
+        //Records how many packet buffers are in flight (simulation thread)
+        void publishPool( size_t packetsInFlight );
+
+        //Replaces every peer's figures, indexed by room then slot (network thread)
+        void publishPeers( const PeerStats peers[ MAX_ROOMS ][ ROOM_PLAYERS ] );
+
+        //Records host wide traffic and allocator use (network thread)
+        void publishHost( uint32_t sentBytesPerSecond, uint32_t receivedBytesPerSecond, size_t blocksInUse, size_t heapFallbacks );
+
+        //Starts answering requests on a local socket at path
+        bool serve( const char* path );
+
+        //Stops answering requests and removes the socket
+        void stop();
+
+        //Renders every figure as JSON or as lines of text
+        std::string toJson();
+        std::string toText();
+
+    private:
+        //Socket thread body
+        void run();
+
+        //Copies every figure under the lock
+        void copyFigures( MetricsFigures& figures );
+
+        //Guards every figure below
+        std::mutex mLock;
+
+        //When the server started, in SDL performance counter units
+        uint64_t mStartTime;
+
+        //Whole ticks
+        DurationHistogram mTickTime;
+
+        //Per room and per peer figures
+        RoomStats mRooms[ MAX_ROOMS ];
+        PeerStats mPeers[ MAX_ROOMS ][ ROOM_PLAYERS ];
+
+        //Host and allocator figures
+        uint32_t mSentBytesPerSecond;
+        uint32_t mReceivedBytesPerSecond;
+        size_t mPacketsInFlight;
+        size_t mBlocksInUse;
+        size_t mHeapFallbacks;
+
+        //The listening socket and the thread answering it
+        int mSocket;
+        std::string mPath;
+        std::thread mThread;
+        std::atomic<bool> mRunning;
+};
+
+#endif
@@ -0,0 +1,506 @@
+#include <stdio.h>
+#include <string.h>
+#include "block_allocator.hpp"
+#include "match.hpp"
+#include "metrics.hpp"
+#include "netthread.hpp"
+
+NetThread::NetThread()
+{
+	//Initialize
+	mHost = NULL;
+	mRunning = false;
+	mMetrics = NULL;
+	mLastStatsTime = 0;
+	mLastSentData = 0;
+	mLastReceivedData = 0;
+	mLastLinkTime = 0;
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			mPeers[ room ][ slot ] = NULL;
+			mReserved[ room ][ slot ] = false;
+			mHeld[ room ][ slot ] = false;
+			mHeldSince[ room ][ slot ] = 0;
+			mTokens[ room ][ slot ] = 0;
+			mLastInputTick[ room ][ slot ] = 0;
+			mInputRound[ room ][ slot ] = 0;
+			mLinks[ room ][ slot ] = planLink( 0, 0.0, 1.0, TICKS_PER_SECOND );
+			mSeats[ room ][ slot ].room = room;
+			mSeats[ room ][ slot ].slot = slot;
+		}
+		for( int relay = 0; relay < ROOM_RELAYS; ++relay )
+		{
+			mRelays[ room ][ relay ] = NULL;
+		}
+		mRelayCount[ room ] = 0;
+	}
+}
+
+NetThread::~NetThread()
+{
+	//Shut down
+	stop();
+}
+
+void NetThread::reserve( int room, int slot )
+{
+	mReserved[ room ][ slot ] = true;
+}
+
+void NetThread::setMetrics( ServerMetrics* metrics )
+{
+	mMetrics = metrics;
+}
+
+bool NetThread::start( int port )
+{
+	//Allocate everything steady state traffic needs up front
+	if( !mPackets.init() )
+	{
+		return false;
+	}
+	if( !initializeENetWithBlocks() )
+	{
+		printf( "An error occurred while initializing ENet!\n" );
+		return false;
+	}
+
+	//Bind the server to every local address
+	ENetAddress address = { 0 };
+	address.host = ENET_HOST_ANY;
+	address.port = port;
+	mHost = enet_host_create( &address, MAX_ROOMS * ( ROOM_PLAYERS + ROOM_RELAYS ), CHANNEL_COUNT, 0, 0 );
+	if( mHost == NULL )
+	{
+		printf( "An error occurred while trying to create an ENet server host!\n" );
+		enet_deinitialize();
+		return false;
+	}
+
+	//Service the host from here on
+	mLastStatsTime = enet_time_get();
+	mRandom = mLastStatsTime ^ 0x9E3779B9;
+	mRunning = true;
+	mThread = std::thread( &NetThread::run, this );
+	return true;
+}
+
+void NetThread::stop()
+{
+	if( !mRunning )
+	{
+		return;
+	}
+
+	//Let the thread finish its pass
+	mRunning = false;
+	mThread.join();
+
+	enet_host_destroy( mHost );
+	mHost = NULL;
+	enet_deinitialize();
+}
+
+NetCommandQueue& NetThread::inbound( int room )
+{
+	return mInbound[ room ];
+}
+
+OutPacketQueue& NetThread::outbound( int room )
+{
+	return mOutbound[ room ];
+}
+
+PacketPool& NetThread::packets()
+{
+	return mPackets;
+}
+
+int NetThread::relays( int room )
+{
+	return mRelayCount[ room ];
+}
+
+void NetThread::run()
+{
+	ENetEvent event;
+	while( mRunning )
+	{
+		//Hand over whatever the rooms produced since the last pass
+		sendOutbound();
+		publishStats();
+		updateLinks();
+		releaseHeldSeats();
+
+		//Wait briefly for traffic, then take everything that is pending
+		int status = enet_host_service( mHost, &event, 1 );
+		while( status > 0 )
+		{
+			handleEvent( event );
+			status = enet_host_service( mHost, &event, 0 );
+		}
+	}
+}
+
+void NetThread::handleEvent( ENetEvent& event )
+{
+	Seat* seat = (Seat*)event.peer->data;
+	NetCommand command;
+	ClockSample sample;
+	InputBatch batch;
+
+	switch( event.type )
+	{
+		case ENET_EVENT_TYPE_CONNECT:
+		{
+			//A relay asks to watch a room rather than play in it
+			if( event.data & SPECTATE_DATA )
+			{
+				int room = event.data & ~SPECTATE_DATA;
+				if( room >= MAX_ROOMS || !addRelay( event.peer, room ) )
+				{
+					printf( "Refusing a relay for room %d.\n", room );
+					enet_peer_disconnect( event.peer, 0 );
+				}
+				break;
+			}
+
+			//A returning client passes its session token as connect data
+			int room, slot;
+			bool resumed = event.data != 0 && findSeat( event.data, room, slot );
+			if( !resumed && !takeSeat( room, slot ) )
+			{
+				printf( "Server full, refusing a connection.\n" );
+				enet_peer_disconnect( event.peer, 0 );
+				break;
+			}
+
+			//A fresh seat is only taken once its room has been told, a room too busy to hear of it turns the client away
+			if( !resumed )
+			{
+				command.type = NET_JOIN;
+				command.slot = slot;
+				if( !mInbound[ room ].push( command ) )
+				{
+					printf( "Room %d is busy, refusing a connection.\n", room );
+					enet_peer_disconnect( event.peer, 0 );
+					break;
+				}
+			}
+
+			//A reconnect can beat the timeout of the connection it replaces
+			if( resumed && mPeers[ room ][ slot ] != NULL )
+			{
+				mPeers[ room ][ slot ]->data = NULL;
+				enet_peer_reset( mPeers[ room ][ slot ] );
+			}
+			mPeers[ room ][ slot ] = event.peer;
+			mHeld[ room ][ slot ] = false;
+			event.peer->data = &mSeats[ room ][ slot ];
+
+			//A new session starts a fresh dot
+			if( !resumed )
+			{
+				do
+				{
+					mRandom ^= mRandom << 13;
+					mRandom ^= mRandom >> 17;
+					mRandom ^= mRandom << 5;
+				} while( ( mRandom & ~SPECTATE_DATA ) == 0 );
+				mTokens[ room ][ slot ] = mRandom & ~SPECTATE_DATA;
+				mLastInputTick[ room ][ slot ] = 0;
+				mInputRound[ room ][ slot ] = 0;
+
+				//Rooms start a new seat on a full budget
+				mLinks[ room ][ slot ] = planLink( 0, 0.0, 1.0, TICKS_PER_SECOND );
+			}
+
+			//Tell the client where it sits and which inputs it still has to send
+			WelcomeMsg welcome = { room, slot, mTokens[ room ][ slot ], mLastInputTick[ room ][ slot ], resumed };
+			unsigned char data[ MAX_MESSAGE_SIZE ];
+			int length = encodeWelcome( welcome, data );
+			enet_peer_send( event.peer, CHANNEL_RELIABLE, enet_packet_create( data, length, ENET_PACKET_FLAG_RELIABLE ) );
+			break;
+		}
+
+		case ENET_EVENT_TYPE_RECEIVE:
+			//Decode and pass on to the peer's room
+			if( seat != NULL && decodeInputBatch( event.packet->data, event.packet->dataLength, batch ) )
+			{
+				//Every round numbers its ticks from one again
+				int& lastTick = mLastInputTick[ seat->room ][ seat->slot ];
+				if( batch.round != mInputRound[ seat->room ][ seat->slot ] )
+				{
+					mInputRound[ seat->room ][ seat->slot ] = batch.round;
+					lastTick = 0;
+				}
+
+				//A batch starts at or before the first tick not received, so passing on only the new ticks keeps them in order
+				command.type = NET_INPUT;
+				command.slot = seat->slot;
+				for( int i = 0; i < batch.count; ++i )
+				{
+					command.input.tick = batch.firstTick + i;
+					command.input.buttons = batch.buttons[ i ];
+					if( command.input.tick == lastTick + 1 && mInbound[ seat->room ].push( command ) )
+					{
+						lastTick = command.input.tick;
+					}
+				}
+			}
+			else if( seat != NULL && decodeHash( event.packet->data, event.packet->dataLength, command.report ) )
+			{
+				//Inputs travel unreliably, the room holds a hash until it has played the tick it covers
+				command.type = NET_HASH;
+				command.slot = seat->slot;
+				mInbound[ seat->room ].push( command );
+			}
+			else if( decodePing( event.packet->data, event.packet->dataLength, sample ) )
+			{
+				//Answered here rather than by the room, so the time it waits in a queue does not count against the clock
+				sample.serverReceived = (uint32_t)mClock.nowMicros();
+				unsigned char data[ MAX_MESSAGE_SIZE ];
+				sample.serverSent = (uint32_t)mClock.nowMicros();
+				int length = encodePong( sample, data );
+				enet_peer_send( event.peer, CHANNEL_UNRELIABLE, enet_packet_create( data, length, 0 ) );
+			}
+			enet_packet_destroy( event.packet );
+			break;
+
+		case ENET_EVENT_TYPE_DISCONNECT:
+			//Hold the seat in case the client comes back
+			if( seat != NULL )
+			{
+				mPeers[ seat->room ][ seat->slot ] = NULL;
+				mHeld[ seat->room ][ seat->slot ] = true;
+				mHeldSince[ seat->room ][ seat->slot ] = enet_time_get();
+				event.peer->data = NULL;
+			}
+			else
+			{
+				dropRelay( event.peer );
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+void NetThread::sendOutbound()
+{
+	OutPacket packet;
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		while( mOutbound[ room ].pop( packet ) )
+		{
+			//One packet shared by every receiver, ENet counts the references
+			enet_uint32 flags = packet.channel == CHANNEL_RELIABLE ? ENET_PACKET_FLAG_RELIABLE : 0;
+			ENetPacket* shared = PacketPool::wrap( packet.buffer, flags );
+			if( shared == NULL )
+			{
+				PacketPool::giveBack( packet.buffer );
+				continue;
+			}
+
+			for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+			{
+				ENetPeer* peer = mPeers[ room ][ slot ];
+				if( peer != NULL && ( packet.slot == -1 || packet.slot == slot ) )
+				{
+					enet_peer_send( peer, packet.channel, shared );
+				}
+			}
+			for( int relay = 0; relay < ROOM_RELAYS && packet.slot == OUT_RELAYS; ++relay )
+			{
+				if( mRelays[ room ][ relay ] != NULL )
+				{
+					enet_peer_send( mRelays[ room ][ relay ], packet.channel, shared );
+				}
+			}
+
+			//Nobody took it, so return the buffer now
+			if( shared->referenceCount == 0 )
+			{
+				enet_packet_destroy( shared );
+			}
+		}
+	}
+}
+
+void NetThread::publishStats()
+{
+	enet_uint32 now = enet_time_get();
+	enet_uint32 elapsed = now - mLastStatsTime;
+	if( mMetrics == NULL || elapsed < STATS_INTERVAL )
+	{
+		return;
+	}
+
+	//Read what ENet keeps about every seated peer
+	PeerStats peers[ MAX_ROOMS ][ ROOM_PLAYERS ];
+	memset( peers, 0, sizeof( peers ) );
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			ENetPeer* peer = mPeers[ room ][ slot ];
+			if( peer == NULL )
+			{
+				continue;
+			}
+
+			PeerStats& stats = peers[ room ][ slot ];
+			char ip[ 20 ] = "?";
+			enet_address_get_host_ip( &peer->address, ip, sizeof( ip ) );
+			snprintf( stats.address, sizeof( stats.address ), "%s:%u", ip, (unsigned)peer->address.port );
+			stats.connected = true;
+			stats.rttMs = peer->roundTripTime;
+			stats.rttVarianceMs = peer->roundTripTimeVariance;
+			stats.loss = (double)peer->packetLoss / ENET_PACKET_LOSS_SCALE;
+			stats.throttle = peer->packetThrottle;
+			stats.bytesIn = peer->incomingDataTotal;
+			stats.bytesOut = peer->outgoingDataTotal;
+			stats.snapshotInterval = mLinks[ room ][ slot ].interval;
+			stats.snapshotPlayers = mLinks[ room ][ slot ].players;
+		}
+	}
+	mMetrics->publishPeers( peers );
+
+	//Host totals wrap around, so only their difference is used
+	enet_uint32 sent = mHost->totalSentData - mLastSentData;
+	enet_uint32 received = mHost->totalReceivedData - mLastReceivedData;
+	mMetrics->publishHost( (uint32_t)( (uint64_t)sent * 1000 / elapsed ), (uint32_t)( (uint64_t)received * 1000 / elapsed ), blockAllocatorInUse(), blockAllocatorFallbacks() );
+
+	mLastStatsTime = now;
+	mLastSentData = mHost->totalSentData;
+	mLastReceivedData = mHost->totalReceivedData;
+}
+
+void NetThread::updateLinks()
+{
+	enet_uint32 now = enet_time_get();
+	if( now - mLastLinkTime < LINK_INTERVAL )
+	{
+		return;
+	}
+	mLastLinkTime = now;
+
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			ENetPeer* peer = mPeers[ room ][ slot ];
+			if( peer == NULL )
+			{
+				continue;
+			}
+
+			//Only changes go to the room, most links hold steady
+			LinkBudget link = planLink( peer->roundTripTime, (double)peer->packetLoss / ENET_PACKET_LOSS_SCALE, (double)peer->packetThrottle / ENET_PEER_PACKET_THROTTLE_SCALE, TICKS_PER_SECOND );
+			if( sameLink( link, mLinks[ room ][ slot ] ) )
+			{
+				continue;
+			}
+
+			NetCommand command;
+			command.type = NET_LINK;
+			command.slot = slot;
+			command.link = link;
+			if( mInbound[ room ].push( command ) )
+			{
+				mLinks[ room ][ slot ] = link;
+			}
+		}
+	}
+}
+
+bool NetThread::addRelay( ENetPeer* peer, int room )
+{
+	for( int relay = 0; relay < ROOM_RELAYS; ++relay )
+	{
+		if( mRelays[ room ][ relay ] == NULL )
+		{
+			mRelays[ room ][ relay ] = peer;
+			++mRelayCount[ room ];
+			enet_peer_timeout( peer, 0, 2000, 5000 );
+			printf( "A relay is watching room %d.\n", room );
+			return true;
+		}
+	}
+	return false;
+}
+
+void NetThread::dropRelay( ENetPeer* peer )
+{
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( int relay = 0; relay < ROOM_RELAYS; ++relay )
+		{
+			if( mRelays[ room ][ relay ] == peer )
+			{
+				mRelays[ room ][ relay ] = NULL;
+				--mRelayCount[ room ];
+				printf( "A relay stopped watching room %d.\n", room );
+			}
+		}
+	}
+}
+
+bool NetThread::takeSeat( int& room, int& slot )
+{
+	//Fill rooms in order so players end up together
+	for( room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			if( mPeers[ room ][ slot ] == NULL && !mReserved[ room ][ slot ] && !mHeld[ room ][ slot ] )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool NetThread::findSeat( enet_uint32 token, int& room, int& slot )
+{
+	for( room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			if( mTokens[ room ][ slot ] == token && ( mHeld[ room ][ slot ] || mPeers[ room ][ slot ] != NULL ) )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void NetThread::releaseHeldSeats()
+{
+	enet_uint32 now = enet_time_get();
+	for( int room = 0; room < MAX_ROOMS; ++room )
+	{
+		for( int slot = 0; slot < ROOM_PLAYERS; ++slot )
+		{
+			if( mHeld[ room ][ slot ] && now - mHeldSince[ room ][ slot ] > RESUME_GRACE )
+			{
+				//The client is gone for good, the seat stays held until its room has been told
+				NetCommand command;
+				command.type = NET_LEAVE;
+				command.slot = slot;
+				if( !mInbound[ room ].push( command ) )
+				{
+					continue;
+				}
+
+				mHeld[ room ][ slot ] = false;
+				mTokens[ room ][ slot ] = 0;
+			}
+		}
+	}
+}
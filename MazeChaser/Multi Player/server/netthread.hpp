@@ -0,0 +1,195 @@
+//Network thread that owns the server's ENet host
+#ifndef NETTHREAD_HPP
+#define NETTHREAD_HPP
+
+#include <enet/enet.h>
+#include <atomic>
+#include <thread>
+#include "link_budget.hpp"
+#include "packet_pool.hpp"
+#include "performance_clock.hpp"
+#include "protocol.hpp"
+#include "spsc_queue.hpp"
+
+//Number of rooms the server hosts
+const int MAX_ROOMS = 8;
+
+//Most relays watching one room, each one passes the room on to any number of spectators
+const int ROOM_RELAYS = 4;
+
+//Milliseconds between peer statistics updates
+const enet_uint32 STATS_INTERVAL = 500;
+
+//Milliseconds between snapshot budget updates
+const enet_uint32 LINK_INTERVAL = 500;
+
+//Milliseconds a dropped client's seat is held for it to reconnect
+const enet_uint32 RESUME_GRACE = 10000;
+
+class ServerMetrics;
+
+//What the network thread tells a room
+enum NetCommandType
+{
+    NET_JOIN,
+    NET_LEAVE,
+    NET_INPUT,
+    NET_HASH,
+    NET_LINK
+};
+
+//One decoded event for a room's simulation
+struct NetCommand
+{
+    NetCommandType type;
+    int slot;
+    InputCmd input;
+    HashReport report;
+    LinkBudget link;
+};
+
+//Seat of an OutPacket meant for the relays watching the room
+const int OUT_RELAYS = -2;
+
+//One encoded message for the network thread to send
+struct OutPacket
+{
+    //Seat to send to, -1 for everybody seated in the room or OUT_RELAYS
+    int slot;
+    int channel;
+
+    //Buffer taken from the thread's packet pool
+    PacketBuffer* buffer;
+};
+
+//Queues between the network thread and one room
+typedef SpscQueue<NetCommand, 1024> NetCommandQueue;
+typedef SpscQueue<OutPacket, 256> OutPacketQueue;
+
+class NetThread
+{
+    public:
+        //Initializes variables
+        NetThread();
+
+        //Stops the thread if it is still running
+        ~NetThread();
+
+        //Keeps a seat out of the ones handed to peers, call before start
+        void reserve( int room, int slot );
+
+        //Where peer and host statistics are published, call before start
+        void setMetrics( ServerMetrics* metrics );
+
+        //Binds the host to the port and starts servicing it on its own thread
+        bool start( int port );
+
+        //Stops the thread and destroys the host
+        void stop();
+
+        //Commands decoded for a room, popped by that room's simulation
+        NetCommandQueue& inbound( int room );
+
+        //Packets encoded by a room, pushed by that room's simulation
+        OutPacketQueue& outbound( int room );
+
+        //Buffers the simulation encodes outgoing packets into
+        PacketPool& packets();
+
+        //Relays watching a room, read by that room's simulation
+        int relays( int room );
+
+    private:
+        //Which seat a peer is sitting in
+        struct Seat
+        {
+            int room;
+            int slot;
+        };
+
+        //Thread body
+        void run();
+
+        //Reacts to one event from the host
+        void handleEvent( ENetEvent& event );
+
+        //Hands everything the rooms queued to ENet
+        void sendOutbound();
+
+        //Finds a free seat, returns false if the server is full
+        bool takeSeat( int& room, int& slot );
+
+        //Finds the seat a session token was issued for, returns false if it was given up
+        bool findSeat( enet_uint32 token, int& room, int& slot );
+
+        //Gives up seats whose clients did not come back in time
+        void releaseHeldSeats();
+
+        //Lets a relay watch a room, returns false if the room has all the relays it can take
+        bool addRelay( ENetPeer* peer, int room );
+
+        //Forgets a peer if it was a relay
+        void dropRelay( ENetPeer* peer );
+
+        //Publishes peer and host statistics every STATS_INTERVAL
+        void publishStats();
+
+        //Budgets every seated peer's snapshots from its link every LINK_INTERVAL, telling rooms of changes
+        void updateLinks();
+
+        //The host and the thread servicing it
+        ENetHost* mHost;
+        std::thread mThread;
+        std::atomic<bool> mRunning;
+
+        //Peer in each seat, NULL when free
+        ENetPeer* mPeers[ MAX_ROOMS ][ ROOM_PLAYERS ];
+
+        //Seats that are never handed out
+        bool mReserved[ MAX_ROOMS ][ ROOM_PLAYERS ];
+
+        //Relays watching each room, NULL when free
+        ENetPeer* mRelays[ MAX_ROOMS ][ ROOM_RELAYS ];
+
+        //Relays each room has, so a room never waits on a queue to learn of one leaving
+        std::atomic<int> mRelayCount[ MAX_ROOMS ];
+
+        //Seats whose peer dropped, and since when
+        bool mHeld[ MAX_ROOMS ][ ROOM_PLAYERS ];
+        enet_uint32 mHeldSince[ MAX_ROOMS ][ ROOM_PLAYERS ];
+
+        //Session token of each seat, 0 when free, never with SPECTATE_DATA set
+        enet_uint32 mTokens[ MAX_ROOMS ][ ROOM_PLAYERS ];
+
+        //Newest input tick received for each seat, and the round of the batch it came in
+        int mLastInputTick[ MAX_ROOMS ][ ROOM_PLAYERS ];
+        int mInputRound[ MAX_ROOMS ][ ROOM_PLAYERS ];
+
+        //Snapshot budget each seat's room was last told, and when the budgets were last worked out
+        LinkBudget mLinks[ MAX_ROOMS ][ ROOM_PLAYERS ];
+        enet_uint32 mLastLinkTime;
+
+        //State of the token generator
+        enet_uint32 mRandom;
+
+        //Seat descriptions pointed to by ENetPeer::data
+        Seat mSeats[ MAX_ROOMS ][ ROOM_PLAYERS ];
+
+        //Queues shared with each room
+        NetCommandQueue mInbound[ MAX_ROOMS ];
+        OutPacketQueue mOutbound[ MAX_ROOMS ];
+
+        //Buffers behind every outbound packet
+        PacketPool mPackets;
+
+        //Same clock the rooms stamp their snapshots with, read to answer pings
+        PerformanceClock mClock;
+
+        //Statistics sink and the host totals at the last update
+        ServerMetrics* mMetrics;
+        enet_uint32 mLastStatsTime;
+        enet_uint32 mLastSentData;
+        enet_uint32 mLastReceivedData;
+};
+
+#endif
@@ -0,0 +1,8 @@
+//Where the server serves its stats, shared with mcstat so the tool needs nothing else of the server
+#ifndef STATS_SOCKET_HPP
+#define STATS_SOCKET_HPP
+
+//Where the server answers stats requests by default
+const char* const STATS_SOCKET_PATH = "/tmp/mazechaser-server.sock";
+
+#endif
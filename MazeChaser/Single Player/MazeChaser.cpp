@@ -159,33 +159,313 @@ int LTexture::getHeight()
 	return mHeight;
 }
 
+void LTexture::renderScaled( SDL_Rect* dest, SDL_Rect* clip )
+{
+	//Render to screen stretched over the destination
+	SDL_RenderCopy( gRenderer, mTexture, clip, dest );
+}
+
+LTexturePyramid::LTexturePyramid()
+{
+	//Initialize
+	for( int i = 0; i < MAX_LEVELS; ++i )
+	{
+		mLevels[ i ] = NULL;
+	}
+	mLevelCount = 0;
+	mMinimap = NULL;
+	mMinimapWidth = 0;
+	mMinimapHeight = 0;
+	mWidth = 0;
+	mHeight = 0;
+}
+
+LTexturePyramid::~LTexturePyramid()
+{
+	//Deallocate
+	free();
+}
+
+bool LTexturePyramid::loadFromFile( std::string path, int minimapWidth, int minimapHeight )
+{
+	//Get rid of preexisting levels
+	free();
+
+	//Load image at specified path
+	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+	if( loadedSurface == NULL )
+	{
+		printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+		return false;
+	}
+
+	//Work on 32 bit pixels so the levels can be box filtered
+	SDL_Surface* level = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0 );
+	SDL_FreeSurface( loadedSurface );
+	if( level == NULL )
+	{
+		printf( "Unable to convert image %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+		return false;
+	}
+	mWidth = level->w;
+	mHeight = level->h;
+
+	//Upload each level, halving until the next one would be smaller than the minimap
+	bool success = true;
+	while( mLevelCount < MAX_LEVELS )
+	{
+		mLevels[ mLevelCount ] = SDL_CreateTextureFromSurface( gRenderer, level );
+		if( mLevels[ mLevelCount ] == NULL )
+		{
+			printf( "Unable to create level %d texture from %s! SDL Error: %s\n", mLevelCount, path.c_str(), SDL_GetError() );
+			success = false;
+			break;
+		}
+		++mLevelCount;
+
+		int nextWidth = level->w / 2;
+		int nextHeight = level->h / 2;
+		if( mLevelCount == MAX_LEVELS || nextWidth < minimapWidth || nextHeight < minimapHeight )
+		{
+			break;
+		}
+
+		SDL_Surface* next = shrinkSurface( level, nextWidth, nextHeight );
+		if( next == NULL )
+		{
+			break;
+		}
+		SDL_FreeSurface( level );
+		level = next;
+	}
+
+	//Shrink the smallest level once more for the minimap
+	if( success )
+	{
+		SDL_Surface* minimap = shrinkSurface( level, minimapWidth, minimapHeight );
+		if( minimap != NULL )
+		{
+			mMinimap = SDL_CreateTextureFromSurface( gRenderer, minimap );
+			SDL_FreeSurface( minimap );
+		}
+		if( mMinimap == NULL )
+		{
+			printf( "Unable to create minimap from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+			success = false;
+		}
+		else
+		{
+			mMinimapWidth = minimapWidth;
+			mMinimapHeight = minimapHeight;
+		}
+	}
+
+	//Get rid of the last level surface
+	SDL_FreeSurface( level );
+
+	return success;
+}
+
+void LTexturePyramid::free()
+{
+	//Free every level
+	for( int i = 0; i < mLevelCount; ++i )
+	{
+		SDL_DestroyTexture( mLevels[ i ] );
+		mLevels[ i ] = NULL;
+	}
+	mLevelCount = 0;
+
+	//Free the minimap
+	if( mMinimap != NULL )
+	{
+		SDL_DestroyTexture( mMinimap );
+		mMinimap = NULL;
+		mMinimapWidth = 0;
+		mMinimapHeight = 0;
+	}
+	mWidth = 0;
+	mHeight = 0;
+}
+
+void LTexturePyramid::render( SDL_Rect& region, SDL_Rect* dest )
+{
+	if( mLevelCount == 0 )
+	{
+		return;
+	}
+
+	//Full size pixels per screen pixel
+	int destWidth = dest != NULL ? dest->w : SCREEN_WIDTH;
+	double scale = (double)region.w / destWidth;
+
+	//Pick the smallest level that still has at least one pixel per screen pixel
+	int level = 0;
+	while( level + 1 < mLevelCount && scale >= 2.0 )
+	{
+		scale /= 2.0;
+		++level;
+	}
+
+	//Level k is the full image halved k times
+	SDL_Rect clip = { region.x >> level, region.y >> level, region.w >> level, region.h >> level };
+	SDL_RenderCopy( gRenderer, mLevels[ level ], &clip, dest );
+}
+
+void LTexturePyramid::renderMinimap( int x, int y )
+{
+	//Draw the whole level in one copy
+	SDL_Rect renderQuad = { x, y, mMinimapWidth, mMinimapHeight };
+	SDL_RenderCopy( gRenderer, mMinimap, NULL, &renderQuad );
+}
+
+int LTexturePyramid::getWidth()
+{
+	return mWidth;
+}
+
+int LTexturePyramid::getHeight()
+{
+	return mHeight;
+}
+
+LFogTexture::LFogTexture()
+{
+	//Initialize
+	mTexture = NULL;
+	mWidth = 0;
+	mHeight = 0;
+}
+
+LFogTexture::~LFogTexture()
+{
+	//Deallocate
+	free();
+}
+
+bool LFogTexture::create( FogOfWar& fog )
+{
+	//Get rid of preexisting texture
+	free();
+
+	//Streamed, since a few cells change every time the dot crosses into a new one
+	mTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, fog.getColumns(), fog.getRows() );
+	if( mTexture == NULL )
+	{
+		printf( "Unable to create fog texture! SDL Error: %s\n", SDL_GetError() );
+		return false;
+	}
+	SDL_SetTextureBlendMode( mTexture, SDL_BLENDMODE_BLEND );
+	mWidth = fog.getColumns();
+	mHeight = fog.getRows();
+
+	//Start with the whole grid uploaded
+	update( fog );
+	return true;
+}
+
+void LFogTexture::free()
+{
+	//Free texture if it exists
+	if( mTexture != NULL )
+	{
+		SDL_DestroyTexture( mTexture );
+		mTexture = NULL;
+		mWidth = 0;
+		mHeight = 0;
+	}
+}
+
+void LFogTexture::update( FogOfWar& fog )
+{
+	LevelRect cells;
+	if( mTexture == NULL || !fog.takeDirty( cells ) )
+	{
+		return;
+	}
+
+	//Unseen cells are black, explored ones dimmed and visible ones clear
+	const Uint32 shades[ 3 ] = { 0xFF000000, 0xA0000000, 0x00000000 };
+	const uint8_t* states = fog.getStates();
+	mPixels.resize( cells.w * cells.h );
+	for( int row = 0; row < cells.h; ++row )
+	{
+		const uint8_t* from = states + ( cells.y + row ) * mWidth + cells.x;
+		Uint32* to = &mPixels[ row * cells.w ];
+		for( int column = 0; column < cells.w; ++column )
+		{
+			to[ column ] = shades[ from[ column ] ];
+		}
+	}
+
+	SDL_Rect region = { cells.x, cells.y, cells.w, cells.h };
+	SDL_UpdateTexture( mTexture, &region, &mPixels[ 0 ], cells.w * sizeof( Uint32 ) );
+}
+
+void LFogTexture::render( SDL_Rect& camera, double zoom, int cellSize )
+{
+	//Whole cells covering the camera
+	int left = camera.x / cellSize;
+	int top = camera.y / cellSize;
+	int right = ( camera.x + camera.w + cellSize - 1 ) / cellSize;
+	int bottom = ( camera.y + camera.h + cellSize - 1 ) / cellSize;
+	if( right > mWidth )
+	{
+		right = mWidth;
+	}
+	if( bottom > mHeight )
+	{
+		bottom = mHeight;
+	}
+
+	//Stretched over the screen, shifted by however far the camera is into the first cell
+	SDL_Rect clip = { left, top, right - left, bottom - top };
+	SDL_Rect renderQuad = { (int)( ( left * cellSize - camera.x ) / zoom ), (int)( ( top * cellSize - camera.y ) / zoom ), (int)( clip.w * cellSize / zoom ) + 1, (int)( clip.h * cellSize / zoom ) + 1 };
+	SDL_RenderCopy( gRenderer, mTexture, &clip, &renderQuad );
+}
+
 Dot::Dot()
 {
-    //Initialize the offsets
-    mPosX = 10496;
-    mPosY = 32;
+	//Give the dot every component a player has
+	mEntity = gEntities.create( ENTITY_PLAYER, COMPONENT_TRANSFORM | COMPONENT_VELOCITY | COMPONENT_COLLIDER | COMPONENT_STATS | COMPONENT_SPRITE );
+	int index = gEntities.find( mEntity );
 
     //Set collision box dimension
-	mCollider.w = DOT_WIDTH;
-	mCollider.h = DOT_HEIGHT;
+	Collider collider = { DOT_WIDTH, DOT_HEIGHT };
+	gEntities.getColliders()[ index ] = collider;
+	gEntities.getSprites()[ index ].texture = SPRITE_DOT;
+	resetStats( gEntities.getStats()[ index ] );
+
+    //Initialize the offsets, the velocity starts at zero
+	respawn();
+}
 
-    //Initialize the velocity
-    mVelX = 0;
-    mVelY = 0;
+Dot::~Dot()
+{
+	gEntities.destroy( mEntity );
+}
+
+void Dot::respawn()
+{
+	Transform& position = gEntities.getTransforms()[ gEntities.find( mEntity ) ];
+    position.x = RUN_START_X;
+    position.y = RUN_START_Y;
 }
 
 void Dot::handleEvent( SDL_Event& e )
 {
+	Velocity& velocity = gEntities.getVelocities()[ gEntities.find( mEntity ) ];
+
     //If a key was pressed
 	if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
     {
         //Adjust the velocity
         switch( e.key.keysym.sym )
         {
-            case SDLK_UP: mVelY -= DOT_VEL; break;
-            case SDLK_DOWN: mVelY += DOT_VEL; break;
-            case SDLK_LEFT: mVelX -= DOT_VEL; break;
-            case SDLK_RIGHT: mVelX += DOT_VEL; break;
+            case SDLK_UP: velocity.y -= DOT_VEL; break;
+            case SDLK_DOWN: velocity.y += DOT_VEL; break;
+            case SDLK_LEFT: velocity.x -= DOT_VEL; break;
+            case SDLK_RIGHT: velocity.x += DOT_VEL; break;
         }
     }
     //If a key was released
@@ -194,74 +474,63 @@ void Dot::handleEvent( SDL_Event& e )
         //Adjust the velocity
         switch( e.key.keysym.sym )
         {
-            case SDLK_UP: mVelY += DOT_VEL; break;
-            case SDLK_DOWN: mVelY -= DOT_VEL; break;
-            case SDLK_LEFT: mVelX += DOT_VEL; break;
-            case SDLK_RIGHT: mVelX -= DOT_VEL; break;
+            case SDLK_UP: velocity.y += DOT_VEL; break;
+            case SDLK_DOWN: velocity.y -= DOT_VEL; break;
+            case SDLK_LEFT: velocity.x += DOT_VEL; break;
+            case SDLK_RIGHT: velocity.x -= DOT_VEL; break;
         }
     }
 }
 
-void Dot::move( SDL_Rect wall[] )
+int Dot::getPosX()
 {
-    //Move the dot left or right
-    mPosX += mVelX;
-	mCollider.x = mPosX;
-	//Move the dot up or down
-    mPosY += mVelY;
-    mCollider.y = mPosY;
-	bool c = false;
-	// int i=0;
-	// while(i<18){
-	// 	c = c || checkCollision( mCollider, wall[i] );
-	// 	i++;
-	// }
-	for (int i = 0; i < 99; i++)
-	{
-		c = c || checkCollision( mCollider, wall[i] );
-	}
-	
-    //If the dot collided or went too far to the left or right
-    if( ( mPosX < 0 ) || ( mPosX + DOT_WIDTH > LEVEL_WIDTH ) || c )
-    {
-        //Move back
-        mPosX -= mVelX;
-		mCollider.x = mPosX;
-    }
+	return gEntities.getTransforms()[ gEntities.find( mEntity ) ].x;
+}
 
-    //If the dot collided or went too far up or down
-    if( ( mPosY < 0 ) || ( mPosY + DOT_HEIGHT > LEVEL_HEIGHT ) || c )
-    {
-        //Move back
-        mPosY -= mVelY;
-		mCollider.y = mPosY;
-    }
+int Dot::getPosY()
+{
+	return gEntities.getTransforms()[ gEntities.find( mEntity ) ].y;
 }
 
-void Dot::render( int camX, int camY )
+int Dot::getVelX()
 {
-    //Show the dot relative to the camera
-	gDotTexture.render( mPosX - camX, mPosY - camY );
+	return gEntities.getVelocities()[ gEntities.find( mEntity ) ].x;
 }
 
-int Dot::getPosX()
+int Dot::getVelY()
 {
-	return mPosX;
+	return gEntities.getVelocities()[ gEntities.find( mEntity ) ].y;
 }
 
-int Dot::getPosY()
+PlayerStats& Dot::getStats()
 {
-	return mPosY;
+	return gEntities.getStats()[ gEntities.find( mEntity ) ];
 }
 
-int Dot::getVelX()
+Transform& Dot::getTransform()
 {
-	return mVelX;
+	return gEntities.getTransforms()[ gEntities.find( mEntity ) ];
 }
 
-int Dot::getVelY()
+void renderEntities( EntityStore& store, SDL_Rect& camera, double zoom )
 {
-	return mVelY;
+	int count = store.getCount();
+	const int* components = store.getComponents();
+	const Transform* transforms = store.getTransforms();
+	const Sprite* sprites = store.getSprites();
+
+	for( int i = 0; i < count; ++i )
+	{
+		if( ( components[ i ] & ( COMPONENT_TRANSFORM | COMPONENT_SPRITE ) ) != ( COMPONENT_TRANSFORM | COMPONENT_SPRITE ) )
+		{
+			continue;
+		}
+
+		//Show it relative to the camera, shrunk along with the background
+		LTexture* texture = gSpriteTextures[ sprites[ i ].texture ];
+		SDL_Rect renderQuad = { (int)( ( transforms[ i ].x - camera.x ) / zoom ), (int)( ( transforms[ i ].y - camera.y ) / zoom ), (int)( texture->getWidth() / zoom ), (int)( texture->getHeight() / zoom ) };
+		texture->renderScaled( &renderQuad );
+	}
 }
 
 bool init()
@@ -337,6 +606,27 @@ bool loadMedia()
 	//Loading success flag
 	bool success = true;
 
+	//Load the walls and lay them on the collision grid
+	if( !loadLevel( "campus.lvl", gLevel ) )
+	{
+		printf( "Failed to load level!\n" );
+		success = false;
+	}
+	else
+	{
+		gWalls.build( gLevel, COLLISION_CELL );
+		gSpawns.create( gWalls );
+		sweepSpawns( gSpawns );
+		gField.create( gWalls );
+		gFog.create( gWalls, FOG_RADIUS );
+		gRewind.create( sizeof( GameState ), REWIND_TICKS );
+		if( !gFogTexture.create( gFog ) )
+		{
+			printf( "Failed to create fog texture!\n" );
+			success = false;
+		}
+	}
+
 	//Load music
 	gMusic = Mix_LoadMUS( "beat.wav" );
 	if( gMusic == NULL )
@@ -374,8 +664,8 @@ bool loadMedia()
 		success = false;
 	}
 
-	//Load background texture
-	if( !gBGTexture.loadFromFile( "map.png" ) )
+	//Load background texture and its smaller levels
+	if( !gBGTexture.loadFromFile( "map.png", MINIMAP_WIDTH, MINIMAP_HEIGHT ) )
 	{
 		printf( "Failed to load background texture!\n" );
 		success = false;
@@ -427,6 +717,17 @@ void close()
 	gGMTexture.free();
 	gTimeTextTexture.free();
 	gPromptTextTexture.free();
+	gPhaseTextTexture.free();
+	gBoardTextTexture.free();
+	gFogTexture.free();
+
+	//Close the leaderboard and the run log
+	gLeaderboard.close();
+	if( gRunLog != NULL )
+	{
+		fclose( gRunLog );
+		gRunLog = NULL;
+	}
 
 	//Free the sound effects
 	Mix_FreeChunk( gScratch );
@@ -500,6 +801,92 @@ bool checkCollision( SDL_Rect a, SDL_Rect& b )
     return true;
 }
 
+SDL_Surface* shrinkSurface( SDL_Surface* source, int width, int height )
+{
+	//The shrunk surface
+	SDL_Surface* shrunk = SDL_CreateRGBSurfaceWithFormat( 0, width, height, 32, source->format->format );
+	if( shrunk == NULL )
+	{
+		printf( "Unable to create %dx%d surface! SDL Error: %s\n", width, height, SDL_GetError() );
+		return NULL;
+	}
+
+	SDL_LockSurface( source );
+	SDL_LockSurface( shrunk );
+	for( int y = 0; y < height; ++y )
+	{
+		//Source rows covered by this row
+		int top = y * source->h / height;
+		int bottom = ( y + 1 ) * source->h / height;
+		if( bottom <= top )
+		{
+			bottom = top + 1;
+		}
+
+		Uint32* out = (Uint32*)( (Uint8*)shrunk->pixels + y * shrunk->pitch );
+		for( int x = 0; x < width; ++x )
+		{
+			//Source columns covered by this pixel
+			int left = x * source->w / width;
+			int right = ( x + 1 ) * source->w / width;
+			if( right <= left )
+			{
+				right = left + 1;
+			}
+
+			//Average every channel over the covered block
+			Uint32 sum[ 4 ] = { 0, 0, 0, 0 };
+			for( int sy = top; sy < bottom; ++sy )
+			{
+				Uint32* row = (Uint32*)( (Uint8*)source->pixels + sy * source->pitch );
+				for( int sx = left; sx < right; ++sx )
+				{
+					Uint32 pixel = row[ sx ];
+					sum[ 0 ] += pixel & 0xFF;
+					sum[ 1 ] += ( pixel >> 8 ) & 0xFF;
+					sum[ 2 ] += ( pixel >> 16 ) & 0xFF;
+					sum[ 3 ] += pixel >> 24;
+				}
+			}
+			Uint32 count = ( bottom - top ) * ( right - left );
+			out[ x ] = ( sum[ 0 ] / count ) | ( ( sum[ 1 ] / count ) << 8 ) | ( ( sum[ 2 ] / count ) << 16 ) | ( ( sum[ 3 ] / count ) << 24 );
+		}
+	}
+	SDL_UnlockSurface( shrunk );
+	SDL_UnlockSurface( source );
+
+	return shrunk;
+}
+
+void updateCamera( SDL_Rect& camera, double zoom, int centerX, int centerY )
+{
+	//Size the view for the zoom factor
+	camera.w = (int)( SCREEN_WIDTH * zoom );
+	camera.h = (int)( SCREEN_HEIGHT * zoom );
+
+	//Center the camera over the point
+	camera.x = centerX - camera.w / 2;
+	camera.y = centerY - camera.h / 2;
+
+	//Keep the camera in bounds
+	if( camera.x < 0 )
+	{ 
+		camera.x = 0;
+	}
+	if( camera.y < 0 )
+	{
+		camera.y = 0;
+	}
+	if( camera.x > LEVEL_WIDTH - camera.w )
+	{
+		camera.x = LEVEL_WIDTH - camera.w;
+	}
+	if( camera.y > LEVEL_HEIGHT - camera.h )
+	{
+		camera.y = LEVEL_HEIGHT - camera.h;
+	}
+}
+
 int main( int argc, char* args[] )
 {
 	//Start up SDL and create window
@@ -516,6 +903,18 @@ int main( int argc, char* args[] )
 		}
 		else
 		{	
+			//Name runs are ranked under and the board they go on
+			std::string playerName = argc > 1 ? args[ 1 ] : "player";
+			//Chasers let loose each round
+			int chaserCount = argc > 2 ? atoi( args[ 2 ] ) : CHASER_COUNT;
+			if( chaserCount < 0 )
+			{
+				printf( "Usage: %s [name] [chasers], the chaser count cannot be negative, playing without chasers.\n", args[ 0 ] );
+				chaserCount = 0;
+			}
+			gLeaderboard.open( leaderboardPath( "campus" ) );
+			gRunLog = openRunLog( runLogPath( "campus" ) );
+
 			//Main loop flag
 			bool quit = false;
 
@@ -528,621 +927,56 @@ int main( int argc, char* args[] )
 			//Set text color as black
 			SDL_Color textColor = { 255, 255, 255, 255 };
 
-			//Current time start time
-			Uint32 startTime = 0;
+			//Live time cut into fixed ticks, headless runs can hand in a TickClock instead
+			PerformanceClock clock;
+			FixedStep step( clock, TICKS_PER_SECOND, MAX_CATCH_UP_TICKS );
+			step.reset();
 
 			//In memory text stream
 			std::stringstream timeText;
 
-			//Set the wall
-			SDL_Rect wall2;
-			wall2.x = 992;
-			wall2.y = 64;
-			wall2.w = 608;
-			wall2.h = 3648;
-
-			SDL_Rect wall1;
-			wall1.x = 1248;
-			wall1.y = 3712;
-			wall1.w = 352;
-			wall1.h = 512;
-
-			SDL_Rect wall3;
-			wall3.x = 832;
-			wall3.y = 3712;
-			wall3.w = 288;
-			wall3.h = 512;
-
-			SDL_Rect wall4;
-			wall4.x = 416;
-			wall4.y = 3456;
-			wall4.w = 704;
-			wall4.h = 640;
-
-			SDL_Rect wall5;
-			wall5.x = 416;
-			wall5.y = 4096;
-			wall5.w = 288;
-			wall5.h = 256;
-
-			SDL_Rect wall6;
-			wall6.x = 64;
-			wall6.y = 4256;
-			wall6.w = 640;
-			wall6.h = 96;
-
-			SDL_Rect wall7;
-			wall7.x = 64;
-			wall7.y = 4352;
-			wall7.w = 768;
-			wall7.h = 672;
-
-			SDL_Rect wall8;
-			wall8.x = 960;
-			wall8.y = 4352;
-			wall8.w = 640;
-			wall8.h = 672;
-
-			SDL_Rect wall9;
-			wall9.x = 64;
-			wall9.y = 5152;
-			wall9.w = 576;
-			wall9.h = 1184;
-
-			SDL_Rect wall10;
-			wall10.x = 640;
-			wall10.y = 5408;
-			wall10.w = 128;
-			wall10.h = 928;
-
-			SDL_Rect wall11;
-			wall11.x = 768;
-			wall11.y = 5152;
-			wall11.w = 512;
-			wall11.h = 1184;
-
-			SDL_Rect wall12;
-			wall12.x = 1280;
-			wall12.y = 5152;
-			wall12.w = 320;
-			wall12.h = 224;
-
-			SDL_Rect wall13;
-			wall13.x = 1280;
-			wall13.y = 5504;
-			wall13.w = 320;
-			wall13.h = 832;
-
-			SDL_Rect wall14;
-			wall14.x = 1728;
-			wall14.y = 64;
-			wall14.w = 1600;
-			wall14.h = 448;
-
-			SDL_Rect wall15;
-			wall15.x = 2688;
-			wall15.y = 512;
-			wall15.w = 640;
-			wall15.h = 224;
-
-			SDL_Rect wall16;
-			wall16.x = 3328;
-			wall16.y = 64;
-			wall16.w = 2560;
-			wall16.h = 416;
-
-			SDL_Rect wall17;
-			wall17.x = 3456;
-			wall17.y = 608;
-			wall17.w = 128;
-			wall17.h = 1436;
-
-			SDL_Rect wall18;
-			wall18.x = 3584;
-			wall18.y = 736;
-			wall18.w = 128;
-			wall18.h = 1312;
-
-			SDL_Rect wall19;
-			wall19.x = 3712;
-			wall19.y = 480;
-			wall19.w = 2176;
-			wall19.h = 1568;
-
-			SDL_Rect wall20;
-			wall20.x = 5888;
-			wall20.y = 1664;
-			wall20.w = 512;
-			wall20.h = 384;
-
-			SDL_Rect wall21;
-			wall21.x = 1728;
-			wall21.y = 640;
-			wall21.w = 832;
-			wall21.h = 1408;
-
-			SDL_Rect wall22;
-			wall22.x = 2688;
-			wall22.y = 864;
-			wall22.w = 640;
-			wall22.h = 1184;
-
-			SDL_Rect wall23;
-			wall23.x = 1728;
-			wall23.y = 2176;
-			wall23.w = 832;
-			wall23.h = 640;
-
-			SDL_Rect wall24;
-			wall24.x = 2688;
-			wall24.y = 2176;
-			wall24.w = 640;
-			wall24.h = 640;
-
-			SDL_Rect wall25;
-			wall25.x = 1728;
-			wall25.y = 2944;
-			wall25.w = 320;
-			wall25.h = 1536;
-
-			SDL_Rect wall26;
-			wall26.x = 2048;
-			wall26.y = 3008;
-			wall26.w = 128;
-			wall26.h = 1472;
-
-			SDL_Rect wall27;
-			wall27.x = 2176;
-			wall27.y = 2944;
-			wall27.w = 512;
-			wall27.h = 1536;
-
-			SDL_Rect wall28;
-			wall28.x = 2688;
-			wall28.y = 3072;
-			wall28.w = 128;
-			wall28.h = 1408;
-
-			SDL_Rect wall29;
-			wall29.x = 2816;
-			wall29.y = 2816;
-			wall29.w = 512;
-			wall29.h = 1184;
-
-			SDL_Rect wall30;
-			wall30.x = 2816;
-			wall30.y = 4000;
-			wall30.w = 256;
-			wall30.h = 480;
-
-			SDL_Rect wall31;
-			wall31.x = 1728;
-			wall31.y = 4608;
-			wall31.w = 1088;
-			wall31.h = 416;
-
-			SDL_Rect wall32;
-			wall32.x = 1728;
-			wall32.y = 5152;
-			wall32.w = 768;
-			wall32.h = 1056;
-
-			SDL_Rect wall33;
-			wall33.x = 2496;
-			wall33.y = 5152;
-			wall33.w = 448;
-			wall33.h = 1184;
-
-			SDL_Rect wall34;
-			wall34.x = 2944;
-			wall34.y = 4608;
-			wall34.w = 256;
-			wall34.h = 1728;
-
-			SDL_Rect wall35;
-			wall35.x = 3200;
-			wall35.y = 4128;
-			wall35.w = 9536;
-			wall35.h = 2208;
-
-			SDL_Rect wall36;
-			wall36.x = 1600;
-			wall36.y = 6336;
-			wall36.w = 768;
-			wall36.h = 16;
-
-			SDL_Rect wall37;
-			wall37.x = 3456;
-			wall37.y = 2176;
-			wall37.w = 3328;
-			wall37.h = 1824;
-
-			SDL_Rect wall38;
-			wall38.x = 6784;
-			wall38.y = 2431;
-			wall38.w = 256;
-			wall38.h = 1568;
-
-			SDL_Rect wall39;
-			wall39.x = 7040;
-			wall39.y = 2944;
-			wall39.w = 128;
-			wall39.h = 1056;
-
-			SDL_Rect wall40;
-			wall40.x = 6784;
-			wall40.y = 1792;
-			wall40.w = 128;
-			wall40.h = 256;
-
-			SDL_Rect wall41;
-			wall41.x = 6912;
-			wall41.y = 1792;
-			wall41.w = 256;
-			wall41.h = 512;
-
-			SDL_Rect wall42;
-			wall42.x = 7168;
-			wall42.y = 1792;
-			wall42.w = 768;
-			wall42.h = 2208;
-
-			SDL_Rect wall43;
-			wall43.x = 7936;
-			wall43.y = 2304;
-			wall43.w = 128;
-			wall43.h = 1696;
-
-			SDL_Rect wall44;
-			wall44.x = 8064;
-			wall44.y = 2240;
-			wall44.w = 128;
-			wall44.h = 1760;
-
-			SDL_Rect wall45;
-			wall45.x = 8064;
-			wall45.y = 1792;
-			wall45.w = 128;
-			wall45.h = 320;
-
-			SDL_Rect wall46;
-			wall46.x = 8192;
-			wall46.y = 1792;
-			wall46.w = 480;
-			wall46.h = 2208;
-
-			SDL_Rect wall47;
-			wall47.x = 8672;
-			wall47.y = 1280;
-			wall47.w = 1760;
-			wall47.h = 2720;
-
-			SDL_Rect wall48;
-			wall48.x = 10432;
-			wall48.y = 1280;
-			wall48.w = 608;
-			wall48.h = 1792;
-
-			SDL_Rect wall49;
-			wall49.x = 6016;
-			wall49.y = 256;
-			wall49.w = 512;
-			wall49.h = 1280;
-
-			SDL_Rect wall50;
-			wall50.x = 6528;
-			wall50.y = 256;
-			wall50.w = 128;
-			wall50.h = 1792;
-
-			SDL_Rect wall51;
-			wall51.x = 6656;
-			wall51.y = 256;
-			wall51.w = 1888;
-			wall51.h = 896;
-
-			SDL_Rect wall52;
-			wall52.x = 8544;
-			wall52.y = 256;
-			wall52.w = 960;
-			wall52.h = 256;
-
-			SDL_Rect wall53;
-			wall53.x = 5888;
-			wall53.y = 64;
-			wall53.w = 3744;
-			wall53.h = 64;
-
-			SDL_Rect wall54;
-			wall54.x = 6784;
-			wall54.y = 1280;
-			wall54.w = 832;
-			wall54.h = 384;
-
-			SDL_Rect wall55;
-			wall55.x = 7744;
-			wall55.y = 1280;
-			wall55.w = 800;
-			wall55.h = 384;
-
-			SDL_Rect wall56;
-			wall56.x = 9632;
-			wall56.y = 64;
-			wall56.w = 320;
-			wall56.h = 448;
-
-			SDL_Rect wall57;
-			wall57.x = 8672;
-			wall57.y = 640;
-			wall57.w = 1408;
-			wall57.h = 512;
-
-			SDL_Rect wall58;
-			wall58.x = 10080;
-			wall58.y = 192;
-			wall58.w = 512;
-			wall58.h = 960;
-
-			SDL_Rect wall59;
-			wall59.x = 10592;
-			wall59.y = 64;
-			wall59.w = 448;
-			wall59.h = 1088;
-
-			SDL_Rect wall60;
-			wall60.x = 11040;
-			wall60.y = 64;
-			wall60.w = 128;
-			wall60.h = 320;
-
-			SDL_Rect wall61;
-			wall61.x = 9952;
-			wall61.y = 48;
-			wall61.w = 512;
-			wall61.h = 16;
-
-			SDL_Rect wall62;
-			wall62.x = 11168;
-			wall62.y = 64;
-			wall62.w = 352;
-			wall62.h = 1088;
-
-			SDL_Rect wall63;
-			wall63.x = 11520;
-			wall63.y = 64;
-			wall63.w = 640;
-			wall63.h = 320;
-
-			SDL_Rect wall64;
-			wall64.x = 11648;
-			wall64.y = 512;
-			wall64.w = 512;
-			wall64.h = 640;
-
-			SDL_Rect wall65;
-			wall65.x = 12288;
-			wall65.y = 64;
-			wall65.w = 448;
-			wall65.h = 1088;
-
-			SDL_Rect wall66;
-			wall66.x = 11168;
-			wall66.y = 1280;
-			wall66.w = 352;
-			wall66.h = 832;
-
-			SDL_Rect wall67;
-			wall67.x = 11648;
-			wall67.y = 1280;
-			wall67.w = 512;
-			wall67.h = 832;
-
-			SDL_Rect wall68;
-			wall68.x = 11168;
-			wall68.y = 2240;
-			wall68.w = 992;
-			wall68.h = 320;
-
-			SDL_Rect wall69;
-			wall69.x = 12288;
-			wall69.y = 1280;
-			wall69.w = 448;
-			wall69.h = 2720;
-
-			SDL_Rect wall70;
-			wall70.x = 10560;
-			wall70.y = 3200;
-			wall70.w = 608;
-			wall70.h = 800;
-
-			SDL_Rect wall71;
-			wall71.x = 11168;
-			wall71.y = 2688;
-			wall71.w = 992;
-			wall71.h = 1312;
-
-			SDL_Rect wall72;
-			wall72.x = 416;
-			wall72.y = 64;
-			wall72.w = 576;
-			wall72.h = 3424;
-
-			SDL_Rect wall73;
-			wall73.x = 64;
-			wall73.y = 64;
-			wall73.w = 352;
-			wall73.h = 4192;
-
-			SDL_Rect wall74;
-			wall74.x = 704;
-			wall74.y = 4320;
-			wall74.w = 32;
-			wall74.h = 32;
-
-			SDL_Rect wall75;
-			wall75.x = 1600;
-			wall75.y = 6272;
-			wall75.w = 32;
-			wall75.h = 32;
-
-			SDL_Rect wall76;
-			wall76.x = 2656;
-			wall76.y = 512;
-			wall76.w = 32;
-			wall76.h = 32;
-
-			SDL_Rect wall77;
-			wall77.x = 3328;
-			wall77.y = 480;
-			wall77.w = 32;
-			wall77.h = 32;
-
-			SDL_Rect wall78;
-			wall78.x = 3680;
-			wall78.y = 480;
-			wall78.w = 32;
-			wall78.h = 32;
-
-			SDL_Rect wall79;
-			wall79.x = 5888;
-			wall79.y = 1632;
-			wall79.w = 32;
-			wall79.h = 32;
-
-			SDL_Rect wall80;
-			wall80.x = 2784;
-			wall80.y = 2816;
-			wall80.w = 32;
-			wall80.h = 32;
-
-			SDL_Rect wall81;
-			wall81.x = 3072;
-			wall81.y = 4000;
-			wall81.w = 32;
-			wall81.h = 32;
-
-			SDL_Rect wall82;
-			wall82.x = 2464;
-			wall82.y = 6208;
-			wall82.w = 32;
-			wall82.h = 32;
-
-			SDL_Rect wall83;
-			wall83.x = 2912;
-			wall83.y = 5120;
-			wall83.w = 32;
-			wall83.h = 32;
-
-			SDL_Rect wall84;
-			wall84.x = 3168;
-			wall84.y = 4576;
-			wall84.w = 32;
-			wall84.h = 32;
-
-			SDL_Rect wall85;
-			wall85.x = 6784;
-			wall85.y = 2400;
-			wall85.w = 32;
-			wall85.h = 32;
-
-			SDL_Rect wall86;
-			wall86.x = 6880;
-			wall86.y = 2048;
-			wall86.w = 32;
-			wall86.h = 32;
-
-			SDL_Rect wall87;
-			wall87.x = 7136;
-			wall87.y = 2304;
-			wall87.w = 32;
-			wall87.h = 32;
-
-			SDL_Rect wall88;
-			wall88.x = 8640;
-			wall88.y = 1760;
-			wall88.w = 32;
-			wall88.h = 32;
-
-			SDL_Rect wall89;
-			wall89.x = 10432;
-			wall89.y = 3072;
-			wall89.w = 32;
-			wall89.h = 32;
-
-			SDL_Rect wall90;
-			wall90.x = 6496;
-			wall90.y = 1536;
-			wall90.w = 32;
-			wall90.h = 32;
-
-			SDL_Rect wall91;
-			wall91.x = 6656;
-			wall91.y = 1152;
-			wall91.w = 32;
-			wall91.h = 32;
-
-			SDL_Rect wall92;
-			wall92.x = 8544;
-			wall92.y = 512;
-			wall92.w = 32;
-			wall92.h = 32;
-
-			SDL_Rect wall93;
-			wall93.x = 9600;
-			wall93.y = 128;
-			wall93.w = 32;
-			wall93.h = 32;
-
-			SDL_Rect wall94;
-			wall94.x = 5888;
-			wall94.y = 128;
-			wall94.w = 32;
-			wall94.h = 32;
-
-			SDL_Rect wall95;
-			wall95.x = 9952;
-			wall95.y = 64;
-			wall95.w = 32;
-			wall95.h = 32;
-
-			SDL_Rect wall96;
-			wall96.x = 10048;
-			wall96.y = 608;
-			wall96.w = 32;
-			wall96.h = 32;
-
-			SDL_Rect wall97;
-			wall97.x = 10560;
-			wall97.y = 160;
-			wall97.w = 32;
-			wall97.h = 32;
-
-			SDL_Rect wall98;
-			wall98.x = 11520;
-			wall98.y = 384;
-			wall98.w = 32;
-			wall98.h = 32;
-
-			SDL_Rect wall99;
-			wall99.x = 11136;
-			wall99.y = 3168;
-			wall99.w = 32;
-			wall99.h = 32;
-
-
-			SDL_Rect wall[] = {wall1, wall2, wall3, wall4, wall5, wall6, wall7, wall8, wall9, wall10, wall11, wall12, wall13, wall14, wall15, wall16, wall17, wall18, wall19, wall20, wall21, wall22, wall23, wall24, wall25, wall26, wall27, wall28, wall29, wall30, wall31, wall32, wall33, wall34, wall35, wall36, wall37, wall38, wall39, wall40, wall41, wall42, wall43, wall44, wall45, wall46, wall47, wall48, wall49, wall50, 
-				wall51, wall52, wall53, wall54, wall55, wall56, wall57, wall58, wall59, wall60, wall61, wall62, wall63, wall64, wall65, wall66, wall67, wall68, wall69, wall70, wall71, wall72, wall73, wall74, wall75, wall76, wall77, wall78, wall79, wall80, wall81, wall82, wall83, wall84, wall85, wall86, wall87, wall88, wall89, wall90, wall91, wall92, wall93, wall94, wall95, wall96, wall97, wall98, wall99};
 
 			//The camera area
 			SDL_Rect camera = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
 
-			int e1 = 0;
-			int score = 300;
-			int energy = 0;
+			//Level pixels shown per screen pixel
+			double zoom = MIN_ZOOM;
+
+			//Whether the minimap is drawn
+			bool showMinimap = true;
+
+			//Whether only what the dot can see is shown
+			bool showFog = false;
+
+			//The round being played
+			Match match;
+			resetMatch( match );
+
+			//In memory text stream for the phase banner
+			std::stringstream phaseText;
+
+			//Chasers inside the camera this frame
+			std::vector<SDL_Rect> chaserQuads;
+
+			//What the player asked of the round, held until a tick takes it
+			MatchEvent matchEvent = MATCH_NONE;
+
+			//Whether the round runs backwards
+			bool rewinding = false;
+
+			//Whether the round was ever rewound, such a round is only practice and is neither ranked nor logged
+			bool rewound = false;
+
+			//Keys held on each tick of the round
+			RunLog runLog;
+			runLog.buttons.reserve( RUN_MAX_TICKS );
 
 			//While application is running
 			while( !quit )
 			{
+				//Score and energy of the round
+				PlayerStats& stats = dot.getStats();
+
 				//Handle events on queue
 				while( SDL_PollEvent( &e ) != 0 )
 				{
@@ -1151,133 +985,206 @@ int main( int argc, char* args[] )
 					{
 						quit = true;
 					}
-					// //Reset start time on return keypress
-					// else if( e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_RETURN )
-					// {
-					// 	startTime = SDL_GetTicks();
-					// }
 					else{
 						Mix_PlayMusic( gMusic, -1 );
 					}
 
+					//Zoom the camera, toggle the minimap and start rounds
+					if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
+					{
+						switch( e.key.keysym.sym )
+						{
+							case SDLK_EQUALS: zoom /= 1.25; break;
+							case SDLK_MINUS: zoom *= 1.25; break;
+							case SDLK_m: showMinimap = !showMinimap; break;
+							case SDLK_f: showFog = !showFog; break;
+							case SDLK_RETURN: matchEvent = MATCH_START; break;
+							case SDLK_BACKSPACE: rewinding = true; break;
+						}
+						if( zoom < MIN_ZOOM )
+						{
+							zoom = MIN_ZOOM;
+						}
+						if( zoom > MAX_ZOOM )
+						{
+							zoom = MAX_ZOOM;
+						}
+					}
+
+					//Rewind only while backspace is held
+					if( e.type == SDL_KEYUP && e.key.keysym.sym == SDLK_BACKSPACE )
+					{
+						rewinding = false;
+					}
+
 					//Handle input for the dot
 					dot.handleEvent( e );
 				}
 
-				//Move the dot
-				dot.move( wall );
+				//Simulate every tick the clock says is due, the rules only ever see the tick count
+				int ticks = step.advance();
+				for( int tick = 0; tick < ticks; ++tick )
+				{
+					//Step the round back a tick instead, as far back as the rings go
+					if( match.phase == PHASE_PLAYING && rewinding )
+					{
+						GameState state;
+						int back = match.phaseTicks - 1;
+						if( gSwarmRewind.has( back ) && gRewind.restore( back, &state ) )
+						{
+							match = state.match;
+							dot.getTransform() = state.dot;
+							stats = state.stats;
+							gSwarm.restoreState( gSwarmRewind.find( back ) );
+							rewound = true;
+						}
+						matchEvent = MATCH_NONE;
+						continue;
+					}
 
-				//Center the camera over the dot
-				camera.x = ( dot.getPosX() + Dot::DOT_WIDTH / 2 ) - SCREEN_WIDTH / 2;
-				camera.y = ( dot.getPosY() + Dot::DOT_HEIGHT / 2 ) - SCREEN_HEIGHT / 2;
+					//Save the tick before it is played so it can be rewound to
+					if( match.phase == PHASE_PLAYING )
+					{
+						GameState state = { match, dot.getTransform(), stats };
+						gRewind.save( match.phaseTicks, &state );
+						gSwarm.saveState( gSwarmRewind.claim( match.phaseTicks ) );
+					}
 
-				//Keep the camera in bounds
-				if( camera.x < 0 )
-				{ 
-					camera.x = 0;
-				}
-				if( camera.y < 0 )
-				{
-					camera.y = 0;
-				}
-				if( camera.x > LEVEL_WIDTH - camera.w )
-				{
-					camera.x = LEVEL_WIDTH - camera.w;
-				}
-				if( camera.y > LEVEL_HEIGHT - camera.h )
-				{
-					camera.y = LEVEL_HEIGHT - camera.h;
+					//Move the dot while the round is on and send the chasers that see it after it
+					if( match.phase == PHASE_PLAYING )
+					{
+						runLog.buttons.resize( match.phaseTicks + 1 );
+						runLog.buttons[ match.phaseTicks ] = velocityButtons( dot.getVelX(), dot.getVelY() );
+						moveEntities( gEntities, gWalls, LEVEL_WIDTH, LEVEL_HEIGHT );
+
+						gSwarm.look( gWalls, dot.getPosX() + Dot::DOT_WIDTH / 2, dot.getPosY() + Dot::DOT_HEIGHT / 2, CHASER_SIGHT );
+						gSwarm.chase( gField, dot.getPosX() + Dot::DOT_WIDTH / 2, dot.getPosY() + Dot::DOT_HEIGHT / 2 );
+					}
+
+					//Time into the round as the ticks count it
+					unsigned int elapsedMs = match.phaseTicks * 1000 / TICKS_PER_SECOND;
+
+					int dX = dot.getPosX();
+					int dY = dot.getPosY();
+					int vX = dot.getVelX();
+					int vY = dot.getVelY();
+
+					//Apply the zones and end the round once the dot reached the goal or ran out
+					if( match.phase == PHASE_PLAYING )
+					{
+						int zones = applyZones( stats, dX, dY, vX, vY, elapsedMs );
+						if( zones & ZONE_ENERGY )
+						{
+							Mix_PlayChannel( -1, gHigh, 0 );
+						}
+						if( zones & ZONE_SCORE )
+						{
+							Mix_PlayChannel( -1, gMedium, 0 );
+						}
+
+						Outcome outcome = checkOutcome( stats, dX, dY );
+						if( outcome == OUTCOME_WON )
+						{
+							matchEvent = MATCH_WIN;
+						}
+						else if( outcome == OUTCOME_LOST )
+						{
+							matchEvent = MATCH_LOSE;
+						}
+						else if( gSwarm.touching( dX, dY, Dot::DOT_WIDTH, Dot::DOT_HEIGHT ) > 0 )
+						{
+							//Caught
+							stats.outcome = OUTCOME_LOST;
+							matchEvent = MATCH_LOSE;
+						}
+					}
+
+					//Advance the round
+					if( updateMatch( match, matchEvent ) )
+					{
+						switch( match.phase )
+						{
+							case PHASE_COUNTDOWN:
+							dot.respawn();
+							resetStats( stats );
+							gFog.reset();
+
+							//Scatter the chasers well away from the start, each round its own way, and note how so the run can be played again
+							startChasers( gSpawns, gSwarm, chaserCount, match.round );
+							runLog.round = match.round;
+							runLog.chasers = chaserCount;
+
+							//Nothing before the round can be rewound to
+							gRewind.clear();
+							gSwarmRewind.create( gSwarm.getStateSize(), REWIND_TICKS );
+							rewound = false;
+							break;
+
+							case PHASE_WON:
+							{
+								Mix_PlayChannel( -1, gScratch, 0 );
+
+								//A rewound round could undo every mistake, so it is not ranked
+								if( rewound )
+								{
+									if( !gBoardTextTexture.loadFromRenderedText( "Practice run, rewound rounds are not ranked", textColor ) )
+									{
+										gBoardTextTexture.free();
+									}
+									break;
+								}
+
+								//Rank the run and show the players around it
+								ScoreEntry run = { playerName, stats.score, stats.energy, elapsedMs };
+								int rank = gLeaderboard.submit( run );
+
+								//Keep the keys that won it so the score can be checked away from this machine
+								runLog.claim = run;
+								if( gRunLog != NULL && runLog.buttons.size() <= (size_t)RUN_MAX_TICKS )
+								{
+									appendRun( gRunLog, runLog );
+								}
+								ScoreEntry around[ 5 ];
+								int first = rank - 2 < 0 ? 0 : rank - 2;
+								int count = gLeaderboard.range( first, 5, around );
+
+								std::stringstream boardText;
+								for( int i = 0; i < count; ++i )
+								{
+									boardText << ( i > 0 ? "   " : "" ) << "#" << first + i + 1 << " " << around[ i ].player << " " << around[ i ].score;
+								}
+								if( count == 0 || !gBoardTextTexture.loadFromRenderedText( boardText.str().c_str(), textColor ) )
+								{
+									gBoardTextTexture.free();
+								}
+								break;
+							}
+
+							case PHASE_LOST:
+							Mix_PlayChannel( -1, gScratch, 0 );
+							gBoardTextTexture.free();
+							break;
+
+							default:
+							break;
+						}
+					}
+
+					//A key acts on one tick only
+					matchEvent = MATCH_NONE;
 				}
 
+				//Light what the dot sees from its cell and upload whatever changed
+				gFog.update( ( dot.getPosX() + Dot::DOT_WIDTH / 2 ) / COLLISION_CELL, ( dot.getPosY() + Dot::DOT_HEIGHT / 2 ) / COLLISION_CELL );
+				gFogTexture.update( gFog );
+
+				//Center the camera over the dot
+				updateCamera( camera, zoom, dot.getPosX() + Dot::DOT_WIDTH / 2, dot.getPosY() + Dot::DOT_HEIGHT / 2 );
+
 				//Set text to be rendered
-				int dX = dot.getPosX();
-				int dY = dot.getPosY();
-				int vX = dot.getVelX();
-				int vY = dot.getVelY();
-				if(dX > 7840 && dY > 1152 && dX < 7872 && dY < 1216 && (vX>5 || vX<-5)){
-					e1+=20;
-					score-=50;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 7104 && dY > 2848 && dX < 7168 && dY < 2912 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 11040 && dY > 576 && dX < 11104 && dY < 608 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 10528 && dY > 3072 && dX < 10560 && dY < 3136 && (vX>5 || vX<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 3392 && dY > 2720 && dX < 3456 && dY < 2752 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 1664 && dY > 512 && dX < 1728 && dY < 544 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 1120 && dY > 3776 && dX < 1184 && dY < 3808 && (vY>5 || vY<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 1344 && dY > 5440 && dX < 1376 && dY < 5504 && (vX>5 || vX<-5)){
-					e1+=20;
-					score-=30;
-					Mix_PlayChannel( -1, gHigh, 0 );
-				}
-				if(dX > 8096 && dY > 2176 && dX < 8128 && dY < 2240 && (vX>5 || vX<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 6464 && dY > 1664 && dX < 6528 && dY < 1696 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 12160 && dY > 1536 && dX < 12224 && dY < 1568 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 3456 && dY > 4000 && dX < 3488 && dY < 4064 && (vX>5 || vX<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 640 && dY > 5312 && dX < 704 && dY < 5344 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 2688 && dY > 2976 && dX < 2752 && dY < 3008 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 3584 && dY > 640 && dX < 3648 && dY < 672 && (vY>5 || vY<-5)){
-					score+=50;
-					Mix_PlayChannel( -1, gMedium, 0 );
-				}
-				if(dX > 9024 && dY > 1152 && dX < 9344 && dY < 1216){}
-				else if(dX > 11104 && dY > 288 && dX < 11168 && dY < 608){}
-				else if(dX > 12480 && dY > 1152 && dX < 12800 && dY < 1216){}
-				else if(dX > 11424 && dY > 2176 && dX < 11744 && dY < 2240){}
-				else if(dX > 12512 && dY > 4000 && dX < 12832 && dY < 4064){}
-				else if(dX > 6368 && dY > 4064 && dX < 6688 && dY < 4128){}
-				else if(dX > 5952 && dY > 704 && dX < 6016 && dY < 1024){}
-				else if(dX > 7936 && dY > 2080 && dX < 8000 && dY < 2400){}
-				else if(dX > 2976 && dY > 2112 && dX < 3296 && dY < 2176){}
-				else if(dX > 768 && dY > 4000 && dX < 832 && dY < 4320){}
-				else{
-					energy = 300 - 0.01*(SDL_GetTicks() - startTime) + e1;
-				}
 				timeText.str( "" );
-				timeText << "Current score : " << score ;
-				timeText << " | Energy left : " << energy ;
+				timeText << "Current score : " << stats.score ;
+				timeText << " | Energy left : " << stats.energy ;
 				
 				//Render text
 				if( !gTimeTextTexture.loadFromRenderedText( timeText.str().c_str(), textColor ) )
@@ -1285,39 +1192,105 @@ int main( int argc, char* args[] )
 					printf( "Unable to render time texture!\n" );
 				}
 
+				//Set the banner of the phase
+				phaseText.str( "" );
+				switch( match.phase )
+				{
+					case PHASE_MENU:
+					phaseText << "Press Enter to start";
+					break;
+
+					case PHASE_COUNTDOWN:
+					phaseText << countdownSeconds( match );
+					break;
+
+					case PHASE_RESULTS:
+					phaseText << "Round " << match.round << ( stats.outcome == OUTCOME_WON ? " won" : " lost" );
+					phaseText << " with score " << stats.score << " | Press Enter to play again";
+					break;
+
+					default:
+					break;
+				}
+				if( phaseText.str().size() > 0 && !gPhaseTextTexture.loadFromRenderedText( phaseText.str().c_str(), textColor ) )
+				{
+					printf( "Unable to render phase texture!\n" );
+				}
+
 				//Clear screen
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 				SDL_RenderClear( gRenderer );
 
-				//Render background
-				gBGTexture.render( 0, 0, &camera );
+				//Render background from the level matching the zoom
+				gBGTexture.render( camera );
 
 				//Render objects
-				dot.render( camera.x, camera.y );
+				renderEntities( gEntities, camera, zoom );
+
+				//Render the chasers in view in one batch
+				chaserQuads.clear();
+				int chaserSize = gSwarm.getSize();
+				for( int i = 0; i < gSwarm.getCount(); ++i )
+				{
+					int cX = gSwarm.getPosX( i );
+					int cY = gSwarm.getPosY( i );
+					bool hidden = showFog && gFog.getState( ( cX + chaserSize / 2 ) / COLLISION_CELL, ( cY + chaserSize / 2 ) / COLLISION_CELL ) != FOG_VISIBLE;
+					if( !hidden && cX + chaserSize > camera.x && cX < camera.x + camera.w && cY + chaserSize > camera.y && cY < camera.y + camera.h )
+					{
+						SDL_Rect quad = { (int)( ( cX - camera.x ) / zoom ), (int)( ( cY - camera.y ) / zoom ), (int)( chaserSize / zoom ) + 1, (int)( chaserSize / zoom ) + 1 };
+						chaserQuads.push_back( quad );
+					}
+				}
+				if( !chaserQuads.empty() )
+				{
+					SDL_SetRenderDrawColor( gRenderer, 0xC0, 0x00, 0x00, 0xFF );
+					SDL_RenderFillRects( gRenderer, &chaserQuads[ 0 ], chaserQuads.size() );
+				}
+
+				//Cover what the dot cannot see
+				if( showFog )
+				{
+					gFogTexture.render( camera, zoom, COLLISION_CELL );
+				}
+
+				//Render minimap with the camera view and the dot marked on it
+				if( showMinimap )
+				{
+					int mapX = SCREEN_WIDTH - MINIMAP_WIDTH - 8;
+					int mapY = SCREEN_HEIGHT - MINIMAP_HEIGHT - 8;
+					gBGTexture.renderMinimap( mapX, mapY );
+
+					SDL_Rect view = { mapX + camera.x * MINIMAP_WIDTH / LEVEL_WIDTH, mapY + camera.y * MINIMAP_HEIGHT / LEVEL_HEIGHT, camera.w * MINIMAP_WIDTH / LEVEL_WIDTH, camera.h * MINIMAP_HEIGHT / LEVEL_HEIGHT };
+					SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+					SDL_RenderDrawRect( gRenderer, &view );
+
+					SDL_Rect marker = { mapX + dot.getPosX() * MINIMAP_WIDTH / LEVEL_WIDTH - 2, mapY + dot.getPosY() * MINIMAP_HEIGHT / LEVEL_HEIGHT - 2, 4, 4 };
+					SDL_SetRenderDrawColor( gRenderer, 0xFF, 0x00, 0x00, 0xFF );
+					SDL_RenderFillRect( gRenderer, &marker );
+				}
 
 				//Render textures
 				gPromptTextTexture.render( ( SCREEN_WIDTH - gPromptTextTexture.getWidth() ) / 2, 0 );
 				gTimeTextTexture.render( ( SCREEN_WIDTH - gTimeTextTexture.getWidth() ) / 2, 32 );
 
-				//Render congrats
-				if(dX>3328 && dY>2400 && dX<3360 && dY<2528 && score>0 && energy>0){
-					gCTexture.render( 320, 64);
-					Mix_PlayChannel( -1, gScratch, 0 );
-					if(e.type == SDL_KEYUP){
-						SDL_Delay(5000);
-						quit = true;
-					}
+				//Render congrats or game over while the banner is up
+				if( match.phase == PHASE_WON )
+				{
+					gCTexture.render( 320, 64 );
+				}
+				else if( match.phase == PHASE_LOST )
+				{
+					gGMTexture.render( 160, 64 );
+				}
+				else if( phaseText.str().size() > 0 )
+				{
+					gPhaseTextTexture.render( ( SCREEN_WIDTH - gPhaseTextTexture.getWidth() ) / 2, ( SCREEN_HEIGHT - gPhaseTextTexture.getHeight() ) / 2 );
 				}
 
-				//Render game over
-				if( score<0 || energy<=0 ){
-					gGMTexture.render( 160, 64);
-					Mix_PlayChannel( -1, gScratch, 0 );
-					if(e.type == SDL_KEYUP){
-						SDL_Delay(5000);
-						quit = true;
-					}
-					
+				//Render the leaderboard around the last winning run
+				if( match.phase == PHASE_RESULTS && gBoardTextTexture.getWidth() > 0 )
+				{
+					gBoardTextTexture.render( ( SCREEN_WIDTH - gBoardTextTexture.getWidth() ) / 2, ( SCREEN_HEIGHT + gPhaseTextTexture.getHeight() ) / 2 + 8 );
 				}
 
 				//Update screen
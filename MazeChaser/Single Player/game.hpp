@@ -4,8 +4,23 @@
 #include<SDL2/SDL_mixer.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string>
 #include <sstream>
+#include <vector>
+#include "clock.hpp"
+#include "collision_grid.hpp"
+#include "entity_store.hpp"
+#include "flow_field.hpp"
+#include "fog.hpp"
+#include "leaderboard.hpp"
+#include "level.hpp"
+#include "match.hpp"
+#include "performance_clock.hpp"
+#include "rules.hpp"
+#include "run_log.hpp"
+#include "state_ring.hpp"
+#include "swarm.hpp"
 
 //The dimensions of the level
 const int LEVEL_WIDTH = 12800;
@@ -15,6 +30,25 @@ const int LEVEL_HEIGHT = 6400;
 const int SCREEN_WIDTH = 1280;
 const int SCREEN_HEIGHT = 640;
 
+//Camera zoom limits, in level pixels per screen pixel
+const double MIN_ZOOM = 1.0;
+const double MAX_ZOOM = (double)LEVEL_WIDTH / SCREEN_WIDTH;
+
+//Minimap dimension constants
+const int MINIMAP_WIDTH = 256;
+const int MINIMAP_HEIGHT = 128;
+
+//Ticks of a round that can be rewound
+const int REWIND_TICKS = 5 * TICKS_PER_SECOND;
+
+//Everything a tick of the round changes apart from the chasers, plain data so one copy saves it
+struct GameState
+{
+    Match match;
+    Transform dot;
+    PlayerStats stats;
+};
+
 //Texture wrapper class
 class LTexture
 {
@@ -48,6 +82,9 @@ class LTexture
         //Renders texture at given point
         void render( int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE );
 
+        //Renders texture stretched over the given rectangle
+        void renderScaled( SDL_Rect* dest, SDL_Rect* clip = NULL );
+
         //Gets image dimensions
         int getWidth();
         int getHeight();
@@ -61,28 +98,106 @@ class LTexture
         int mHeight;
 };
 
+//Background texture with a precomputed chain of halved levels and a minimap
+class LTexturePyramid
+{
+    public:
+        //Maximum number of levels in the chain, including full size
+        static const int MAX_LEVELS = 8;
+
+        //Initializes variables
+        LTexturePyramid();
+
+        //Deallocates memory
+        ~LTexturePyramid();
+
+        //Loads image at specified path and builds every level and the minimap
+        bool loadFromFile( std::string path, int minimapWidth, int minimapHeight );
+
+        //Deallocates all levels
+        void free();
+
+        //Renders a region given in full size pixels, stretched over dest (or the whole screen)
+        void render( SDL_Rect& region, SDL_Rect* dest = NULL );
+
+        //Renders the whole image at minimap size
+        void renderMinimap( int x, int y );
+
+        //Gets full size image dimensions
+        int getWidth();
+        int getHeight();
+
+    private:
+        //The hardware textures, level 0 is full size and each next one is half as big
+        SDL_Texture* mLevels[ MAX_LEVELS ];
+        int mLevelCount;
+
+        //The whole image shrunk to minimap size
+        SDL_Texture* mMinimap;
+        int mMinimapWidth;
+        int mMinimapHeight;
+
+        //Full size image dimensions
+        int mWidth;
+        int mHeight;
+};
+
+//Fog of war with one texel per grid cell, only cells that changed are uploaded
+class LFogTexture
+{
+    public:
+        //Initializes variables
+        LFogTexture();
+
+        //Deallocates memory
+        ~LFogTexture();
+
+        //Creates a streaming texture as big as the fog's grid
+        bool create( FogOfWar& fog );
+
+        //Deallocates the texture
+        void free();
+
+        //Uploads the cells the fog changed since the last call
+        void update( FogOfWar& fog );
+
+        //Covers the camera's region of the level, each texel being cellSize level pixels
+        void render( SDL_Rect& camera, double zoom, int cellSize );
+
+    private:
+        //The hardware texture
+        SDL_Texture* mTexture;
+
+        //Texels of the changed cells on their way to the texture
+        std::vector<Uint32> mPixels;
+
+        //Texture dimensions in cells
+        int mWidth;
+        int mHeight;
+};
+
 //The dot that will move around on the screen
 class Dot
 {
     public:
-        //The dimensions of the dot
-        static const int DOT_WIDTH = 50;
-        static const int DOT_HEIGHT = 50;
+        //The dimensions of the dot, shared with the replays that check its runs
+        static const int DOT_WIDTH = RUN_DOT_SIZE;
+        static const int DOT_HEIGHT = RUN_DOT_SIZE;
 
         //Maximum axis velocity of the dot
-        static const int DOT_VEL = 15;
+        static const int DOT_VEL = RUN_DOT_VEL;
 
-        //Initializes the variables
+        //Adds the dot to the world as a player
         Dot();
 
+        //Takes the dot out of the world
+        ~Dot();
+
         //Takes key presses and adjusts the dot's velocity
         void handleEvent( SDL_Event& e );
 
-        //Moves the dot
-        void move( SDL_Rect wall[] );
-
-        //Shows the dot on the screen relative to the camera
-        void render( int camX, int camY );
+        //Puts the dot back at the start, keeping the keys held
+        void respawn();
 
         //Position accessors
         int getPosX();
@@ -90,15 +205,22 @@ class Dot
         int getVelX();
         int getVelY();
 
-    private:
-        //The X and Y offsets of the dot
-        int mPosX, mPosY;
+        //Score and energy of the round
+        PlayerStats& getStats();
+
+        //Where the dot is, the velocity follows the keys held and is never rewound
+        Transform& getTransform();
 
-        //The velocity of the dot
-        int mVelX, mVelY;
+    private:
+        //The dot's entity, which holds its position, velocity, collision box and stats
+        EntityId mEntity;
+};
 
-        //Dot's collision box
-        SDL_Rect mCollider;
+//Textures entities can be drawn with
+enum SpriteTexture
+{
+    SPRITE_DOT,
+    SPRITE_TOTAL
 };
 
 //Starts up SDL and creates window
@@ -113,6 +235,15 @@ void close();
 //Box collision detector
 bool checkCollision( SDL_Rect a, SDL_Rect& b );
 
+//Box filters a 32 bit surface down to the given size, returns NULL on failure
+SDL_Surface* shrinkSurface( SDL_Surface* source, int width, int height );
+
+//Draws every entity with a sprite relative to the camera, shrunk by the zoom factor
+void renderEntities( EntityStore& store, SDL_Rect& camera, double zoom );
+
+//Sizes the camera for the zoom factor and centers it on the given point inside the level
+void updateCamera( SDL_Rect& camera, double zoom, int centerX, int centerY );
+
 //The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
@@ -122,13 +253,38 @@ SDL_Renderer* gRenderer = NULL;
 //Globally used font
 TTF_Font *gFont = NULL;
 
+//Every dot, ghost, enemy and pickup in the world
+EntityStore gEntities;
+
+//The walls of the level and the grid the dots collide against
+Level gLevel;
+CollisionGrid gWalls;
+
+//Where chasers may be scattered, the way to the dot around the chasers hunting it, and the chasers
+FlowField gSpawns;
+FlowField gField;
+Swarm gSwarm;
+
+//The last ticks of the round, the chasers apart since their number changes every round
+StateRing gRewind;
+StateRing gSwarmRewind;
+
+//What the dot can see and the mask that hides the rest
+FogOfWar gFog;
+LFogTexture gFogTexture;
+
 //Scene textures
 LTexture gDotTexture;
-LTexture gBGTexture;
+LTexturePyramid gBGTexture;
 LTexture gCTexture;
 LTexture gGMTexture;
 LTexture gTimeTextTexture;
 LTexture gPromptTextTexture;
+LTexture gPhaseTextTexture;
+LTexture gBoardTextTexture;
+
+//Texture of each sprite
+LTexture* gSpriteTextures[ SPRITE_TOTAL ] = { &gDotTexture };
 
 //The music that will be played
 Mix_Music *gMusic = NULL;
@@ -136,4 +292,10 @@ Mix_Music *gMusic = NULL;
 //The sound effects that will be used
 Mix_Chunk *gScratch = NULL;
 Mix_Chunk *gHigh = NULL;
-Mix_Chunk *gMedium = NULL;
\ No newline at end of file
+Mix_Chunk *gMedium = NULL;
+
+//Best runs on this level
+Leaderboard gLeaderboard;
+
+//Winning runs with their keys, for a server to play again before trusting the score
+FILE* gRunLog = NULL;
\ No newline at end of file
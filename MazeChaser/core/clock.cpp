@@ -0,0 +1,57 @@
+#include "clock.hpp"
+
+Clock::~Clock()
+{
+}
+
+TickClock::TickClock( int ticksPerSecond )
+{
+	mTicks = 0;
+	mTicksPerSecond = ticksPerSecond;
+}
+
+uint64_t TickClock::nowMicros()
+{
+	return ( mTicks * 1000000 + mTicksPerSecond - 1 ) / mTicksPerSecond;
+}
+
+void TickClock::advance( int ticks )
+{
+	mTicks += ticks;
+}
+
+FixedStep::FixedStep( Clock& clock, int ticksPerSecond, int maxTicks ) : mClock( clock )
+{
+	mTicksPerSecond = ticksPerSecond;
+	mMaxTicks = maxTicks;
+	mStart = 0;
+	mSkipped = 0;
+	mTicks = 0;
+}
+
+void FixedStep::reset()
+{
+	mStart = mClock.nowMicros();
+	mSkipped = 0;
+	mTicks = 0;
+}
+
+int FixedStep::advance()
+{
+	//Count from the start every time, so the tick rate never drifts from the clock
+	uint64_t due = ( mClock.nowMicros() - mStart ) * mTicksPerSecond / 1000000 - mSkipped;
+	if( due > mTicks + mMaxTicks )
+	{
+		mSkipped += due - mTicks - mMaxTicks;
+		due = mTicks + mMaxTicks;
+	}
+
+	int ticks = due - mTicks;
+	mTicks = due;
+	return ticks;
+}
+
+uint64_t FixedStep::getTicks()
+{
+	return mTicks;
+}
@@ -0,0 +1,67 @@
+//Where the simulation gets its time from, and how that time is cut into fixed ticks
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <stdint.h>
+
+//Most ticks a game simulates in one frame after a stall, the rest are dropped
+const int MAX_CATCH_UP_TICKS = 8;
+
+//A time source, live play reads a hardware counter and headless runs count their own ticks
+class Clock
+{
+    public:
+        virtual ~Clock();
+
+        //Microseconds since some fixed point
+        virtual uint64_t nowMicros() = 0;
+};
+
+//Virtual time that only moves when told to, so a headless run goes as fast as the machine allows
+class TickClock : public Clock
+{
+    public:
+        //Initializes variables
+        TickClock( int ticksPerSecond );
+
+        //Microseconds of the ticks so far, rounded up so a FixedStep sees every tick
+        uint64_t nowMicros();
+
+        //Moves time on by whole ticks
+        void advance( int ticks );
+
+    private:
+        uint64_t mTicks;
+        int mTicksPerSecond;
+};
+
+//Cuts a clock into whole simulation ticks, carrying what is left over into the next call
+class FixedStep
+{
+    public:
+        //Initializes variables, a stall of more than maxTicks is dropped rather than caught up
+        FixedStep( Clock& clock, int ticksPerSecond, int maxTicks );
+
+        //Starts counting from now
+        void reset();
+
+        //Number of ticks to simulate since the last call
+        int advance();
+
+        //Ticks handed out since the last reset
+        uint64_t getTicks();
+
+    private:
+        Clock& mClock;
+        int mTicksPerSecond;
+        int mMaxTicks;
+
+        //When counting started, and ticks skipped after stalls
+        uint64_t mStart;
+        uint64_t mSkipped;
+
+        //Ticks handed out
+        uint64_t mTicks;
+};
+
+#endif
@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <string.h>
+#include "collision_grid.hpp"
+
+//First bytes of every mask file, the last one is the format version
+static const unsigned char MASK_HEADER[ 8 ] = { 'M', 'C', 'M', 'K', 0, 0, 0, 1 };
+
+//Cells covering the pixels [ from, to )
+static int firstCell( int from, int cellSize )
+{
+	return from < 0 ? -( ( -from + cellSize - 1 ) / cellSize ) : from / cellSize;
+}
+
+static void putInt( uint32_t n, unsigned char* out )
+{
+	out[ 0 ] = n & 0xff;
+	out[ 1 ] = ( n >> 8 ) & 0xff;
+	out[ 2 ] = ( n >> 16 ) & 0xff;
+	out[ 3 ] = ( n >> 24 ) & 0xff;
+}
+
+static uint32_t getInt( const unsigned char* in )
+{
+	return in[ 0 ] | ( in[ 1 ] << 8 ) | ( in[ 2 ] << 16 ) | ( (uint32_t)in[ 3 ] << 24 );
+}
+
+CollisionGrid::CollisionGrid()
+{
+	mCellSize = 1;
+	mColumns = 0;
+	mRows = 0;
+	mWordsPerRow = 0;
+}
+
+void CollisionGrid::create( int width, int height, int cellSize )
+{
+	mCellSize = cellSize;
+	mColumns = ( width + cellSize - 1 ) / cellSize;
+	mRows = ( height + cellSize - 1 ) / cellSize;
+	mWordsPerRow = ( mColumns + 63 ) / 64;
+	mBits.assign( mWordsPerRow * mRows, 0 );
+}
+
+void CollisionGrid::build( const Level& level, int cellSize )
+{
+	create( level.width, level.height, cellSize );
+
+	for( size_t i = 0; i < level.walls.size(); ++i )
+	{
+		//Cells whose centres fall inside the wall
+		const LevelRect& wall = level.walls[ i ];
+		int half = cellSize / 2;
+		int left = firstCell( wall.x - half + cellSize - 1, cellSize );
+		int right = firstCell( wall.x + wall.w - half + cellSize - 1, cellSize );
+		int top = firstCell( wall.y - half + cellSize - 1, cellSize );
+		int bottom = firstCell( wall.y + wall.h - half + cellSize - 1, cellSize );
+		for( int row = top; row < bottom; ++row )
+		{
+			for( int column = left; column < right; ++column )
+			{
+				setSolid( column, row, true );
+			}
+		}
+	}
+}
+
+void CollisionGrid::setSolid( int column, int row, bool solid )
+{
+	if( column < 0 || row < 0 || column >= mColumns || row >= mRows )
+	{
+		return;
+	}
+
+	uint64_t& word = mBits[ row * mWordsPerRow + column / 64 ];
+	uint64_t bit = (uint64_t)1 << ( column % 64 );
+	word = solid ? word | bit : word & ~bit;
+}
+
+bool CollisionGrid::isSolid( int column, int row )
+{
+	if( column < 0 || row < 0 || column >= mColumns || row >= mRows )
+	{
+		return false;
+	}
+	return ( mBits[ row * mWordsPerRow + column / 64 ] >> ( column % 64 ) ) & 1;
+}
+
+bool CollisionGrid::hits( int x, int y, int w, int h )
+{
+	//Clip the cells the box overlaps to the grid
+	int left = firstCell( x, mCellSize );
+	int right = firstCell( x + w - 1, mCellSize );
+	int top = firstCell( y, mCellSize );
+	int bottom = firstCell( y + h - 1, mCellSize );
+	if( left < 0 )
+	{
+		left = 0;
+	}
+	if( top < 0 )
+	{
+		top = 0;
+	}
+	if( right >= mColumns )
+	{
+		right = mColumns - 1;
+	}
+	if( bottom >= mRows )
+	{
+		bottom = mRows - 1;
+	}
+
+	//Test each row a word at a time
+	for( int row = top; row <= bottom; ++row )
+	{
+		const uint64_t* words = &mBits[ row * mWordsPerRow ];
+		for( int word = left / 64; word <= right / 64; ++word )
+		{
+			int from = word == left / 64 ? left % 64 : 0;
+			int to = word == right / 64 ? right % 64 : 63;
+			uint64_t mask = ( to == 63 ? ~(uint64_t)0 : ( (uint64_t)1 << ( to + 1 ) ) - 1 ) & ~( ( (uint64_t)1 << from ) - 1 );
+			if( words[ word ] & mask )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+std::vector<LevelRect> CollisionGrid::toRects()
+{
+	std::vector<LevelRect> rects;
+
+	//Runs still open from the row above, as indices into rects
+	std::vector<int> open;
+	for( int row = 0; row < mRows; ++row )
+	{
+		std::vector<int> next;
+		int column = 0;
+		while( column < mColumns )
+		{
+			if( !isSolid( column, row ) )
+			{
+				++column;
+				continue;
+			}
+
+			int start = column;
+			while( column < mColumns && isSolid( column, row ) )
+			{
+				++column;
+			}
+
+			//Grow the rectangle above when it spans exactly this run
+			LevelRect run = { start * mCellSize, row * mCellSize, ( column - start ) * mCellSize, mCellSize };
+			int grown = -1;
+			for( size_t i = 0; i < open.size() && grown < 0; ++i )
+			{
+				LevelRect& above = rects[ open[ i ] ];
+				if( above.x == run.x && above.w == run.w )
+				{
+					above.h += mCellSize;
+					grown = open[ i ];
+				}
+			}
+			if( grown < 0 )
+			{
+				grown = rects.size();
+				rects.push_back( run );
+			}
+			next.push_back( grown );
+		}
+		open.swap( next );
+	}
+
+	return rects;
+}
+
+bool CollisionGrid::load( std::string path )
+{
+	FILE* file = fopen( path.c_str(), "rb" );
+	if( file == NULL )
+	{
+		printf( "Unable to open mask %s!\n", path.c_str() );
+		return false;
+	}
+
+	unsigned char header[ sizeof( MASK_HEADER ) + 12 ];
+	bool success = fread( header, 1, sizeof( header ), file ) == sizeof( header ) && memcmp( header, MASK_HEADER, sizeof( MASK_HEADER ) ) == 0;
+	if( success )
+	{
+		int cellSize = getInt( header + 8 );
+		int columns = getInt( header + 12 );
+		int rows = getInt( header + 16 );
+		success = cellSize > 0 && columns > 0 && rows > 0;
+		if( success )
+		{
+			create( columns * cellSize, rows * cellSize, cellSize );
+
+			std::vector<unsigned char> bytes( mBits.size() * 8 );
+			success = fread( &bytes[ 0 ], 1, bytes.size(), file ) == bytes.size();
+			for( size_t i = 0; i < mBits.size() && success; ++i )
+			{
+				mBits[ i ] = getInt( &bytes[ i * 8 ] ) | ( (uint64_t)getInt( &bytes[ i * 8 + 4 ] ) << 32 );
+			}
+		}
+	}
+	fclose( file );
+
+	if( !success )
+	{
+		printf( "%s is not a collision mask!\n", path.c_str() );
+	}
+	return success;
+}
+
+bool CollisionGrid::save( std::string path )
+{
+	FILE* file = fopen( path.c_str(), "wb" );
+	if( file == NULL )
+	{
+		printf( "Unable to write mask %s!\n", path.c_str() );
+		return false;
+	}
+
+	std::vector<unsigned char> bytes( sizeof( MASK_HEADER ) + 12 + mBits.size() * 8 );
+	memcpy( &bytes[ 0 ], MASK_HEADER, sizeof( MASK_HEADER ) );
+	putInt( mCellSize, &bytes[ 8 ] );
+	putInt( mColumns, &bytes[ 12 ] );
+	putInt( mRows, &bytes[ 16 ] );
+	for( size_t i = 0; i < mBits.size(); ++i )
+	{
+		putInt( (uint32_t)mBits[ i ], &bytes[ 20 + i * 8 ] );
+		putInt( (uint32_t)( mBits[ i ] >> 32 ), &bytes[ 24 + i * 8 ] );
+	}
+
+	bool success = fwrite( &bytes[ 0 ], 1, bytes.size(), file ) == bytes.size();
+	success = fclose( file ) == 0 && success;
+	if( !success )
+	{
+		printf( "Unable to write mask %s!\n", path.c_str() );
+	}
+	return success;
+}
+
+int CollisionGrid::getCellSize()
+{
+	return mCellSize;
+}
+
+int CollisionGrid::getColumns()
+{
+	return mColumns;
+}
+
+int CollisionGrid::getRows()
+{
+	return mRows;
+}
@@ -0,0 +1,54 @@
+//Walls as a bitmap of solid cells, so a collision test is a few word masks per row
+#ifndef COLLISION_GRID_HPP
+#define COLLISION_GRID_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "level.hpp"
+
+//Cell size the games collide at
+const int COLLISION_CELL = 16;
+
+class CollisionGrid
+{
+    public:
+        //Initializes variables
+        CollisionGrid();
+
+        //Makes an empty grid over width x height pixels
+        void create( int width, int height, int cellSize );
+
+        //Makes a grid from a level, a cell is solid when a wall covers its centre
+        void build( const Level& level, int cellSize );
+
+        //Cell access, cells outside the grid are open
+        void setSolid( int column, int row, bool solid );
+        bool isSolid( int column, int row );
+
+        //Whether any solid cell overlaps the box
+        bool hits( int x, int y, int w, int h );
+
+        //Solid cells as rectangles, runs along each row merged with identical runs below them
+        std::vector<LevelRect> toRects();
+
+        //Packed bitmap file, a small header and then every row of words
+        bool load( std::string path );
+        bool save( std::string path );
+
+        //Grid accessors
+        int getCellSize();
+        int getColumns();
+        int getRows();
+
+    private:
+        int mCellSize;
+        int mColumns;
+        int mRows;
+
+        //Bits of each row, lowest bit is the leftmost cell
+        int mWordsPerRow;
+        std::vector<uint64_t> mBits;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "entity_store.hpp"
+
+EntityStore::EntityStore()
+{
+}
+
+EntityId EntityStore::create( EntityKind kind, int components )
+{
+	//Reuse a slot if one is free, its generation tells old handles apart
+	int slot;
+	if( !mFreeSlots.empty() )
+	{
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		slot = mIndexOf.size();
+		mIndexOf.push_back( -1 );
+		mGenerations.push_back( 0 );
+	}
+
+	mIndexOf[ slot ] = mKinds.size();
+	mSlotOf.push_back( slot );
+	mKinds.push_back( kind );
+	mComponents.push_back( components );
+
+	Transform transform = { 0, 0 };
+	Velocity velocity = { 0, 0 };
+	Collider collider = { 0, 0 };
+	PlayerStats stats = {};
+	Sprite sprite = { 0 };
+	mTransforms.push_back( transform );
+	mVelocities.push_back( velocity );
+	mColliders.push_back( collider );
+	mStats.push_back( stats );
+	mSprites.push_back( sprite );
+
+	EntityId id = { slot, mGenerations[ slot ] };
+	return id;
+}
+
+void EntityStore::destroy( EntityId id )
+{
+	int index = find( id );
+	if( index < 0 )
+	{
+		return;
+	}
+
+	//Move the last entity into the hole
+	int last = mKinds.size() - 1;
+	mKinds[ index ] = mKinds[ last ];
+	mComponents[ index ] = mComponents[ last ];
+	mTransforms[ index ] = mTransforms[ last ];
+	mVelocities[ index ] = mVelocities[ last ];
+	mColliders[ index ] = mColliders[ last ];
+	mStats[ index ] = mStats[ last ];
+	mSprites[ index ] = mSprites[ last ];
+	mSlotOf[ index ] = mSlotOf[ last ];
+	mIndexOf[ mSlotOf[ index ] ] = index;
+
+	mKinds.pop_back();
+	mComponents.pop_back();
+	mTransforms.pop_back();
+	mVelocities.pop_back();
+	mColliders.pop_back();
+	mStats.pop_back();
+	mSprites.pop_back();
+	mSlotOf.pop_back();
+
+	//Free the slot and outdate every handle to it
+	mIndexOf[ id.slot ] = -1;
+	++mGenerations[ id.slot ];
+	mFreeSlots.push_back( id.slot );
+}
+
+void EntityStore::clear()
+{
+	while( !mSlotOf.empty() )
+	{
+		EntityId id = { mSlotOf.back(), mGenerations[ mSlotOf.back() ] };
+		destroy( id );
+	}
+}
+
+int EntityStore::find( EntityId id )
+{
+	if( id.slot < 0 || id.slot >= (int)mIndexOf.size() || mGenerations[ id.slot ] != id.generation )
+	{
+		return -1;
+	}
+	return mIndexOf[ id.slot ];
+}
+
+int EntityStore::getCount()
+{
+	return mKinds.size();
+}
+
+uint8_t* EntityStore::getKinds()
+{
+	return mKinds.data();
+}
+
+int* EntityStore::getComponents()
+{
+	return mComponents.data();
+}
+
+Transform* EntityStore::getTransforms()
+{
+	return mTransforms.data();
+}
+
+Velocity* EntityStore::getVelocities()
+{
+	return mVelocities.data();
+}
+
+Collider* EntityStore::getColliders()
+{
+	return mColliders.data();
+}
+
+PlayerStats* EntityStore::getStats()
+{
+	return mStats.data();
+}
+
+Sprite* EntityStore::getSprites()
+{
+	return mSprites.data();
+}
+
+void moveEntities( EntityStore& store, CollisionGrid& walls, int levelWidth, int levelHeight )
+{
+	int count = store.getCount();
+	const int* components = store.getComponents();
+	Transform* transforms = store.getTransforms();
+	const Velocity* velocities = store.getVelocities();
+	const Collider* colliders = store.getColliders();
+
+	for( int i = 0; i < count; ++i )
+	{
+		if( ( components[ i ] & ( COMPONENT_TRANSFORM | COMPONENT_VELOCITY ) ) != ( COMPONENT_TRANSFORM | COMPONENT_VELOCITY ) )
+		{
+			continue;
+		}
+
+		if( components[ i ] & COMPONENT_COLLIDER )
+		{
+			moveBox( transforms[ i ], velocities[ i ], colliders[ i ], walls, levelWidth, levelHeight );
+		}
+		else
+		{
+			transforms[ i ].x += velocities[ i ].x;
+			transforms[ i ].y += velocities[ i ].y;
+		}
+	}
+}
+
+void moveBox( Transform& position, const Velocity& velocity, const Collider& collider, CollisionGrid& walls, int levelWidth, int levelHeight )
+{
+	//Take the whole step
+	position.x += velocity.x;
+	position.y += velocity.y;
+
+	//A step into a wall is undone on both axes, a step out of the level only on the axis that left it
+	bool hit = walls.hits( position.x, position.y, collider.w, collider.h );
+	if( position.x < 0 || position.x + collider.w > levelWidth || hit )
+	{
+		position.x -= velocity.x;
+	}
+	if( position.y < 0 || position.y + collider.h > levelHeight || hit )
+	{
+		position.y -= velocity.y;
+	}
+}
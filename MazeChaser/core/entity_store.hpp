@@ -0,0 +1,116 @@
+//Everything in the world that moves or is drawn, one packed array per component so systems walk them in order
+#ifndef ENTITY_STORE_HPP
+#define ENTITY_STORE_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "collision_grid.hpp"
+#include "rules.hpp"
+
+//What an entity is
+enum EntityKind
+{
+    ENTITY_PLAYER,
+    ENTITY_REMOTE,
+    ENTITY_GHOST,
+    ENTITY_ENEMY,
+    ENTITY_PICKUP
+};
+
+//Components an entity has, one bit each
+enum ComponentFlag
+{
+    COMPONENT_TRANSFORM = 1,
+    COMPONENT_VELOCITY = 2,
+    COMPONENT_COLLIDER = 4,
+    COMPONENT_STATS = 8,
+    COMPONENT_SPRITE = 16
+};
+
+//Top left corner in level pixels
+struct Transform
+{
+    int x, y;
+};
+
+//Pixels moved per tick
+struct Velocity
+{
+    int x, y;
+};
+
+//Box that may not overlap a wall, from the top left corner
+struct Collider
+{
+    int w, h;
+};
+
+//What to draw, an index into the game's own textures
+struct Sprite
+{
+    int texture;
+};
+
+//Handle that stays valid while its entity lives, however the arrays are shuffled
+struct EntityId
+{
+    int slot;
+    int generation;
+};
+
+class EntityStore
+{
+    public:
+        //Initializes variables
+        EntityStore();
+
+        //Adds an entity with the given components zeroed
+        EntityId create( EntityKind kind, int components );
+
+        //Removes an entity, the last one moves into its place so the arrays stay packed
+        void destroy( EntityId id );
+
+        //Removes every entity
+        void clear();
+
+        //Index of a living entity in the component arrays, -1 once it has been destroyed
+        int find( EntityId id );
+
+        //Number of entities, and so the length of every component array
+        int getCount();
+
+        //Component arrays, entries of components an entity lacks are unused
+        uint8_t* getKinds();
+        int* getComponents();
+        Transform* getTransforms();
+        Velocity* getVelocities();
+        Collider* getColliders();
+        PlayerStats* getStats();
+        Sprite* getSprites();
+
+    private:
+        //Packed components, all the same length
+        std::vector<uint8_t> mKinds;
+        std::vector<int> mComponents;
+        std::vector<Transform> mTransforms;
+        std::vector<Velocity> mVelocities;
+        std::vector<Collider> mColliders;
+        std::vector<PlayerStats> mStats;
+        std::vector<Sprite> mSprites;
+
+        //Slot of each packed entity
+        std::vector<int> mSlotOf;
+
+        //Packed index and generation of each slot, and slots free for reuse
+        std::vector<int> mIndexOf;
+        std::vector<int> mGenerations;
+        std::vector<int> mFreeSlots;
+};
+
+//Moves everything with a velocity, entities with a collider stay inside the level and out of the walls
+void moveEntities( EntityStore& store, CollisionGrid& walls, int levelWidth, int levelHeight );
+
+//Moves one box a step, the step moveEntities takes for every entity with a collider
+void moveBox( Transform& position, const Velocity& velocity, const Collider& collider, CollisionGrid& walls, int levelWidth, int levelHeight );
+
+#endif
@@ -0,0 +1,146 @@
+#include "flow_field.hpp"
+
+FlowField::FlowField()
+{
+	mCellSize = 1;
+	mColumns = 0;
+	mRows = 0;
+	mTarget = -1;
+	mQueueTail = 0;
+}
+
+void FlowField::create( CollisionGrid& grid )
+{
+	mCellSize = grid.getCellSize();
+	mColumns = grid.getColumns();
+	mRows = grid.getRows();
+
+	int cells = mColumns * mRows;
+	mOpen.resize( cells );
+	for( int row = 0; row < mRows; ++row )
+	{
+		for( int column = 0; column < mColumns; ++column )
+		{
+			mOpen[ row * mColumns + column ] = !grid.isSolid( column, row );
+		}
+	}
+
+	mGoals.assign( cells, 0 );
+	mDirections.assign( cells, FLOW_NONE );
+	mDistances.assign( cells, -1 );
+	mQueue.resize( cells );
+	mTarget = -1;
+	mQueueTail = 0;
+}
+
+void FlowField::sweep( int column, int row, int reach, const int* goals, int goalCount )
+{
+	//Only the cells the last sweep reached point anywhere
+	for( int i = 0; i < mQueueTail; ++i )
+	{
+		mDirections[ mQueue[ i ] ] = FLOW_NONE;
+		mDistances[ mQueue[ i ] ] = -1;
+	}
+	mQueueTail = 0;
+
+	//Nothing can walk into a wall, so keep heading for the last open cell
+	if( column >= 0 && row >= 0 && column < mColumns && row < mRows && mOpen[ row * mColumns + column ] )
+	{
+		mTarget = row * mColumns + column;
+	}
+	if( mTarget < 0 )
+	{
+		return;
+	}
+
+	//Several chasers may stand on one cell, so each goal is counted once
+	int wanted = 0;
+	for( int i = 0; i < goalCount; ++i )
+	{
+		if( goals[ i ] != mTarget && !mGoals[ goals[ i ] ] )
+		{
+			mGoals[ goals[ i ] ] = 1;
+			++wanted;
+		}
+	}
+
+	mDistances[ mTarget ] = 0;
+	mQueue[ 0 ] = mTarget;
+	mQueueTail = 1;
+
+	//Breadth first out of the target, each new cell pointing back at the one it was reached from
+	int head = 0;
+	while( head < mQueueTail && ( goalCount == 0 || wanted > 0 ) )
+	{
+		int cell = mQueue[ head++ ];
+		int distance = mDistances[ cell ] + 1;
+		if( distance > reach )
+		{
+			break;
+		}
+		int column = cell % mColumns;
+		int row = cell / mColumns;
+
+		int neighbours[ 4 ] = { column > 0 ? cell - 1 : -1, column < mColumns - 1 ? cell + 1 : -1, row > 0 ? cell - mColumns : -1, row < mRows - 1 ? cell + mColumns : -1 };
+		const uint8_t back[ 4 ] = { FLOW_RIGHT, FLOW_LEFT, FLOW_DOWN, FLOW_UP };
+		for( int i = 0; i < 4; ++i )
+		{
+			int next = neighbours[ i ];
+			if( next >= 0 && mOpen[ next ] && mDistances[ next ] < 0 )
+			{
+				mDistances[ next ] = distance;
+				mDirections[ next ] = back[ i ];
+				mQueue[ mQueueTail++ ] = next;
+				wanted -= mGoals[ next ];
+			}
+		}
+	}
+
+	for( int i = 0; i < goalCount; ++i )
+	{
+		mGoals[ goals[ i ] ] = 0;
+	}
+}
+
+void FlowField::sweepAll( int column, int row )
+{
+	sweep( column, row, mColumns * mRows, NULL, 0 );
+}
+
+int FlowField::getDirection( int column, int row )
+{
+	if( column < 0 || row < 0 || column >= mColumns || row >= mRows )
+	{
+		return FLOW_NONE;
+	}
+	return mDirections[ row * mColumns + column ];
+}
+
+int FlowField::getDistance( int column, int row )
+{
+	if( column < 0 || row < 0 || column >= mColumns || row >= mRows )
+	{
+		return -1;
+	}
+	return mDistances[ row * mColumns + column ];
+}
+
+const uint8_t* FlowField::getDirections()
+{
+	return mDirections.data();
+}
+
+int FlowField::getCellSize()
+{
+	return mCellSize;
+}
+
+int FlowField::getColumns()
+{
+	return mColumns;
+}
+
+int FlowField::getRows()
+{
+	return mRows;
+}
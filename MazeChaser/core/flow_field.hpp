@@ -0,0 +1,73 @@
+//Shortest way to one cell from the open cells of a collision grid around it, swept breadth first
+#ifndef FLOW_FIELD_HPP
+#define FLOW_FIELD_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "collision_grid.hpp"
+
+//Steps a chase sweep goes out from the target at most, just past the longest way along a sight line
+const int FLOW_REACH = 60;
+
+//Way out of a cell towards the target
+enum FlowDirection
+{
+    FLOW_NONE,
+    FLOW_LEFT,
+    FLOW_RIGHT,
+    FLOW_UP,
+    FLOW_DOWN
+};
+
+//Pixel step of each direction
+const int FLOW_STEP_X[ 5 ] = { 0, -1, 1, 0, 0 };
+const int FLOW_STEP_Y[ 5 ] = { 0, 0, 0, -1, 1 };
+
+class FlowField
+{
+    public:
+        //Initializes variables
+        FlowField();
+
+        //Takes the open cells of the grid, nothing points anywhere until the first sweep
+        void create( CollisionGrid& grid );
+
+        //Points the cells up to reach steps from a cell back at it, stopping as soon as every goal cell is reached,
+        //a target in a wall keeps the last open one and cells left out have no direction and no distance
+        void sweep( int column, int row, int reach, const int* goals, int goalCount );
+
+        //Sweeps every cell the target can be reached from
+        void sweepAll( int column, int row );
+
+        //Field of the last sweep, cells outside the grid have no direction and no distance
+        int getDirection( int column, int row );
+        int getDistance( int column, int row );
+
+        //Directions of every cell, row by row
+        const uint8_t* getDirections();
+
+        //Field accessors
+        int getCellSize();
+        int getColumns();
+        int getRows();
+
+    private:
+        int mCellSize;
+        int mColumns;
+        int mRows;
+
+        //Whether each cell can be walked through, and which ones a sweep is still looking for
+        std::vector<uint8_t> mOpen;
+        std::vector<uint8_t> mGoals;
+
+        //Field and its target cell, -1 before the first sweep
+        std::vector<uint8_t> mDirections;
+        std::vector<int> mDistances;
+        int mTarget;
+
+        //Cells the last sweep reached in the order it reached them, so the next one only clears those
+        std::vector<int> mQueue;
+        int mQueueTail;
+};
+
+#endif
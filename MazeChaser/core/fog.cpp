@@ -0,0 +1,217 @@
+#include "fog.hpp"
+
+//Turns the first octant into each of the eight
+static const int OCTANTS[ 8 ][ 4 ] =
+{
+	{ 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { 0, -1, 1, 0 }, { -1, 0, 0, 1 },
+	{ -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 }, { 1, 0, 0, -1 }
+};
+
+FogOfWar::FogOfWar()
+{
+	mColumns = 0;
+	mRows = 0;
+	mRadius = 0;
+	mOriginColumn = -1;
+	mOriginRow = -1;
+	mDirty = false;
+	mDirtyLeft = 0;
+	mDirtyTop = 0;
+	mDirtyRight = 0;
+	mDirtyBottom = 0;
+}
+
+void FogOfWar::create( CollisionGrid& grid, int radius )
+{
+	mColumns = grid.getColumns();
+	mRows = grid.getRows();
+	mRadius = radius;
+
+	mSolid.resize( mColumns * mRows );
+	for( int row = 0; row < mRows; ++row )
+	{
+		for( int column = 0; column < mColumns; ++column )
+		{
+			mSolid[ row * mColumns + column ] = grid.isSolid( column, row );
+		}
+	}
+
+	reset();
+}
+
+void FogOfWar::reset()
+{
+	mStates.assign( mColumns * mRows, FOG_UNSEEN );
+	mOriginColumn = -1;
+	mOriginRow = -1;
+
+	//The whole map has to be covered again
+	mDirty = mColumns > 0 && mRows > 0;
+	mDirtyLeft = 0;
+	mDirtyTop = 0;
+	mDirtyRight = mColumns - 1;
+	mDirtyBottom = mRows - 1;
+}
+
+void FogOfWar::update( int column, int row )
+{
+	if( ( column == mOriginColumn && row == mOriginRow ) || column < 0 || row < 0 || column >= mColumns || row >= mRows )
+	{
+		return;
+	}
+
+	//Only the box around the old cell can still be lit
+	if( mOriginColumn >= 0 )
+	{
+		int left = mOriginColumn - mRadius < 0 ? 0 : mOriginColumn - mRadius;
+		int right = mOriginColumn + mRadius >= mColumns ? mColumns - 1 : mOriginColumn + mRadius;
+		int top = mOriginRow - mRadius < 0 ? 0 : mOriginRow - mRadius;
+		int bottom = mOriginRow + mRadius >= mRows ? mRows - 1 : mOriginRow + mRadius;
+		for( int y = top; y <= bottom; ++y )
+		{
+			uint8_t* states = &mStates[ y * mColumns ];
+			for( int x = left; x <= right; ++x )
+			{
+				if( states[ x ] == FOG_VISIBLE )
+				{
+					states[ x ] = FOG_EXPLORED;
+				}
+			}
+		}
+		markDirty( mOriginColumn, mOriginRow );
+	}
+
+	//Light every octant from the new cell
+	mOriginColumn = column;
+	mOriginRow = row;
+	mStates[ row * mColumns + column ] = FOG_VISIBLE;
+	for( int octant = 0; octant < 8; ++octant )
+	{
+		castLight( 1, 1.0, 0.0, OCTANTS[ octant ][ 0 ], OCTANTS[ octant ][ 1 ], OCTANTS[ octant ][ 2 ], OCTANTS[ octant ][ 3 ] );
+	}
+	markDirty( column, row );
+}
+
+void FogOfWar::castLight( int row, double start, double end, int xx, int xy, int yx, int yy )
+{
+	if( start < end )
+	{
+		return;
+	}
+
+	int radiusSquared = mRadius * mRadius;
+	double newStart = 0.0;
+	for( int distance = row; distance <= mRadius; ++distance )
+	{
+		int dy = -distance;
+		bool blocked = false;
+		for( int dx = -distance; dx <= 0; ++dx )
+		{
+			//Slopes through the left and right edges of the cell
+			double leftSlope = ( dx - 0.5 ) / ( dy + 0.5 );
+			double rightSlope = ( dx + 0.5 ) / ( dy - 0.5 );
+			if( start < rightSlope )
+			{
+				continue;
+			}
+			if( end > leftSlope )
+			{
+				break;
+			}
+
+			//Cells past the edge of the grid block like walls
+			int x = mOriginColumn + dx * xx + dy * xy;
+			int y = mOriginRow + dx * yx + dy * yy;
+			bool inside = x >= 0 && y >= 0 && x < mColumns && y < mRows;
+			bool solid = !inside || mSolid[ y * mColumns + x ];
+			if( inside && dx * dx + dy * dy <= radiusSquared )
+			{
+				mStates[ y * mColumns + x ] = FOG_VISIBLE;
+			}
+
+			if( blocked )
+			{
+				//Still in the shadow of the wall
+				if( solid )
+				{
+					newStart = rightSlope;
+					continue;
+				}
+				blocked = false;
+				start = newStart;
+			}
+			else if( solid && distance < mRadius )
+			{
+				//The wall splits the light, what is left of it goes on in its own scan
+				blocked = true;
+				castLight( distance + 1, start, leftSlope, xx, xy, yx, yy );
+				newStart = rightSlope;
+			}
+		}
+		if( blocked )
+		{
+			break;
+		}
+	}
+}
+
+void FogOfWar::markDirty( int column, int row )
+{
+	int left = column - mRadius < 0 ? 0 : column - mRadius;
+	int right = column + mRadius >= mColumns ? mColumns - 1 : column + mRadius;
+	int top = row - mRadius < 0 ? 0 : row - mRadius;
+	int bottom = row + mRadius >= mRows ? mRows - 1 : row + mRadius;
+	if( !mDirty )
+	{
+		mDirty = true;
+		mDirtyLeft = left;
+		mDirtyTop = top;
+		mDirtyRight = right;
+		mDirtyBottom = bottom;
+		return;
+	}
+
+	mDirtyLeft = left < mDirtyLeft ? left : mDirtyLeft;
+	mDirtyTop = top < mDirtyTop ? top : mDirtyTop;
+	mDirtyRight = right > mDirtyRight ? right : mDirtyRight;
+	mDirtyBottom = bottom > mDirtyBottom ? bottom : mDirtyBottom;
+}
+
+bool FogOfWar::takeDirty( LevelRect& cells )
+{
+	if( !mDirty )
+	{
+		return false;
+	}
+
+	cells.x = mDirtyLeft;
+	cells.y = mDirtyTop;
+	cells.w = mDirtyRight - mDirtyLeft + 1;
+	cells.h = mDirtyBottom - mDirtyTop + 1;
+	mDirty = false;
+	return true;
+}
+
+int FogOfWar::getState( int column, int row )
+{
+	if( column < 0 || row < 0 || column >= mColumns || row >= mRows )
+	{
+		return FOG_UNSEEN;
+	}
+	return mStates[ row * mColumns + column ];
+}
+
+const uint8_t* FogOfWar::getStates()
+{
+	return mStates.data();
+}
+
+int FogOfWar::getColumns()
+{
+	return mColumns;
+}
+
+int FogOfWar::getRows()
+{
+	return mRows;
+}
@@ -0,0 +1,76 @@
+//What the dot can see of the collision grid, found by recursive shadowcasting from its cell
+#ifndef FOG_HPP
+#define FOG_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "collision_grid.hpp"
+#include "level.hpp"
+
+//Cells the dot sees in every direction
+const int FOG_RADIUS = 40;
+
+//What the fog knows about a cell
+enum FogState
+{
+    FOG_UNSEEN,
+    FOG_EXPLORED,
+    FOG_VISIBLE
+};
+
+class FogOfWar
+{
+    public:
+        //Initializes variables
+        FogOfWar();
+
+        //Takes the walls of the grid and covers every cell
+        void create( CollisionGrid& grid, int radius );
+
+        //Covers every cell again
+        void reset();
+
+        //Reveals what can be seen from a cell, nothing is recomputed while the cell stays the same
+        void update( int column, int row );
+
+        //Cells changed since the last call as a box of cells, false if nothing changed
+        bool takeDirty( LevelRect& cells );
+
+        //Cell access, cells outside the grid are unseen
+        int getState( int column, int row );
+
+        //States of every cell, row by row
+        const uint8_t* getStates();
+
+        //Fog accessors
+        int getColumns();
+        int getRows();
+
+    private:
+        //Lights one octant from the origin, rows from row outwards between two slopes
+        void castLight( int row, double start, double end, int xx, int xy, int yx, int yy );
+
+        //Marks the box around a cell as changed
+        void markDirty( int column, int row );
+
+        int mColumns;
+        int mRows;
+        int mRadius;
+
+        //Whether each cell blocks sight, and what the fog knows about it
+        std::vector<uint8_t> mSolid;
+        std::vector<uint8_t> mStates;
+
+        //Cell seen from, -1 when nothing is lit
+        int mOriginColumn;
+        int mOriginRow;
+
+        //Cells changed since the last takeDirty, inclusive
+        bool mDirty;
+        int mDirtyLeft;
+        int mDirtyTop;
+        int mDirtyRight;
+        int mDirtyBottom;
+};
+
+#endif
@@ -0,0 +1,442 @@
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "leaderboard.hpp"
+
+//First bytes of every log, the last one is the record version
+static const unsigned char LOG_HEADER[ 8 ] = { 'M', 'C', 'L', 'B', 0, 0, 0, 1 };
+
+//Name, score, energy, time and checksum
+static const int RECORD_SIZE = PLAYER_NAME_LENGTH + 4 + 4 + 4 + 4;
+
+//Records read at a time while rebuilding
+static const int READ_RECORDS = 4096;
+
+static void putInt( uint32_t n, unsigned char* out )
+{
+	out[ 0 ] = n & 0xff;
+	out[ 1 ] = ( n >> 8 ) & 0xff;
+	out[ 2 ] = ( n >> 16 ) & 0xff;
+	out[ 3 ] = ( n >> 24 ) & 0xff;
+}
+
+static uint32_t getInt( const unsigned char* in )
+{
+	return in[ 0 ] | ( in[ 1 ] << 8 ) | ( in[ 2 ] << 16 ) | ( (uint32_t)in[ 3 ] << 24 );
+}
+
+//FNV-1a, enough to spot a record torn by a crash
+static uint32_t checksum( const unsigned char* data, int length )
+{
+	uint32_t hash = 2166136261u;
+	for( int i = 0; i < length; ++i )
+	{
+		hash = ( hash ^ data[ i ] ) * 16777619u;
+	}
+	return hash;
+}
+
+static void encodeRecord( const ScoreEntry& entry, unsigned char* out )
+{
+	memset( out, 0, PLAYER_NAME_LENGTH );
+	memcpy( out, entry.player.c_str(), entry.player.size() < (size_t)PLAYER_NAME_LENGTH ? entry.player.size() : PLAYER_NAME_LENGTH );
+	putInt( (uint32_t)entry.score, out + PLAYER_NAME_LENGTH );
+	putInt( (uint32_t)entry.energy, out + PLAYER_NAME_LENGTH + 4 );
+	putInt( entry.timeMs, out + PLAYER_NAME_LENGTH + 8 );
+	putInt( checksum( out, RECORD_SIZE - 4 ), out + RECORD_SIZE - 4 );
+}
+
+static bool decodeRecord( const unsigned char* in, ScoreEntry& entry )
+{
+	if( getInt( in + RECORD_SIZE - 4 ) != checksum( in, RECORD_SIZE - 4 ) )
+	{
+		return false;
+	}
+	entry.player.assign( (const char*)in, strnlen( (const char*)in, PLAYER_NAME_LENGTH ) );
+	entry.score = (int)getInt( in + PLAYER_NAME_LENGTH );
+	entry.energy = (int)getInt( in + PLAYER_NAME_LENGTH + 4 );
+	entry.timeMs = getInt( in + PLAYER_NAME_LENGTH + 8 );
+	return true;
+}
+
+std::string leaderboardPath( std::string level )
+{
+	return level + ".scores";
+}
+
+Leaderboard::Leaderboard()
+{
+	mFile = NULL;
+	mRoot = -1;
+	mRunCount = 0;
+	mCorruptCount = 0;
+	mRandom = 2463534242u;
+}
+
+Leaderboard::~Leaderboard()
+{
+	close();
+}
+
+bool Leaderboard::open( std::string path )
+{
+	close();
+
+	//Rebuild from every intact record, one damaged in place is skipped but kept so nothing after it is lost
+	long goodLength = 0;
+	FILE* file = fopen( path.c_str(), "rb" );
+	if( file != NULL )
+	{
+		//Anything else is left alone, it may be a wrong path or a newer format
+		unsigned char header[ sizeof( LOG_HEADER ) ];
+		size_t headerLength = fread( header, 1, sizeof( header ), file );
+		if( memcmp( header, LOG_HEADER, headerLength ) != 0 )
+		{
+			printf( "%s is not a leaderboard!\n", path.c_str() );
+			fclose( file );
+			return false;
+		}
+
+		//A header cut short by a crash while the log was made starts it over
+		if( headerLength == sizeof( LOG_HEADER ) )
+		{
+			goodLength = sizeof( LOG_HEADER );
+
+			std::vector<unsigned char> block( READ_RECORDS * RECORD_SIZE );
+			while( true )
+			{
+				size_t records = fread( &block[ 0 ], RECORD_SIZE, READ_RECORDS, file );
+				for( size_t i = 0; i < records; ++i )
+				{
+					ScoreEntry entry;
+					if( decodeRecord( &block[ i * RECORD_SIZE ], entry ) )
+					{
+						rankRun( entry );
+					}
+					else
+					{
+						++mCorruptCount;
+					}
+					goodLength += RECORD_SIZE;
+				}
+				if( records < (size_t)READ_RECORDS )
+				{
+					break;
+				}
+			}
+		}
+		fclose( file );
+		if( mCorruptCount > 0 )
+		{
+			printf( "Skipped %d damaged runs in leaderboard %s\n", mCorruptCount, path.c_str() );
+		}
+
+		//Only a partial record at the end, torn by a crash, is cut off
+		if( truncate( path.c_str(), goodLength ) != 0 )
+		{
+			printf( "Unable to trim leaderboard %s!\n", path.c_str() );
+		}
+	}
+
+	mFile = fopen( path.c_str(), "ab" );
+	if( mFile == NULL )
+	{
+		printf( "Unable to open leaderboard %s!\n", path.c_str() );
+		return false;
+	}
+	if( goodLength == 0 && fwrite( LOG_HEADER, 1, sizeof( LOG_HEADER ), mFile ) != sizeof( LOG_HEADER ) )
+	{
+		printf( "Unable to write leaderboard %s!\n", path.c_str() );
+		close();
+		return false;
+	}
+	fflush( mFile );
+
+	return true;
+}
+
+void Leaderboard::close()
+{
+	if( mFile != NULL )
+	{
+		fclose( mFile );
+		mFile = NULL;
+	}
+	mNodes.clear();
+	mFreeNodes.clear();
+	mBest.clear();
+	mRoot = -1;
+	mRunCount = 0;
+	mCorruptCount = 0;
+}
+
+int Leaderboard::submit( const ScoreEntry& entry )
+{
+	if( mFile == NULL )
+	{
+		return -1;
+	}
+
+	//The run is only ranked once it is safely on disk
+	unsigned char record[ RECORD_SIZE ];
+	encodeRecord( entry, record );
+	if( fwrite( record, RECORD_SIZE, 1, mFile ) != 1 || fflush( mFile ) != 0 || fsync( fileno( mFile ) ) != 0 )
+	{
+		printf( "Unable to append to the leaderboard!\n" );
+		return -1;
+	}
+
+	ScoreEntry logged;
+	decodeRecord( record, logged );
+	rankRun( logged );
+
+	return rank( logged.player );
+}
+
+bool Leaderboard::submitAll( const std::vector<ScoreEntry>& entries )
+{
+	if( mFile == NULL )
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> records( entries.size() * RECORD_SIZE );
+	for( size_t i = 0; i < entries.size(); ++i )
+	{
+		encodeRecord( entries[ i ], &records[ i * RECORD_SIZE ] );
+	}
+	if( fwrite( records.data(), RECORD_SIZE, entries.size(), mFile ) != entries.size() || fflush( mFile ) != 0 || fsync( fileno( mFile ) ) != 0 )
+	{
+		printf( "Unable to append to the leaderboard!\n" );
+		return false;
+	}
+
+	for( size_t i = 0; i < entries.size(); ++i )
+	{
+		ScoreEntry logged;
+		decodeRecord( &records[ i * RECORD_SIZE ], logged );
+		rankRun( logged );
+	}
+	return true;
+}
+
+int Leaderboard::rank( std::string player )
+{
+	std::unordered_map<std::string, int>::iterator best = mBest.find( player );
+	if( best == mBest.end() )
+	{
+		return -1;
+	}
+	return rankOf( best->second );
+}
+
+int Leaderboard::range( int first, int count, ScoreEntry* out )
+{
+	if( first < 0 )
+	{
+		count += first;
+		first = 0;
+	}
+
+	int copied = 0;
+	for( int i = first; i < first + count && i < sizeOf( mRoot ); ++i )
+	{
+		out[ copied++ ] = mNodes[ nodeAt( i ) ].entry;
+	}
+	return copied;
+}
+
+int Leaderboard::getPlayerCount()
+{
+	return sizeOf( mRoot );
+}
+
+int Leaderboard::getRunCount()
+{
+	return mRunCount;
+}
+
+int Leaderboard::getCorruptCount()
+{
+	return mCorruptCount;
+}
+
+void Leaderboard::rankRun( const ScoreEntry& entry )
+{
+	++mRunCount;
+
+	//Make a node for the run
+	int node;
+	if( mFreeNodes.empty() )
+	{
+		node = mNodes.size();
+		mNodes.push_back( RankNode() );
+	}
+	else
+	{
+		node = mFreeNodes.back();
+		mFreeNodes.pop_back();
+	}
+	mRandom ^= mRandom << 13;
+	mRandom ^= mRandom >> 17;
+	mRandom ^= mRandom << 5;
+	mNodes[ node ].entry = entry;
+	mNodes[ node ].priority = mRandom;
+	mNodes[ node ].left = -1;
+	mNodes[ node ].right = -1;
+	mNodes[ node ].size = 1;
+
+	//Only a player's best run is ranked
+	std::unordered_map<std::string, int>::iterator best = mBest.find( entry.player );
+	if( best != mBest.end() )
+	{
+		if( !ahead( node, best->second ) )
+		{
+			mFreeNodes.push_back( node );
+			return;
+		}
+		mRoot = erase( mRoot, best->second );
+		mFreeNodes.push_back( best->second );
+	}
+	mBest[ entry.player ] = node;
+
+	int left, right;
+	split( mRoot, node, left, right );
+	mRoot = merge( merge( left, node ), right );
+}
+
+bool Leaderboard::ahead( int a, int b )
+{
+	const ScoreEntry& first = mNodes[ a ].entry;
+	const ScoreEntry& second = mNodes[ b ].entry;
+	if( first.score != second.score )
+	{
+		return first.score > second.score;
+	}
+	if( first.timeMs != second.timeMs )
+	{
+		return first.timeMs < second.timeMs;
+	}
+	return first.player < second.player;
+}
+
+int Leaderboard::sizeOf( int node )
+{
+	return node < 0 ? 0 : mNodes[ node ].size;
+}
+
+void Leaderboard::update( int node )
+{
+	mNodes[ node ].size = 1 + sizeOf( mNodes[ node ].left ) + sizeOf( mNodes[ node ].right );
+}
+
+int Leaderboard::merge( int left, int right )
+{
+	if( left < 0 )
+	{
+		return right;
+	}
+	if( right < 0 )
+	{
+		return left;
+	}
+
+	if( mNodes[ left ].priority > mNodes[ right ].priority )
+	{
+		mNodes[ left ].right = merge( mNodes[ left ].right, right );
+		update( left );
+		return left;
+	}
+	mNodes[ right ].left = merge( left, mNodes[ right ].left );
+	update( right );
+	return right;
+}
+
+void Leaderboard::split( int tree, int node, int& left, int& right )
+{
+	//Left gets everything ranked ahead of node
+	if( tree < 0 )
+	{
+		left = -1;
+		right = -1;
+		return;
+	}
+
+	if( ahead( tree, node ) )
+	{
+		split( mNodes[ tree ].right, node, mNodes[ tree ].right, right );
+		left = tree;
+	}
+	else
+	{
+		split( mNodes[ tree ].left, node, left, mNodes[ tree ].left );
+		right = tree;
+	}
+	update( tree );
+}
+
+int Leaderboard::erase( int tree, int node )
+{
+	if( tree == node )
+	{
+		return merge( mNodes[ tree ].left, mNodes[ tree ].right );
+	}
+
+	if( ahead( node, tree ) )
+	{
+		mNodes[ tree ].left = erase( mNodes[ tree ].left, node );
+	}
+	else
+	{
+		mNodes[ tree ].right = erase( mNodes[ tree ].right, node );
+	}
+	update( tree );
+	return tree;
+}
+
+int Leaderboard::rankOf( int node )
+{
+	int rank = 0;
+	int tree = mRoot;
+	while( tree >= 0 )
+	{
+		if( tree == node )
+		{
+			return rank + sizeOf( mNodes[ tree ].left );
+		}
+
+		if( ahead( node, tree ) )
+		{
+			tree = mNodes[ tree ].left;
+		}
+		else
+		{
+			rank += sizeOf( mNodes[ tree ].left ) + 1;
+			tree = mNodes[ tree ].right;
+		}
+	}
+	return -1;
+}
+
+int Leaderboard::nodeAt( int rank )
+{
+	int tree = mRoot;
+	while( tree >= 0 )
+	{
+		int leftSize = sizeOf( mNodes[ tree ].left );
+		if( rank < leftSize )
+		{
+			tree = mNodes[ tree ].left;
+		}
+		else if( rank == leftSize )
+		{
+			return tree;
+		}
+		else
+		{
+			rank -= leftSize + 1;
+			tree = mNodes[ tree ].right;
+		}
+	}
+	return -1;
+}
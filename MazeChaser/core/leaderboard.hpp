@@ -0,0 +1,103 @@
+//Best runs per player, kept in an append-only log and ranked in memory
+#ifndef LEADERBOARD_HPP
+#define LEADERBOARD_HPP
+
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Longest player name kept in the log
+const int PLAYER_NAME_LENGTH = 16;
+
+//One completed run
+struct ScoreEntry
+{
+    std::string player;
+    int score;
+    int energy;
+
+    //Milliseconds the run took
+    unsigned int timeMs;
+};
+
+//Log file of a level
+std::string leaderboardPath( std::string level );
+
+class Leaderboard
+{
+    public:
+        //Initializes variables
+        Leaderboard();
+
+        //Closes the log
+        ~Leaderboard();
+
+        //Opens or creates the log and rebuilds the ranking from it, a torn record at the end is cut off and damaged ones are skipped,
+        //a file that is not a leaderboard is refused and left as it is
+        bool open( std::string path );
+
+        //Closes the log and forgets the ranking
+        void close();
+
+        //Appends a run to the log and returns its player's rank afterwards, -1 if it could not be written
+        int submit( const ScoreEntry& entry );
+
+        //Appends many runs with a single flush to disk, returns false if they could not be written
+        bool submitAll( const std::vector<ScoreEntry>& entries );
+
+        //Rank of a player's best run counting from 0, -1 if they have none
+        int rank( std::string player );
+
+        //Copies up to count best runs starting at rank first and returns how many were copied
+        int range( int first, int count, ScoreEntry* out );
+
+        //Players ranked and runs in the log
+        int getPlayerCount();
+        int getRunCount();
+
+        //Records skipped as damaged when the log was opened
+        int getCorruptCount();
+
+    private:
+        //A player's best run in the rank tree, ordered by score and then time
+        struct RankNode
+        {
+            ScoreEntry entry;
+            unsigned int priority;
+            int left, right;
+
+            //Nodes in this subtree
+            int size;
+        };
+
+        //Adds a run to the ranking without logging it
+        void rankRun( const ScoreEntry& entry );
+
+        //Tree helpers, every one of them O(log n) on average
+        bool ahead( int a, int b );
+        int sizeOf( int node );
+        void update( int node );
+        int merge( int left, int right );
+        void split( int tree, int node, int& left, int& right );
+        int erase( int tree, int node );
+        int rankOf( int node );
+        int nodeAt( int rank );
+
+        //The log being appended to
+        FILE* mFile;
+
+        //Tree nodes, unused ones and the root
+        std::vector<RankNode> mNodes;
+        std::vector<int> mFreeNodes;
+        int mRoot;
+
+        //Node holding each player's best run
+        std::unordered_map<std::string, int> mBest;
+
+        int mRunCount;
+        int mCorruptCount;
+        unsigned int mRandom;
+};
+
+#endif
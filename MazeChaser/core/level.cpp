@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <string.h>
+#include "level.hpp"
+
+bool loadLevel( std::string path, Level& level )
+{
+	FILE* file = fopen( path.c_str(), "r" );
+	if( file == NULL )
+	{
+		printf( "Unable to open level %s!\n", path.c_str() );
+		return false;
+	}
+
+	level.width = 0;
+	level.height = 0;
+	level.walls.clear();
+
+	bool success = true;
+	char line[ 256 ];
+	int lineNumber = 0;
+	while( success && fgets( line, sizeof( line ), file ) != NULL )
+	{
+		++lineNumber;
+
+		//Drop the comment
+		char* comment = strchr( line, '#' );
+		if( comment != NULL )
+		{
+			*comment = '\0';
+		}
+
+		char keyword[ 16 ];
+		if( sscanf( line, "%15s", keyword ) != 1 )
+		{
+			continue;
+		}
+
+		LevelRect wall;
+		if( strcmp( keyword, "size" ) == 0 && sscanf( line, "%*s %d %d", &level.width, &level.height ) == 2 )
+		{
+			continue;
+		}
+		if( strcmp( keyword, "wall" ) == 0 && sscanf( line, "%*s %d %d %d %d", &wall.x, &wall.y, &wall.w, &wall.h ) == 4 && wall.w > 0 && wall.h > 0 )
+		{
+			level.walls.push_back( wall );
+			continue;
+		}
+
+		printf( "%s:%d: not a level line\n", path.c_str(), lineNumber );
+		success = false;
+	}
+	fclose( file );
+
+	if( success && ( level.width <= 0 || level.height <= 0 ) )
+	{
+		printf( "%s has no size!\n", path.c_str() );
+		success = false;
+	}
+
+	return success;
+}
+
+bool saveLevel( std::string path, const Level& level, std::string comment )
+{
+	FILE* file = fopen( path.c_str(), "w" );
+	if( file == NULL )
+	{
+		printf( "Unable to write level %s!\n", path.c_str() );
+		return false;
+	}
+
+	if( comment.size() > 0 )
+	{
+		fprintf( file, "#%s\n", comment.c_str() );
+	}
+	fprintf( file, "size %d %d\n", level.width, level.height );
+	for( size_t i = 0; i < level.walls.size(); ++i )
+	{
+		const LevelRect& wall = level.walls[ i ];
+		fprintf( file, "wall %d %d %d %d\n", wall.x, wall.y, wall.w, wall.h );
+	}
+
+	bool success = fclose( file ) == 0;
+	if( !success )
+	{
+		printf( "Unable to write level %s!\n", path.c_str() );
+	}
+	return success;
+}
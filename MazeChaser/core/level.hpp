@@ -0,0 +1,30 @@
+//Walls of a level and the text file they are kept in
+#ifndef LEVEL_HPP
+#define LEVEL_HPP
+
+#include <string>
+#include <vector>
+
+//A wall in level pixels
+struct LevelRect
+{
+    int x, y;
+    int w, h;
+};
+
+struct Level
+{
+    //Level size in pixels
+    int width;
+    int height;
+
+    std::vector<LevelRect> walls;
+};
+
+//Reads a level, lines are "size <w> <h>" or "wall <x> <y> <w> <h>" and # starts a comment
+bool loadLevel( std::string path, Level& level );
+
+//Writes a level, the comment goes at the top
+bool saveLevel( std::string path, const Level& level, std::string comment );
+
+#endif
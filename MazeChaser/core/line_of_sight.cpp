@@ -0,0 +1,94 @@
+#include "line_of_sight.hpp"
+
+//Cell holding a pixel, rounding towards negative infinity
+static int cellOf( int pixel, int cellSize )
+{
+	return pixel < 0 ? -( ( -pixel + cellSize - 1 ) / cellSize ) : pixel / cellSize;
+}
+
+bool lineOfSight( CollisionGrid& grid, int x0, int y0, int x1, int y1 )
+{
+	int cellSize = grid.getCellSize();
+	int column = cellOf( x0, cellSize );
+	int row = cellOf( y0, cellSize );
+	int endColumn = cellOf( x1, cellSize );
+	int endRow = cellOf( y1, cellSize );
+
+	int stepX = x1 > x0 ? 1 : ( x1 < x0 ? -1 : 0 );
+	int stepY = y1 > y0 ? 1 : ( y1 < y0 ? -1 : 0 );
+	int64_t lengthX = stepX * (int64_t)( x1 - x0 );
+	int64_t lengthY = stepY * (int64_t)( y1 - y0 );
+
+	//How far along the line the next column and row boundaries are, both scaled by lengthX * lengthY to stay in integers
+	int64_t boundaryX = stepX > 0 ? ( column + 1 ) * cellSize - x0 : x0 - column * cellSize;
+	int64_t boundaryY = stepY > 0 ? ( row + 1 ) * cellSize - y0 : y0 - row * cellSize;
+	int64_t nextX = boundaryX * lengthY;
+	int64_t nextY = boundaryY * lengthX;
+	int64_t deltaX = cellSize * lengthY;
+	int64_t deltaY = cellSize * lengthX;
+
+	//Walk every cell the line passes through
+	int steps = ( endColumn - column ) * stepX + ( endRow - row ) * stepY;
+	for( int i = 0; i <= steps; ++i )
+	{
+		if( grid.isSolid( column, row ) )
+		{
+			return false;
+		}
+		if( column == endColumn && row == endRow )
+		{
+			break;
+		}
+
+		if( stepY == 0 || ( stepX != 0 && nextX < nextY ) )
+		{
+			column += stepX;
+			nextX += deltaX;
+		}
+		else if( stepX == 0 || nextY < nextX )
+		{
+			row += stepY;
+			nextY += deltaY;
+		}
+		else
+		{
+			//Exactly through a corner, both cells beside it have to be open
+			if( grid.isSolid( column + stepX, row ) || grid.isSolid( column, row + stepY ) )
+			{
+				return false;
+			}
+			column += stepX;
+			row += stepY;
+			nextX += deltaX;
+			nextY += deltaY;
+			++i;
+		}
+	}
+	return true;
+}
+
+int castRays( CollisionGrid& grid, const SightRay* rays, int count, uint8_t* visible )
+{
+	int clear = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		visible[ i ] = lineOfSight( grid, rays[ i ].x0, rays[ i ].y0, rays[ i ].x1, rays[ i ].y1 );
+		clear += visible[ i ];
+	}
+	return clear;
+}
+
+int castRaysTo( CollisionGrid& grid, int targetX, int targetY, const int* x, const int* y, int count, int range, uint8_t* visible )
+{
+	int64_t rangeSquared = (int64_t)range * range;
+	int clear = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		//Only points in range pay for a walk
+		int64_t dx = x[ i ] - targetX;
+		int64_t dy = y[ i ] - targetY;
+		visible[ i ] = dx * dx + dy * dy <= rangeSquared && lineOfSight( grid, x[ i ], y[ i ], targetX, targetY );
+		clear += visible[ i ];
+	}
+	return clear;
+}
@@ -0,0 +1,24 @@
+//Sight lines walked cell by cell through a collision grid
+#ifndef LINE_OF_SIGHT_HPP
+#define LINE_OF_SIGHT_HPP
+
+#include <stdint.h>
+#include "collision_grid.hpp"
+
+//A sight line between two points in pixels
+struct SightRay
+{
+    int x0, y0;
+    int x1, y1;
+};
+
+//Whether no solid cell lies between the two points, a line squeezing between two cells that meet at a corner is blocked
+bool lineOfSight( CollisionGrid& grid, int x0, int y0, int x1, int y1 );
+
+//Tests every ray and sets visible[ i ] to whether ray i is clear, returns how many are
+int castRays( CollisionGrid& grid, const SightRay* rays, int count, uint8_t* visible );
+
+//Tests the lines from count points to one target, points further than range pixels are not visible, returns how many are
+int castRaysTo( CollisionGrid& grid, int targetX, int targetY, const int* x, const int* y, int count, int range, uint8_t* visible );
+
+#endif
@@ -0,0 +1,78 @@
+#include "match.hpp"
+
+void resetMatch( Match& match )
+{
+	match.phase = PHASE_MENU;
+	match.phaseTicks = 0;
+	match.round = 0;
+}
+
+bool updateMatch( Match& match, MatchEvent event )
+{
+	MatchPhase next = match.phase;
+
+	if( event == MATCH_RESET )
+	{
+		next = PHASE_MENU;
+	}
+	else
+	{
+		switch( match.phase )
+		{
+			case PHASE_MENU:
+			case PHASE_RESULTS:
+			if( event == MATCH_START )
+			{
+				next = PHASE_COUNTDOWN;
+			}
+			break;
+
+			case PHASE_COUNTDOWN:
+			if( match.phaseTicks >= COUNTDOWN_TICKS )
+			{
+				next = PHASE_PLAYING;
+			}
+			break;
+
+			case PHASE_PLAYING:
+			if( event == MATCH_WIN )
+			{
+				next = PHASE_WON;
+			}
+			else if( event == MATCH_LOSE )
+			{
+				next = PHASE_LOST;
+			}
+			break;
+
+			case PHASE_WON:
+			case PHASE_LOST:
+			if( match.phaseTicks >= OUTCOME_TICKS )
+			{
+				next = PHASE_RESULTS;
+			}
+			break;
+		}
+	}
+
+	//Stay put and keep counting
+	if( next == match.phase )
+	{
+		++match.phaseTicks;
+		return false;
+	}
+
+	if( next == PHASE_COUNTDOWN )
+	{
+		++match.round;
+	}
+	match.phase = next;
+	match.phaseTicks = 0;
+
+	return true;
+}
+
+int countdownSeconds( const Match& match )
+{
+	return ( COUNTDOWN_TICKS - match.phaseTicks + TICKS_PER_SECOND - 1 ) / TICKS_PER_SECOND;
+}
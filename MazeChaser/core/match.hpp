@@ -0,0 +1,67 @@
+//Phases a round goes through, advanced one tick at a time so nothing ever blocks the loop
+#ifndef MATCH_HPP
+#define MATCH_HPP
+
+//Simulation ticks per second
+const int TICKS_PER_SECOND = 60;
+
+//How long the timed phases last
+const int COUNTDOWN_TICKS = 3 * TICKS_PER_SECOND;
+const int OUTCOME_TICKS = 3 * TICKS_PER_SECOND;
+const int RESULTS_TICKS = 5 * TICKS_PER_SECOND;
+
+enum MatchPhase
+{
+    //Waiting for someone to start the first round
+    PHASE_MENU,
+
+    //Dots are placed but frozen
+    PHASE_COUNTDOWN,
+
+    PHASE_PLAYING,
+
+    //The round just ended, the banner is up
+    PHASE_WON,
+    PHASE_LOST,
+
+    //Scores of the finished round
+    PHASE_RESULTS
+};
+
+//What the game asks of the match on a tick
+enum MatchEvent
+{
+    MATCH_NONE,
+
+    //Begin a round from the menu or the results
+    MATCH_START,
+
+    //End the round being played
+    MATCH_WIN,
+    MATCH_LOSE,
+
+    //Drop back to the menu from anywhere
+    MATCH_RESET
+};
+
+struct Match
+{
+    MatchPhase phase;
+
+    //Ticks spent in the current phase
+    int phaseTicks;
+
+    //Rounds started so far
+    int round;
+};
+
+//Puts the match in the menu before the first round
+void resetMatch( Match& match );
+
+//Advances the match by one tick, returns true if it entered a new phase
+bool updateMatch( Match& match, MatchEvent event );
+
+//Whole seconds left on the countdown, rounded up
+int countdownSeconds( const Match& match );
+
+#endif
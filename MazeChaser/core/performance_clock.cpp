@@ -0,0 +1,13 @@
+#include "performance_clock.hpp"
+
+PerformanceClock::PerformanceClock()
+{
+	mFrequency = SDL_GetPerformanceFrequency();
+}
+
+uint64_t PerformanceClock::nowMicros()
+{
+	//Whole seconds and the rest apart, a nanosecond counter times a million would overflow
+	Uint64 counter = SDL_GetPerformanceCounter();
+	return counter / mFrequency * 1000000 + counter % mFrequency * 1000000 / mFrequency;
+}
@@ -0,0 +1,21 @@
+//Live time from SDL's high resolution performance counter
+#ifndef PERFORMANCE_CLOCK_HPP
+#define PERFORMANCE_CLOCK_HPP
+
+#include <SDL2/SDL.h>
+#include "clock.hpp"
+
+class PerformanceClock : public Clock
+{
+    public:
+        //Reads the counter's frequency
+        PerformanceClock();
+
+        //Microseconds since the counter's own starting point
+        uint64_t nowMicros();
+
+    private:
+        Uint64 mFrequency;
+};
+
+#endif
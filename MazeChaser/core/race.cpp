@@ -0,0 +1,91 @@
+#include "match.hpp"
+#include "race.hpp"
+#include "state_hash.hpp"
+
+void resetRace( RaceState& state )
+{
+	state.tick = 0;
+	for( int i = 0; i < RACE_PLAYERS; ++i )
+	{
+		Racer& racer = state.racers[ i ];
+		racer.x = RACER_START_X;
+		racer.y = RACER_START_Y;
+		racer.velX = 0;
+		racer.velY = 0;
+		resetStats( racer.stats );
+	}
+}
+
+void stepRace( RaceState& state, const uint8_t* buttons, CollisionGrid& walls, int levelWidth, int levelHeight )
+{
+	state.tick++;
+	if( state.tick <= COUNTDOWN_TICKS )
+	{
+		return;
+	}
+
+	//The race clock starts when the countdown ends
+	unsigned int elapsedMs = ( state.tick - COUNTDOWN_TICKS - 1 ) * 1000 / TICKS_PER_SECOND;
+	for( int i = 0; i < RACE_PLAYERS; ++i )
+	{
+		Racer& racer = state.racers[ i ];
+		if( racer.stats.outcome != OUTCOME_NONE )
+		{
+			continue;
+		}
+
+		//Hold each direction at full speed
+		racer.velX = 0;
+		racer.velY = 0;
+		if( buttons[ i ] & INPUT_UP ) racer.velY -= RACER_VEL;
+		if( buttons[ i ] & INPUT_DOWN ) racer.velY += RACER_VEL;
+		if( buttons[ i ] & INPUT_LEFT ) racer.velX -= RACER_VEL;
+		if( buttons[ i ] & INPUT_RIGHT ) racer.velX += RACER_VEL;
+
+		//Same rules as a dot on the server, a wall undoes the whole step
+		racer.x += racer.velX;
+		racer.y += racer.velY;
+		bool hit = walls.hits( racer.x, racer.y, RACER_SIZE, RACER_SIZE );
+		if( racer.x < 0 || racer.x + RACER_SIZE > levelWidth || hit )
+		{
+			racer.x -= racer.velX;
+		}
+		if( racer.y < 0 || racer.y + RACER_SIZE > levelHeight || hit )
+		{
+			racer.y -= racer.velY;
+		}
+
+		applyZones( racer.stats, racer.x, racer.y, racer.velX, racer.velY, elapsedMs );
+		checkOutcome( racer.stats, racer.x, racer.y );
+	}
+}
+
+bool raceOver( const RaceState& state )
+{
+	for( int i = 0; i < RACE_PLAYERS; ++i )
+	{
+		if( state.racers[ i ].stats.outcome == OUTCOME_NONE )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t hashRace( const RaceState& state )
+{
+	uint32_t hash = hashValue( HASH_SEED, state.tick );
+	for( int i = 0; i < RACE_PLAYERS; ++i )
+	{
+		const Racer& racer = state.racers[ i ];
+		hash = hashValue( hash, racer.x );
+		hash = hashValue( hash, racer.y );
+		hash = hashValue( hash, racer.velX );
+		hash = hashValue( hash, racer.velY );
+		hash = hashValue( hash, racer.stats.score );
+		hash = hashValue( hash, racer.stats.energy );
+		hash = hashValue( hash, racer.stats.energyBonus );
+		hash = hashValue( hash, racer.stats.outcome );
+	}
+	return hash;
+}
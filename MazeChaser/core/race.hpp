@@ -0,0 +1,56 @@
+//A head to head race simulated from nothing but each tick's held keys, so every peer can run it
+#ifndef RACE_HPP
+#define RACE_HPP
+
+#include <stdint.h>
+#include "collision_grid.hpp"
+#include "rules.hpp"
+
+//Dots in a race
+const int RACE_PLAYERS = 2;
+
+//Size and speed of a racing dot, and where it starts
+const int RACER_SIZE = 20;
+const int RACER_VEL = 15;
+const int RACER_START_X = 10496;
+const int RACER_START_Y = 32;
+
+//Direction keys held by a player, one bit each
+enum InputButton
+{
+    INPUT_UP = 1,
+    INPUT_DOWN = 2,
+    INPUT_LEFT = 4,
+    INPUT_RIGHT = 8
+};
+
+//One dot of the race
+struct Racer
+{
+    int x, y;
+    int velX, velY;
+    PlayerStats stats;
+};
+
+//Everything a race tick changes, plain data so it is saved and restored by copying
+struct RaceState
+{
+    //Ticks simulated, the first COUNTDOWN_TICKS of them hold everyone at the start
+    int tick;
+
+    Racer racers[ RACE_PLAYERS ];
+};
+
+//Puts both dots at the start with the countdown about to run
+void resetRace( RaceState& state );
+
+//Simulates one tick with the keys each player held, a dot that finished stays put
+void stepRace( RaceState& state, const uint8_t* buttons, CollisionGrid& walls, int levelWidth, int levelHeight );
+
+//Whether every dot has finished
+bool raceOver( const RaceState& state );
+
+//Hash of everything a tick changes, equal on two peers only while their races agree
+uint32_t hashRace( const RaceState& state );
+
+#endif
@@ -0,0 +1,119 @@
+#include <stddef.h>
+#include "rules.hpp"
+
+//A strip that counts when a dot crosses it at speed along one axis
+struct Zone
+{
+	int left, top, right, bottom;
+	bool horizontal;
+	int score;
+	int energy;
+};
+
+//An area bounded on all four sides
+struct Area
+{
+	int left, top, right, bottom;
+};
+
+//Slowest a dot can cross a zone and still trigger it
+static const int ZONE_MIN_SPEED = 5;
+
+static const Zone ZONES[] =
+{
+	{ 7840, 1152, 7872, 1216, true, -50, 20 },
+	{ 7104, 2848, 7168, 2912, false, -30, 20 },
+	{ 11040, 576, 11104, 608, false, -30, 20 },
+	{ 10528, 3072, 10560, 3136, true, -30, 20 },
+	{ 3392, 2720, 3456, 2752, false, -30, 20 },
+	{ 1664, 512, 1728, 544, false, -30, 20 },
+	{ 1120, 3776, 1184, 3808, false, -30, 20 },
+	{ 1344, 5440, 1376, 5504, true, -30, 20 },
+	{ 8096, 2176, 8128, 2240, true, 50, 0 },
+	{ 6464, 1664, 6528, 1696, false, 50, 0 },
+	{ 12160, 1536, 12224, 1568, false, 50, 0 },
+	{ 3456, 4000, 3488, 4064, true, 50, 0 },
+	{ 640, 5312, 704, 5344, false, 50, 0 },
+	{ 2688, 2976, 2752, 3008, false, 50, 0 },
+	{ 3584, 640, 3648, 672, false, 50, 0 }
+};
+
+//Areas where energy does not drain
+static const Area SAFE_AREAS[] =
+{
+	{ 9024, 1152, 9344, 1216 },
+	{ 11104, 288, 11168, 608 },
+	{ 12480, 1152, 12800, 1216 },
+	{ 11424, 2176, 11744, 2240 },
+	{ 12512, 4000, 12832, 4064 },
+	{ 6368, 4064, 6688, 4128 },
+	{ 5952, 704, 6016, 1024 },
+	{ 7936, 2080, 8000, 2400 },
+	{ 2976, 2112, 3296, 2176 },
+	{ 768, 4000, 832, 4320 }
+};
+
+//Where the round is won
+static const Area GOAL = { 3328, 2400, 3360, 2528 };
+
+static bool inside( int left, int top, int right, int bottom, int x, int y )
+{
+	return x > left && y > top && x < right && y < bottom;
+}
+
+void resetStats( PlayerStats& stats )
+{
+	stats.score = START_SCORE;
+	stats.energy = START_ENERGY;
+	stats.energyBonus = 0;
+	stats.outcome = OUTCOME_NONE;
+}
+
+int applyZones( PlayerStats& stats, int x, int y, int velX, int velY, unsigned int elapsedMs )
+{
+	int flags = 0;
+
+	//Zones only count when crossed at speed
+	for( size_t i = 0; i < sizeof( ZONES ) / sizeof( ZONES[ 0 ] ); ++i )
+	{
+		const Zone& zone = ZONES[ i ];
+		int speed = zone.horizontal ? velX : velY;
+		if( inside( zone.left, zone.top, zone.right, zone.bottom, x, y ) && ( speed > ZONE_MIN_SPEED || speed < -ZONE_MIN_SPEED ) )
+		{
+			stats.score += zone.score;
+			stats.energyBonus += zone.energy;
+			flags |= zone.energy > 0 ? ZONE_ENERGY : ZONE_SCORE;
+		}
+	}
+
+	//Energy drains with time everywhere but the safe areas
+	for( size_t i = 0; i < sizeof( SAFE_AREAS ) / sizeof( SAFE_AREAS[ 0 ] ); ++i )
+	{
+		const Area& area = SAFE_AREAS[ i ];
+		if( inside( area.left, area.top, area.right, area.bottom, x, y ) )
+		{
+			return flags | ZONE_SAFE;
+		}
+	}
+	//Worked in hundredths of a point and truncated toward zero, with no float for two machines to round apart
+	stats.energy = ( ( START_ENERGY + stats.energyBonus ) * ENERGY_DRAIN_MS - (int)elapsedMs ) / ENERGY_DRAIN_MS;
+
+	return flags;
+}
+
+Outcome checkOutcome( PlayerStats& stats, int x, int y )
+{
+	if( stats.outcome == OUTCOME_NONE )
+	{
+		if( inside( GOAL.left, GOAL.top, GOAL.right, GOAL.bottom, x, y ) && stats.score > 0 && stats.energy > 0 )
+		{
+			stats.outcome = OUTCOME_WON;
+		}
+		else if( stats.score < 0 || stats.energy <= 0 )
+		{
+			stats.outcome = OUTCOME_LOST;
+		}
+	}
+
+	return stats.outcome;
+}
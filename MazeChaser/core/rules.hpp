@@ -0,0 +1,54 @@
+//Scoring zones of the campus map and the rules a round is decided by
+#ifndef RULES_HPP
+#define RULES_HPP
+
+//Values every round starts with
+const int START_SCORE = 300;
+const int START_ENERGY = 300;
+
+//Milliseconds for one point of energy to drain, kept in whole numbers so every machine drains alike
+const int ENERGY_DRAIN_MS = 100;
+
+//What the zones under a dot did during one step, one bit each
+enum ZoneFlag
+{
+    //Traded score for energy
+    ZONE_ENERGY = 1,
+
+    //Picked up score
+    ZONE_SCORE = 2,
+
+    //Energy is not draining
+    ZONE_SAFE = 4
+};
+
+//How a player's round ended
+enum Outcome
+{
+    OUTCOME_NONE,
+    OUTCOME_WON,
+    OUTCOME_LOST
+};
+
+//Score and energy of one player
+struct PlayerStats
+{
+    int score;
+    int energy;
+
+    //Energy bought in the energy zones
+    int energyBonus;
+
+    Outcome outcome;
+};
+
+//Puts a player back to the start of a round
+void resetStats( PlayerStats& stats );
+
+//Applies the zones under a dot at ( x, y ) moving at ( velX, velY ), elapsedMs into the round, and returns the ZoneFlags hit
+int applyZones( PlayerStats& stats, int x, int y, int velX, int velY, unsigned int elapsedMs );
+
+//Settles the outcome once the dot reached the goal or ran out, returns OUTCOME_NONE while the round goes on
+Outcome checkOutcome( PlayerStats& stats, int x, int y );
+
+#endif
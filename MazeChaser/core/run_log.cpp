@@ -0,0 +1,297 @@
+#include <string.h>
+#include <unistd.h>
+#include "entity_store.hpp"
+#include "run_log.hpp"
+
+//First bytes of every run log, the last one is the record version
+static const unsigned char RUN_HEADER[ 8 ] = { 'M', 'C', 'R', 'N', 0, 0, 0, 3 };
+
+//Name, score, energy, time, round, chasers and ticks, then two ticks of keys a byte and a checksum
+static const int RUN_FIXED_SIZE = PLAYER_NAME_LENGTH + 4 + 4 + 4 + 4 + 4 + 4;
+
+//Where the ticks are counted in a record
+static const int RUN_TICKS_OFFSET = PLAYER_NAME_LENGTH + 20;
+
+static void putInt( uint32_t n, unsigned char* out )
+{
+	out[ 0 ] = n & 0xff;
+	out[ 1 ] = ( n >> 8 ) & 0xff;
+	out[ 2 ] = ( n >> 16 ) & 0xff;
+	out[ 3 ] = ( n >> 24 ) & 0xff;
+}
+
+static uint32_t getInt( const unsigned char* in )
+{
+	return in[ 0 ] | ( in[ 1 ] << 8 ) | ( in[ 2 ] << 16 ) | ( (uint32_t)in[ 3 ] << 24 );
+}
+
+//FNV-1a, enough to spot a record torn by a crash
+static uint32_t checksum( const unsigned char* data, int length )
+{
+	uint32_t hash = 2166136261u;
+	for( int i = 0; i < length; ++i )
+	{
+		hash = ( hash ^ data[ i ] ) * 16777619u;
+	}
+	return hash;
+}
+
+std::string runLogPath( std::string level )
+{
+	return level + ".runs";
+}
+
+uint8_t velocityButtons( int velX, int velY )
+{
+	uint8_t buttons = 0;
+	if( velY < 0 ) buttons |= INPUT_UP;
+	if( velY > 0 ) buttons |= INPUT_DOWN;
+	if( velX < 0 ) buttons |= INPUT_LEFT;
+	if( velX > 0 ) buttons |= INPUT_RIGHT;
+	return buttons;
+}
+
+FILE* openRunLog( std::string path )
+{
+	FILE* file = fopen( path.c_str(), "ab" );
+	if( file == NULL )
+	{
+		printf( "Unable to open run log %s!\n", path.c_str() );
+		return NULL;
+	}
+
+	//A new log starts with its header
+	if( ftell( file ) == 0 && ( fwrite( RUN_HEADER, 1, sizeof( RUN_HEADER ), file ) != sizeof( RUN_HEADER ) || fflush( file ) != 0 ) )
+	{
+		printf( "Unable to write run log %s!\n", path.c_str() );
+		fclose( file );
+		return NULL;
+	}
+	return file;
+}
+
+bool appendRun( FILE* file, const RunLog& run )
+{
+	int ticks = run.buttons.size();
+	if( ticks > RUN_MAX_TICKS || run.chasers < 0 || run.chasers > RUN_MAX_CHASERS || run.round < 1 || run.round > RUN_MAX_ROUNDS )
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> record( RUN_FIXED_SIZE + ( ticks + 1 ) / 2 + 4, 0 );
+	memcpy( &record[ 0 ], run.claim.player.c_str(), run.claim.player.size() < (size_t)PLAYER_NAME_LENGTH ? run.claim.player.size() : PLAYER_NAME_LENGTH );
+	putInt( (uint32_t)run.claim.score, &record[ PLAYER_NAME_LENGTH ] );
+	putInt( (uint32_t)run.claim.energy, &record[ PLAYER_NAME_LENGTH + 4 ] );
+	putInt( run.claim.timeMs, &record[ PLAYER_NAME_LENGTH + 8 ] );
+	putInt( (uint32_t)run.round, &record[ PLAYER_NAME_LENGTH + 12 ] );
+	putInt( (uint32_t)run.chasers, &record[ PLAYER_NAME_LENGTH + 16 ] );
+	putInt( (uint32_t)ticks, &record[ RUN_TICKS_OFFSET ] );
+	for( int tick = 0; tick < ticks; ++tick )
+	{
+		record[ RUN_FIXED_SIZE + tick / 2 ] |= ( run.buttons[ tick ] & 0xf ) << ( tick % 2 * 4 );
+	}
+	putInt( checksum( &record[ 0 ], record.size() - 4 ), &record[ record.size() - 4 ] );
+
+	//Whole runs only, a kiosk that crashes mid-write leaves a torn record that readers stop at
+	if( fwrite( &record[ 0 ], record.size(), 1, file ) != 1 || fflush( file ) != 0 || fsync( fileno( file ) ) != 0 )
+	{
+		printf( "Unable to append to the run log!\n" );
+		return false;
+	}
+	return true;
+}
+
+FILE* readRunLog( std::string path )
+{
+	FILE* file = fopen( path.c_str(), "rb" );
+	if( file == NULL )
+	{
+		printf( "Unable to open run log %s!\n", path.c_str() );
+		return NULL;
+	}
+
+	unsigned char header[ sizeof( RUN_HEADER ) ];
+	if( fread( header, 1, sizeof( header ), file ) != sizeof( header ) || memcmp( header, RUN_HEADER, sizeof( header ) ) != 0 )
+	{
+		printf( "%s is not a run log!\n", path.c_str() );
+		fclose( file );
+		return NULL;
+	}
+	return file;
+}
+
+//What readRecord found
+enum RecordRead
+{
+	RECORD_RUN,
+
+	//Cut short by the end of the file, it may still be being written
+	RECORD_PARTIAL,
+
+	//Whole, but its length or checksum is wrong
+	RECORD_DAMAGED
+};
+
+//Reads the record at the file position, length is how long it says it is or 0 if that is wrong or not there yet
+static RecordRead readRecord( FILE* file, RunLog& run, long& length )
+{
+	length = 0;
+	unsigned char fixed[ RUN_FIXED_SIZE ];
+	if( fread( fixed, RUN_FIXED_SIZE, 1, file ) != 1 )
+	{
+		return RECORD_PARTIAL;
+	}
+	int ticks = (int)getInt( fixed + RUN_TICKS_OFFSET );
+	if( ticks < 0 || ticks > RUN_MAX_TICKS )
+	{
+		return RECORD_DAMAGED;
+	}
+
+	std::vector<unsigned char> record( RUN_FIXED_SIZE + ( ticks + 1 ) / 2 + 4 );
+	memcpy( &record[ 0 ], fixed, RUN_FIXED_SIZE );
+	length = record.size();
+	if( fread( &record[ RUN_FIXED_SIZE ], record.size() - RUN_FIXED_SIZE, 1, file ) != 1 )
+	{
+		return RECORD_PARTIAL;
+	}
+	if( getInt( &record[ record.size() - 4 ] ) != checksum( &record[ 0 ], record.size() - 4 ) )
+	{
+		return RECORD_DAMAGED;
+	}
+
+	run.claim.player.assign( (const char*)&record[ 0 ], strnlen( (const char*)&record[ 0 ], PLAYER_NAME_LENGTH ) );
+	run.claim.score = (int)getInt( &record[ PLAYER_NAME_LENGTH ] );
+	run.claim.energy = (int)getInt( &record[ PLAYER_NAME_LENGTH + 4 ] );
+	run.claim.timeMs = getInt( &record[ PLAYER_NAME_LENGTH + 8 ] );
+	run.round = (int)getInt( &record[ PLAYER_NAME_LENGTH + 12 ] );
+	run.chasers = (int)getInt( &record[ PLAYER_NAME_LENGTH + 16 ] );
+	run.buttons.resize( ticks );
+	for( int tick = 0; tick < ticks; ++tick )
+	{
+		run.buttons[ tick ] = ( record[ RUN_FIXED_SIZE + tick / 2 ] >> ( tick % 2 * 4 ) ) & 0xf;
+	}
+	return RECORD_RUN;
+}
+
+bool readRun( FILE* file, RunLog& run, int& damaged )
+{
+	long start = ftell( file );
+	long length = 0;
+	RecordRead read = readRecord( file, run, length );
+	if( read == RECORD_DAMAGED )
+	{
+		++damaged;
+		long damagedAt = start;
+
+		//Most damage leaves the record's length alone, so try the next record first
+		if( length > 0 )
+		{
+			start += length;
+			clearerr( file );
+			fseek( file, start, SEEK_SET );
+			read = readRecord( file, run, length );
+		}
+
+		//Otherwise a crash tore it and new runs were appended after it, look a byte at a time for where one starts,
+		//passing over bytes that only look like a record running past the end
+		if( read != RECORD_RUN )
+		{
+			long waitAt = -1;
+			for( start = damagedAt + 1; ; ++start )
+			{
+				clearerr( file );
+				fseek( file, start, SEEK_SET );
+				read = readRecord( file, run, length );
+				if( read == RECORD_PARTIAL && waitAt < 0 )
+				{
+					waitAt = start;
+				}
+				if( read == RECORD_RUN || ( read == RECORD_PARTIAL && length == 0 ) )
+				{
+					break;
+				}
+			}
+			if( read == RECORD_PARTIAL )
+			{
+				start = waitAt;
+			}
+		}
+	}
+
+	//A partial record is left where it is, so a reader following the log can try again once it is whole
+	if( read == RECORD_PARTIAL )
+	{
+		clearerr( file );
+		fseek( file, start, SEEK_SET );
+		return false;
+	}
+	return true;
+}
+
+void sweepSpawns( FlowField& spawns )
+{
+	spawns.sweepAll( ( RUN_START_X + RUN_DOT_SIZE / 2 ) / spawns.getCellSize(), ( RUN_START_Y + RUN_DOT_SIZE / 2 ) / spawns.getCellSize() );
+}
+
+void startChasers( FlowField& spawns, Swarm& swarm, int chasers, int round )
+{
+	swarm.spawn( spawns, chasers, CHASER_SPAWN_DISTANCE, round );
+}
+
+RunVerdict verifyRun( const RunLog& run, int chasers, CollisionGrid& walls, int levelWidth, int levelHeight, FlowField& spawns, FlowField& field, Swarm& swarm )
+{
+	//Fewer chasers make an easier run, and only the rounds a session deals are played
+	if( run.chasers != chasers || run.round < 1 || run.round > RUN_MAX_ROUNDS )
+	{
+		return RUN_WRONG_ROUND;
+	}
+
+	//The dot and the chasers as a round starts, the same boxes the game moves
+	Transform position = { RUN_START_X, RUN_START_Y };
+	Collider collider = { RUN_DOT_SIZE, RUN_DOT_SIZE };
+	PlayerStats stats;
+	resetStats( stats );
+	startChasers( spawns, swarm, run.chasers, run.round );
+
+	//Each playing tick moves, applies the zones and settles the outcome in the game's order
+	int ticks = run.buttons.size();
+	for( int tick = 0; tick < ticks; ++tick )
+	{
+		Velocity velocity = { 0, 0 };
+		if( run.buttons[ tick ] & INPUT_UP ) velocity.y -= RUN_DOT_VEL;
+		if( run.buttons[ tick ] & INPUT_DOWN ) velocity.y += RUN_DOT_VEL;
+		if( run.buttons[ tick ] & INPUT_LEFT ) velocity.x -= RUN_DOT_VEL;
+		if( run.buttons[ tick ] & INPUT_RIGHT ) velocity.x += RUN_DOT_VEL;
+		moveBox( position, velocity, collider, walls, levelWidth, levelHeight );
+
+		//The chasers that see the dot's centre head for it, as in the game
+		int centreX = position.x + RUN_DOT_SIZE / 2;
+		int centreY = position.y + RUN_DOT_SIZE / 2;
+		swarm.look( walls, centreX, centreY, CHASER_SIGHT );
+		swarm.chase( field, centreX, centreY );
+
+		unsigned int elapsedMs = tick * 1000 / TICKS_PER_SECOND;
+		applyZones( stats, position.x, position.y, velocity.x, velocity.y, elapsedMs );
+		Outcome outcome = checkOutcome( stats, position.x, position.y );
+		if( outcome == OUTCOME_NONE )
+		{
+			if( swarm.touching( position.x, position.y, RUN_DOT_SIZE, RUN_DOT_SIZE ) > 0 )
+			{
+				return RUN_CAUGHT;
+			}
+			continue;
+		}
+
+		//The round ends on its last tick, and only a win is ranked
+		if( outcome != OUTCOME_WON || tick != ticks - 1 )
+		{
+			return RUN_NOT_WON;
+		}
+		if( stats.score != run.claim.score || stats.energy != run.claim.energy || elapsedMs != run.claim.timeMs )
+		{
+			return RUN_WRONG_CLAIM;
+		}
+		return RUN_ACCEPTED;
+	}
+	return RUN_NOT_WON;
+}
@@ -0,0 +1,90 @@
+//Winning runs kept as the keys held on every tick, so a run can be played again without the game to check what it claims
+#ifndef RUN_LOG_HPP
+#define RUN_LOG_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "collision_grid.hpp"
+#include "flow_field.hpp"
+#include "leaderboard.hpp"
+#include "match.hpp"
+#include "race.hpp"
+#include "swarm.hpp"
+
+//Size and speed of the player's dot and where it starts, the game and a replay move it alike
+const int RUN_DOT_SIZE = 50;
+const int RUN_DOT_VEL = 15;
+const int RUN_START_X = 10496;
+const int RUN_START_Y = 32;
+
+//Longest run kept, ten minutes of ticks
+const int RUN_MAX_TICKS = 10 * 60 * TICKS_PER_SECOND;
+
+//Most chasers a kept run may have been played against
+const int RUN_MAX_CHASERS = 65536;
+
+//Most rounds a kept run may come from, so a faked log can only pick among the chasers a long session would have dealt anyway
+const int RUN_MAX_ROUNDS = 1000;
+
+//A run as submitted, what it claims, the round it was played in and the InputButtons held on each playing tick
+struct RunLog
+{
+    ScoreEntry claim;
+
+    //Round of the match, which the chasers are scattered from, and how many there were
+    int round;
+    int chasers;
+
+    std::vector<uint8_t> buttons;
+};
+
+//What playing a run again made of its claim
+enum RunVerdict
+{
+    RUN_ACCEPTED,
+
+    //The keys never reach the goal, or the run goes on past it
+    RUN_NOT_WON,
+
+    //A chaser catches the dot before the goal
+    RUN_CAUGHT,
+
+    //Played against another number of chasers than the board ranks, or in a round no session gets to
+    RUN_WRONG_ROUND,
+
+    //The keys win, but not with the score, energy or time claimed
+    RUN_WRONG_CLAIM
+};
+
+//Log file of the runs submitted on a level
+std::string runLogPath( std::string level );
+
+//Keys that give a dot its velocity
+uint8_t velocityButtons( int velX, int velY );
+
+//Opens or creates a log to append runs to, NULL if it cannot be written
+FILE* openRunLog( std::string path );
+
+//Appends a run and flushes it to disk
+bool appendRun( FILE* file, const RunLog& run );
+
+//Opens a log to read runs from, NULL if it is missing or not a run log
+FILE* readRunLog( std::string path );
+
+//Reads the next run, false at the end of the log or at a run still being written,
+//damaged runs in between are skipped and counted in damaged
+bool readRun( FILE* file, RunLog& run, int& damaged );
+
+//Sweeps a field created from the walls all the way to where the dot starts, once for every round's chasers to be scattered over
+void sweepSpawns( FlowField& spawns );
+
+//Starts a round's chasers as the game does, scattering the swarm over the swept spawns from the round
+void startChasers( FlowField& spawns, Swarm& swarm, int chasers, int round );
+
+//Plays a run's keys and its chasers from the start of a round as the game does and checks its claim against the board's number of chasers,
+//both fields have to be created from the walls and the spawns swept, the chase field and the swarm are only scratch, so each thread brings its own
+RunVerdict verifyRun( const RunLog& run, int chasers, CollisionGrid& walls, int levelWidth, int levelHeight, FlowField& spawns, FlowField& field, Swarm& swarm );
+
+#endif
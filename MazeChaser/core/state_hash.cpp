@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include "state_hash.hpp"
+
+uint32_t hashValue( uint32_t hash, int value )
+{
+	uint32_t bits = (uint32_t)value;
+	for( int i = 0; i < 4; ++i )
+	{
+		hash = ( hash ^ ( ( bits >> ( i * 8 ) ) & 0xff ) ) * 16777619u;
+	}
+	return hash;
+}
+
+StateHistory::StateHistory()
+{
+	reset();
+}
+
+void StateHistory::reset()
+{
+	for( int i = 0; i < HASH_HISTORY; ++i )
+	{
+		mStates[ i ].tick = -1;
+		mHashes[ i ] = 0;
+	}
+	mHash = HASH_SEED;
+}
+
+uint32_t StateHistory::record( const DotState& state )
+{
+	uint32_t hash = hashValue( mHash, state.tick );
+	hash = hashValue( hash, state.x );
+	hash = hashValue( hash, state.y );
+	hash = hashValue( hash, state.velX );
+	hash = hashValue( hash, state.velY );
+	hash = hashValue( hash, state.score );
+	hash = hashValue( hash, state.energy );
+	hash = hashValue( hash, state.zones );
+	mHash = hash;
+
+	int index = state.tick % HASH_HISTORY;
+	mStates[ index ] = state;
+	mHashes[ index ] = hash;
+
+	return hash;
+}
+
+bool StateHistory::find( int tick, DotState& state, uint32_t& hash )
+{
+	int index = tick % HASH_HISTORY;
+	if( tick < 0 || mStates[ index ].tick != tick )
+	{
+		return false;
+	}
+	state = mStates[ index ];
+	hash = mHashes[ index ];
+	return true;
+}
+
+void StateHistory::print( const char* who, int tick )
+{
+	DotState state;
+	uint32_t hash;
+	if( find( tick, state, hash ) )
+	{
+		printf( "%s tick %d: pos %d,%d vel %d,%d score %d energy %d zones %d hash %08x\n", who, state.tick, state.x, state.y, state.velX, state.velY, state.score, state.energy, state.zones, hash );
+	}
+	else
+	{
+		printf( "%s tick %d: no longer recorded\n", who, tick );
+	}
+}
@@ -0,0 +1,58 @@
+//Running hash of every step a dot takes, so two simulations can tell when they part ways
+#ifndef STATE_HASH_HPP
+#define STATE_HASH_HPP
+
+#include <stdint.h>
+
+//Steps remembered for comparing against a late report
+const int HASH_HISTORY = 256;
+
+//Ticks between reports from a client
+const int HASH_INTERVAL = 30;
+
+//Hash of a round before its first step
+const uint32_t HASH_SEED = 2166136261u;
+
+//Folds one value into a hash, FNV-1a over its bytes in a fixed order so every machine agrees
+uint32_t hashValue( uint32_t hash, int value );
+
+//Everything one step decided about a dot
+struct DotState
+{
+    int tick;
+    int x, y;
+    int velX, velY;
+    int score;
+    int energy;
+
+    //ZoneFlags hit by the step
+    int zones;
+};
+
+class StateHistory
+{
+    public:
+        //Initializes variables
+        StateHistory();
+
+        //Starts a new round
+        void reset();
+
+        //Folds a step into the running hash and returns the hash after it
+        uint32_t record( const DotState& state );
+
+        //The step and running hash recorded at a tick, false if it has been overwritten
+        bool find( int tick, DotState& state, uint32_t& hash );
+
+        //Prints a recorded step, or that it is gone
+        void print( const char* who, int tick );
+
+    private:
+        DotState mStates[ HASH_HISTORY ];
+        uint32_t mHashes[ HASH_HISTORY ];
+
+        //Hash after the latest step
+        uint32_t mHash;
+};
+
+#endif
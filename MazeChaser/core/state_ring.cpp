@@ -0,0 +1,83 @@
+#include <string.h>
+#include "state_ring.hpp"
+
+StateRing::StateRing()
+{
+	mStateSize = 0;
+	mCapacity = 0;
+}
+
+void StateRing::create( int stateSize, int capacity )
+{
+	mStateSize = stateSize;
+	mCapacity = capacity;
+	mStates.resize( stateSize * capacity );
+	mTicks.resize( capacity );
+	clear();
+}
+
+void StateRing::clear()
+{
+	for( int i = 0; i < mCapacity; ++i )
+	{
+		mTicks[ i ] = -1;
+	}
+}
+
+void StateRing::save( int tick, const void* state )
+{
+	uint8_t* slot = claim( tick );
+	if( slot != NULL )
+	{
+		memcpy( slot, state, mStateSize );
+	}
+}
+
+bool StateRing::restore( int tick, void* state )
+{
+	const uint8_t* slot = find( tick );
+	if( slot == NULL )
+	{
+		return false;
+	}
+
+	memcpy( state, slot, mStateSize );
+	return true;
+}
+
+bool StateRing::has( int tick )
+{
+	return mCapacity > 0 && tick >= 0 && mTicks[ tick % mCapacity ] == tick;
+}
+
+uint8_t* StateRing::claim( int tick )
+{
+	if( mCapacity == 0 || tick < 0 )
+	{
+		return NULL;
+	}
+
+	//The slot is the tick's from now on, whatever was in it before
+	mTicks[ tick % mCapacity ] = tick;
+	return mStates.data() + ( tick % mCapacity ) * mStateSize;
+}
+
+const uint8_t* StateRing::find( int tick )
+{
+	if( !has( tick ) )
+	{
+		return NULL;
+	}
+
+	return mStates.data() + ( tick % mCapacity ) * mStateSize;
+}
+
+int StateRing::getStateSize()
+{
+	return mStateSize;
+}
+
+int StateRing::getCapacity()
+{
+	return mCapacity;
+}
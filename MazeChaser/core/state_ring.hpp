@@ -0,0 +1,48 @@
+//The last few ticks of a simulation's state, each saved and restored with a single copy
+#ifndef STATE_RING_HPP
+#define STATE_RING_HPP
+
+#include <stdint.h>
+#include <vector>
+
+class StateRing
+{
+    public:
+        //Initializes variables
+        StateRing();
+
+        //Makes room for capacity states of stateSize bytes each and forgets every saved one
+        void create( int stateSize, int capacity );
+
+        //Forgets every saved state
+        void clear();
+
+        //Copies the state of a tick in, over the one capacity ticks older
+        void save( int tick, const void* state );
+
+        //Copies the state of a tick out, false if it was never saved or has been overwritten
+        bool restore( int tick, void* state );
+
+        //Whether the state of a tick is still held
+        bool has( int tick );
+
+        //Slot for a tick's state, for state that writes itself in rather than being copied whole
+        uint8_t* claim( int tick );
+
+        //Saved state of a tick, NULL if it was never saved or has been overwritten
+        const uint8_t* find( int tick );
+
+        //Ring accessors
+        int getStateSize();
+        int getCapacity();
+
+    private:
+        int mStateSize;
+        int mCapacity;
+
+        //State of tick t in slot t % mCapacity, and the tick each slot holds
+        std::vector<uint8_t> mStates;
+        std::vector<int> mTicks;
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include <string.h>
+#include "swarm.hpp"
+
+//Moves a value at most step towards zero
+static int clampStep( int offset, int step )
+{
+	return offset > step ? step : ( offset < -step ? -step : offset );
+}
+
+Swarm::Swarm()
+{
+	mSize = 1;
+}
+
+int Swarm::spawn( FlowField& field, int count, int minDistance, uint32_t seed )
+{
+	clear();
+	mSize = field.getCellSize();
+	mPosX.reserve( count );
+	mPosY.reserve( count );
+
+	//Xorshift, so a seed always gives the same swarm
+	uint32_t state = seed != 0 ? seed : 1;
+	int cells = field.getColumns() * field.getRows();
+	for( int attempt = 0; attempt < count * 64 && (int)mPosX.size() < count && cells > 0; ++attempt )
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		//Only cells the field reaches, so every chaser has a way to the target
+		int cell = state % cells;
+		int column = cell % field.getColumns();
+		int row = cell / field.getColumns();
+		if( field.getDistance( column, row ) >= minDistance )
+		{
+			mPosX.push_back( column * mSize );
+			mPosY.push_back( row * mSize );
+		}
+	}
+	mEyeX.resize( mPosX.size() );
+	mEyeY.resize( mPosY.size() );
+	mSees.assign( mPosX.size(), 0 );
+	mHunting.assign( mPosX.size(), 0 );
+
+	return mPosX.size();
+}
+
+void Swarm::clear()
+{
+	mPosX.clear();
+	mPosY.clear();
+	mEyeX.clear();
+	mEyeY.clear();
+	mSees.clear();
+	mHunting.clear();
+}
+
+int Swarm::look( CollisionGrid& walls, int x, int y, int range )
+{
+	int count = mPosX.size();
+	int half = mSize / 2;
+	for( int i = 0; i < count; ++i )
+	{
+		mEyeX[ i ] = mPosX[ i ] + half;
+		mEyeY[ i ] = mPosY[ i ] + half;
+	}
+
+	//One batch for the whole swarm, chasers out of range cost a distance check
+	int seen = castRaysTo( walls, x, y, mEyeX.data(), mEyeY.data(), count, range, mSees.data() );
+	for( int i = 0; i < count; ++i )
+	{
+		mHunting[ i ] |= mSees[ i ];
+	}
+	return seen;
+}
+
+void Swarm::chase( FlowField& field, int x, int y )
+{
+	int columns = field.getColumns();
+	int count = mPosX.size();
+	int* posX = mPosX.data();
+	int* posY = mPosY.data();
+	uint8_t* hunting = mHunting.data();
+	int half = mSize / 2;
+
+	//Chasers that are only waiting never move, so a swarm with no hunters costs no sweep
+	mGoals.clear();
+	for( int i = 0; i < count; ++i )
+	{
+		if( hunting[ i ] )
+		{
+			mGoals.push_back( ( posY[ i ] + half ) / mSize * columns + ( posX[ i ] + half ) / mSize );
+		}
+	}
+	if( mGoals.empty() )
+	{
+		return;
+	}
+	field.sweep( x / mSize, y / mSize, FLOW_REACH, mGoals.data(), mGoals.size() );
+
+	const uint8_t* directions = field.getDirections();
+	for( int i = 0; i < count; ++i )
+	{
+		//The cell under the chaser's centre and how far the chaser is off it
+		int column = ( posX[ i ] + half ) / mSize;
+		int row = ( posY[ i ] + half ) / mSize;
+		int offsetX = posX[ i ] - column * mSize;
+		int offsetY = posY[ i ] - row * mSize;
+		int direction = hunting[ i ] ? directions[ row * columns + column ] : (int)FLOW_NONE;
+
+		//Left behind, it waits until it sees the dot again
+		if( hunting[ i ] && direction == FLOW_NONE && field.getDistance( column, row ) != 0 )
+		{
+			hunting[ i ] = 0;
+		}
+		int stepX = FLOW_STEP_X[ direction ];
+		int stepY = FLOW_STEP_Y[ direction ];
+
+		//Line up with the row or column first, so a chaser only ever spans open cells
+		posX[ i ] += stepX != 0 ? ( offsetY == 0 ? stepX * CHASER_VEL : 0 ) : ( stepY != 0 ? clampStep( -offsetX, CHASER_VEL ) : 0 );
+		posY[ i ] += stepY != 0 ? ( offsetX == 0 ? stepY * CHASER_VEL : 0 ) : ( stepX != 0 ? clampStep( -offsetY, CHASER_VEL ) : 0 );
+	}
+}
+
+int Swarm::touching( int x, int y, int w, int h )
+{
+	int count = mPosX.size();
+	const int* posX = mPosX.data();
+	const int* posY = mPosY.data();
+
+	int hits = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		hits += posX[ i ] < x + w && posX[ i ] + mSize > x && posY[ i ] < y + h && posY[ i ] + mSize > y;
+	}
+	return hits;
+}
+
+int Swarm::getStateSize()
+{
+	return mPosX.size() * ( 2 * sizeof( int ) + 1 );
+}
+
+void Swarm::saveState( uint8_t* data )
+{
+	//Each array as one block, what a chaser sees is worked out again every tick
+	int count = mPosX.size();
+	if( count == 0 )
+	{
+		return;
+	}
+	memcpy( data, mPosX.data(), count * sizeof( int ) );
+	memcpy( data + count * sizeof( int ), mPosY.data(), count * sizeof( int ) );
+	memcpy( data + 2 * count * sizeof( int ), mHunting.data(), count );
+}
+
+void Swarm::restoreState( const uint8_t* data )
+{
+	int count = mPosX.size();
+	if( count == 0 )
+	{
+		return;
+	}
+	memcpy( mPosX.data(), data, count * sizeof( int ) );
+	memcpy( mPosY.data(), data + count * sizeof( int ), count * sizeof( int ) );
+	memcpy( mHunting.data(), data + 2 * count * sizeof( int ), count );
+}
+
+int Swarm::getCount()
+{
+	return mPosX.size();
+}
+
+int Swarm::getSize()
+{
+	return mSize;
+}
+
+int Swarm::getPosX( int i )
+{
+	return mPosX[ i ];
+}
+
+int Swarm::getPosY( int i )
+{
+	return mPosY[ i ];
+}
+
+bool Swarm::isHunting( int i )
+{
+	return mHunting[ i ];
+}
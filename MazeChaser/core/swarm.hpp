@@ -0,0 +1,75 @@
+//Chasers that run down a flow field, kept as parallel arrays so one pass moves them all
+#ifndef SWARM_HPP
+#define SWARM_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "flow_field.hpp"
+#include "line_of_sight.hpp"
+
+//Pixels a chaser moves per tick, no more than a cell
+const int CHASER_VEL = 4;
+
+//Chasers in a round unless asked for more or fewer
+const int CHASER_COUNT = 500;
+
+//Fewest steps from the target a chaser may spawn at
+const int CHASER_SPAWN_DISTANCE = 96;
+
+//Pixels a chaser can see the dot from
+const int CHASER_SIGHT = 640;
+
+class Swarm
+{
+    public:
+        //Initializes variables
+        Swarm();
+
+        //Scatters chasers over open cells at least minDistance steps from the field's target, returns how many found room
+        int spawn( FlowField& field, int count, int minDistance, uint32_t seed );
+
+        //Removes every chaser
+        void clear();
+
+        //Checks which chasers can see the point, those that do start hunting, returns how many see it
+        int look( CollisionGrid& walls, int x, int y, int range );
+
+        //Sweeps the field out from the point only as far as the hunting chasers and moves them one tick along it,
+        //nothing is swept while none hunt and a chaser the sweep cannot reach within FLOW_REACH stops hunting
+        void chase( FlowField& field, int x, int y );
+
+        //Number of chasers overlapping the box
+        int touching( int x, int y, int w, int h );
+
+        //Bytes saveState writes, enough for where every chaser is and whether it hunts
+        int getStateSize();
+
+        //Copies what ticks change into data, or back out of it
+        void saveState( uint8_t* data );
+        void restoreState( const uint8_t* data );
+
+        //Swarm accessors, chasers are one cell square
+        int getCount();
+        int getSize();
+        int getPosX( int i );
+        int getPosY( int i );
+        bool isHunting( int i );
+
+    private:
+        int mSize;
+
+        //Top left corner of each chaser
+        std::vector<int> mPosX;
+        std::vector<int> mPosY;
+
+        //Centre of each chaser, what it saw this tick and whether it is still on the dot's trail
+        std::vector<int> mEyeX;
+        std::vector<int> mEyeY;
+        std::vector<uint8_t> mSees;
+        std::vector<uint8_t> mHunting;
+
+        //Cells of the hunting chasers, where this tick's sweep has to get to
+        std::vector<int> mGoals;
+};
+
+#endif
@@ -0,0 +1,289 @@
+//Level compiler, merges the walls of a level and cuts their union back into as few rectangles as it can
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "level.hpp"
+
+//Walls laid on a grid that is cut at every wall edge
+struct WallGrid
+{
+	std::vector<int> xs;
+	std::vector<int> ys;
+
+	//Walls covering each cell, row by row
+	std::vector<int> cover;
+};
+
+//Cuts the grid at the edges of one set of walls and counts how often another set covers each cell
+void buildGrid( const std::vector<LevelRect>& edges, const std::vector<LevelRect>& walls, WallGrid& grid );
+
+//Lists walls that other walls already cover, walls that overlap and walls that could be one
+void reportRedundant( const std::vector<LevelRect>& walls );
+
+//Cuts the covered cells into rectangles sweeping along rows or columns, then merges neighbours that line up
+std::vector<LevelRect> decompose( const WallGrid& grid, bool byRows );
+
+//Joins rectangles that share a whole edge until none do
+void mergeNeighbours( std::vector<LevelRect>& rects );
+
+//Whether two sets of walls cover the same area and the second never overlaps itself
+bool sameUnion( const std::vector<LevelRect>& walls, const std::vector<LevelRect>& compiled );
+
+void buildGrid( const std::vector<LevelRect>& edges, const std::vector<LevelRect>& walls, WallGrid& grid )
+{
+	grid.xs.clear();
+	grid.ys.clear();
+	for( size_t i = 0; i < edges.size(); ++i )
+	{
+		grid.xs.push_back( edges[ i ].x );
+		grid.xs.push_back( edges[ i ].x + edges[ i ].w );
+		grid.ys.push_back( edges[ i ].y );
+		grid.ys.push_back( edges[ i ].y + edges[ i ].h );
+	}
+	std::sort( grid.xs.begin(), grid.xs.end() );
+	grid.xs.erase( std::unique( grid.xs.begin(), grid.xs.end() ), grid.xs.end() );
+	std::sort( grid.ys.begin(), grid.ys.end() );
+	grid.ys.erase( std::unique( grid.ys.begin(), grid.ys.end() ), grid.ys.end() );
+
+	int columns = grid.xs.size() - 1;
+	grid.cover.assign( columns * ( grid.ys.size() - 1 ), 0 );
+	for( size_t i = 0; i < walls.size(); ++i )
+	{
+		int left = std::lower_bound( grid.xs.begin(), grid.xs.end(), walls[ i ].x ) - grid.xs.begin();
+		int right = std::lower_bound( grid.xs.begin(), grid.xs.end(), walls[ i ].x + walls[ i ].w ) - grid.xs.begin();
+		int top = std::lower_bound( grid.ys.begin(), grid.ys.end(), walls[ i ].y ) - grid.ys.begin();
+		int bottom = std::lower_bound( grid.ys.begin(), grid.ys.end(), walls[ i ].y + walls[ i ].h ) - grid.ys.begin();
+		for( int row = top; row < bottom; ++row )
+		{
+			for( int column = left; column < right; ++column )
+			{
+				++grid.cover[ row * columns + column ];
+			}
+		}
+	}
+}
+
+void reportRedundant( const std::vector<LevelRect>& walls )
+{
+	WallGrid grid;
+	buildGrid( walls, walls, grid );
+	int columns = grid.xs.size() - 1;
+
+	//A wall is redundant when every cell of it has another wall on it, taking redundant walls out as they are found
+	for( size_t i = 0; i < walls.size(); ++i )
+	{
+		int left = std::lower_bound( grid.xs.begin(), grid.xs.end(), walls[ i ].x ) - grid.xs.begin();
+		int right = std::lower_bound( grid.xs.begin(), grid.xs.end(), walls[ i ].x + walls[ i ].w ) - grid.xs.begin();
+		int top = std::lower_bound( grid.ys.begin(), grid.ys.end(), walls[ i ].y ) - grid.ys.begin();
+		int bottom = std::lower_bound( grid.ys.begin(), grid.ys.end(), walls[ i ].y + walls[ i ].h ) - grid.ys.begin();
+
+		bool covered = true;
+		for( int row = top; row < bottom && covered; ++row )
+		{
+			for( int column = left; column < right && covered; ++column )
+			{
+				covered = grid.cover[ row * columns + column ] > 1;
+			}
+		}
+
+		if( covered )
+		{
+			printf( "wall %d is covered by other walls\n", (int)i + 1 );
+			for( int row = top; row < bottom; ++row )
+			{
+				for( int column = left; column < right; ++column )
+				{
+					--grid.cover[ row * columns + column ];
+				}
+			}
+		}
+	}
+
+	for( size_t i = 0; i < walls.size(); ++i )
+	{
+		const LevelRect& a = walls[ i ];
+		for( size_t j = i + 1; j < walls.size(); ++j )
+		{
+			const LevelRect& b = walls[ j ];
+			int overlapW = std::min( a.x + a.w, b.x + b.w ) - std::max( a.x, b.x );
+			int overlapH = std::min( a.y + a.h, b.y + b.h ) - std::max( a.y, b.y );
+			if( overlapW > 0 && overlapH > 0 )
+			{
+				printf( "walls %d and %d overlap by %dx%d\n", (int)i + 1, (int)j + 1, overlapW, overlapH );
+			}
+			else if( ( a.x == b.x && a.w == b.w && ( a.y + a.h == b.y || b.y + b.h == a.y ) ) || ( a.y == b.y && a.h == b.h && ( a.x + a.w == b.x || b.x + b.w == a.x ) ) )
+			{
+				printf( "walls %d and %d share an edge and could be one\n", (int)i + 1, (int)j + 1 );
+			}
+		}
+	}
+}
+
+std::vector<LevelRect> decompose( const WallGrid& grid, bool byRows )
+{
+	int columns = grid.xs.size() - 1;
+	int rows = grid.ys.size() - 1;
+
+	//Sweep with i along the chosen direction and j across it
+	int spanI = byRows ? columns : rows;
+	int spanJ = byRows ? rows : columns;
+	std::vector<bool> used( grid.cover.size(), false );
+
+	std::vector<LevelRect> rects;
+	for( int j = 0; j < spanJ; ++j )
+	{
+		for( int i = 0; i < spanI; ++i )
+		{
+			int cell = byRows ? j * columns + i : i * columns + j;
+			if( grid.cover[ cell ] == 0 || used[ cell ] )
+			{
+				continue;
+			}
+
+			//Run as far as the sweep goes, then grow across while the whole run is free
+			int endI = i;
+			while( endI < spanI )
+			{
+				int next = byRows ? j * columns + endI : endI * columns + j;
+				if( grid.cover[ next ] == 0 || used[ next ] )
+				{
+					break;
+				}
+				++endI;
+			}
+
+			int endJ = j + 1;
+			while( endJ < spanJ )
+			{
+				bool free = true;
+				for( int k = i; k < endI && free; ++k )
+				{
+					int next = byRows ? endJ * columns + k : k * columns + endJ;
+					free = grid.cover[ next ] > 0 && !used[ next ];
+				}
+				if( !free )
+				{
+					break;
+				}
+				++endJ;
+			}
+
+			for( int b = j; b < endJ; ++b )
+			{
+				for( int a = i; a < endI; ++a )
+				{
+					used[ byRows ? b * columns + a : a * columns + b ] = true;
+				}
+			}
+
+			int left = byRows ? i : j;
+			int right = byRows ? endI : endJ;
+			int top = byRows ? j : i;
+			int bottom = byRows ? endJ : endI;
+			LevelRect rect = { grid.xs[ left ], grid.ys[ top ], grid.xs[ right ] - grid.xs[ left ], grid.ys[ bottom ] - grid.ys[ top ] };
+			rects.push_back( rect );
+		}
+	}
+
+	mergeNeighbours( rects );
+
+	return rects;
+}
+
+void mergeNeighbours( std::vector<LevelRect>& rects )
+{
+	bool merged = true;
+	while( merged )
+	{
+		merged = false;
+		for( size_t a = 0; a < rects.size() && !merged; ++a )
+		{
+			for( size_t b = a + 1; b < rects.size() && !merged; ++b )
+			{
+				LevelRect& first = rects[ a ];
+				const LevelRect& second = rects[ b ];
+				if( first.x == second.x && first.w == second.w && ( first.y + first.h == second.y || second.y + second.h == first.y ) )
+				{
+					first.y = std::min( first.y, second.y );
+					first.h += second.h;
+					merged = true;
+				}
+				else if( first.y == second.y && first.h == second.h && ( first.x + first.w == second.x || second.x + second.w == first.x ) )
+				{
+					first.x = std::min( first.x, second.x );
+					first.w += second.w;
+					merged = true;
+				}
+				if( merged )
+				{
+					rects.erase( rects.begin() + b );
+				}
+			}
+		}
+	}
+}
+
+bool sameUnion( const std::vector<LevelRect>& walls, const std::vector<LevelRect>& compiled )
+{
+	//Cut at the edges of both so every cell is wholly in or out of each
+	std::vector<LevelRect> edges = walls;
+	edges.insert( edges.end(), compiled.begin(), compiled.end() );
+
+	WallGrid before, after;
+	buildGrid( edges, walls, before );
+	buildGrid( edges, compiled, after );
+	for( size_t i = 0; i < before.cover.size(); ++i )
+	{
+		if( ( before.cover[ i ] > 0 ) != ( after.cover[ i ] > 0 ) || after.cover[ i ] > 1 )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( int argc, char* args[] )
+{
+	if( argc != 3 )
+	{
+		printf( "Usage: levelc <walls> <level>\n" );
+		return 1;
+	}
+
+	Level source;
+	if( !loadLevel( args[ 1 ], source ) )
+	{
+		return 1;
+	}
+	if( source.walls.empty() )
+	{
+		printf( "%s has no walls!\n", args[ 1 ] );
+		return 1;
+	}
+
+	reportRedundant( source.walls );
+
+	//Keep whichever way cuts the union into fewer pieces
+	WallGrid grid;
+	buildGrid( source.walls, source.walls, grid );
+	std::vector<LevelRect> byRows = decompose( grid, true );
+	std::vector<LevelRect> byColumns = decompose( grid, false );
+
+	Level compiled = source;
+	compiled.walls = byRows.size() <= byColumns.size() ? byRows : byColumns;
+	if( !sameUnion( source.walls, compiled.walls ) )
+	{
+		printf( "Compiled walls do not match the source, nothing written!\n" );
+		return 1;
+	}
+
+	std::string comment = std::string( "Compiled by levelc from " ) + args[ 1 ] + ", edit that instead";
+	if( !saveLevel( args[ 2 ], compiled, comment ) )
+	{
+		return 1;
+	}
+	printf( "%d walls in, %d out\n", (int)source.walls.size(), (int)compiled.walls.size() );
+
+	return 0;
+}
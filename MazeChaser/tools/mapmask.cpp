@@ -0,0 +1,169 @@
+//Collision extraction, turns the walls drawn on a map image into a collision mask and a level
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "collision_grid.hpp"
+#include "level.hpp"
+
+//What makes a pixel part of a wall
+struct WallColor
+{
+	//Match on alpha alone, or on colour within a tolerance
+	bool byAlpha;
+	int alpha;
+	Uint8 r, g, b;
+	int tolerance;
+};
+
+//Prints the options
+void usage();
+
+//Whether an ARGB pixel is a wall pixel
+bool isWall( Uint32 pixel, const WallColor& color );
+
+void usage()
+{
+	printf( "Usage: mapmask [-c rrggbb] [-t tolerance] [-a alpha] [-s cell] [-f percent] <map image> <mask> <level>\n" );
+	printf( "  -c  wall colour, 000000 by default\n" );
+	printf( "  -t  largest difference per channel that still matches the colour, 16 by default\n" );
+	printf( "  -a  use alpha instead, pixels at least this opaque are walls\n" );
+	printf( "  -s  cell size in pixels, 32 by default\n" );
+	printf( "  -f  share of a cell's pixels that make it solid, 50 by default\n" );
+}
+
+bool isWall( Uint32 pixel, const WallColor& color )
+{
+	int a = ( pixel >> 24 ) & 0xff;
+	if( color.byAlpha )
+	{
+		return a >= color.alpha;
+	}
+
+	int r = ( pixel >> 16 ) & 0xff;
+	int g = ( pixel >> 8 ) & 0xff;
+	int b = pixel & 0xff;
+	return a > 0 && abs( r - color.r ) <= color.tolerance && abs( g - color.g ) <= color.tolerance && abs( b - color.b ) <= color.tolerance;
+}
+
+int main( int argc, char* args[] )
+{
+	WallColor color = { false, 0, 0, 0, 0, 16 };
+	int cellSize = 32;
+	int percent = 50;
+
+	int arg = 1;
+	while( arg + 1 < argc && args[ arg ][ 0 ] == '-' )
+	{
+		const char* option = args[ arg ];
+		const char* value = args[ arg + 1 ];
+		if( strcmp( option, "-c" ) == 0 && strlen( value ) == 6 )
+		{
+			unsigned long rgb = strtoul( value, NULL, 16 );
+			color.r = ( rgb >> 16 ) & 0xff;
+			color.g = ( rgb >> 8 ) & 0xff;
+			color.b = rgb & 0xff;
+		}
+		else if( strcmp( option, "-t" ) == 0 )
+		{
+			color.tolerance = atoi( value );
+		}
+		else if( strcmp( option, "-a" ) == 0 )
+		{
+			color.byAlpha = true;
+			color.alpha = atoi( value );
+		}
+		else if( strcmp( option, "-s" ) == 0 )
+		{
+			cellSize = atoi( value );
+		}
+		else if( strcmp( option, "-f" ) == 0 )
+		{
+			percent = atoi( value );
+		}
+		else
+		{
+			usage();
+			return 1;
+		}
+		arg += 2;
+	}
+	if( argc - arg != 3 || cellSize <= 0 || percent <= 0 || percent > 100 )
+	{
+		usage();
+		return 1;
+	}
+
+	//Load the map as plain ARGB pixels
+	if( IMG_Init( IMG_INIT_PNG ) == 0 )
+	{
+		printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+		return 1;
+	}
+	SDL_Surface* loadedSurface = IMG_Load( args[ arg ] );
+	if( loadedSurface == NULL )
+	{
+		printf( "Unable to load image %s! SDL_image Error: %s\n", args[ arg ], IMG_GetError() );
+		IMG_Quit();
+		return 1;
+	}
+	SDL_Surface* map = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0 );
+	SDL_FreeSurface( loadedSurface );
+	if( map == NULL )
+	{
+		printf( "Unable to convert %s! SDL Error: %s\n", args[ arg ], SDL_GetError() );
+		IMG_Quit();
+		return 1;
+	}
+
+	//Count the wall pixels in every cell
+	CollisionGrid grid;
+	grid.create( map->w, map->h, cellSize );
+	std::vector<int> counts( grid.getColumns() * grid.getRows(), 0 );
+	for( int y = 0; y < map->h; ++y )
+	{
+		const Uint32* pixels = (const Uint32*)( (const Uint8*)map->pixels + y * map->pitch );
+		int* rowCounts = &counts[ ( y / cellSize ) * grid.getColumns() ];
+		for( int x = 0; x < map->w; ++x )
+		{
+			if( isWall( pixels[ x ], color ) )
+			{
+				++rowCounts[ x / cellSize ];
+			}
+		}
+	}
+
+	//A cell is solid when enough of the pixels it has on the map are walls
+	int solid = 0;
+	for( int row = 0; row < grid.getRows(); ++row )
+	{
+		for( int column = 0; column < grid.getColumns(); ++column )
+		{
+			int cellW = ( column + 1 ) * cellSize <= map->w ? cellSize : map->w - column * cellSize;
+			int cellH = ( row + 1 ) * cellSize <= map->h ? cellSize : map->h - row * cellSize;
+			if( counts[ row * grid.getColumns() + column ] * 100 >= cellW * cellH * percent )
+			{
+				grid.setSolid( column, row, true );
+				++solid;
+			}
+		}
+	}
+
+	Level level;
+	level.width = map->w;
+	level.height = map->h;
+	level.walls = grid.toRects();
+	SDL_FreeSurface( map );
+	IMG_Quit();
+
+	std::string comment = std::string( "Extracted by mapmask from " ) + args[ arg ];
+	if( !grid.save( args[ arg + 1 ] ) || !saveLevel( args[ arg + 2 ], level, comment ) )
+	{
+		return 1;
+	}
+	printf( "%d of %d cells solid, %d walls\n", solid, grid.getColumns() * grid.getRows(), (int)level.walls.size() );
+
+	return 0;
+}
@@ -0,0 +1,196 @@
+//Run verifier, plays submitted runs again on every core and ranks only the ones that earn what they claim
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "collision_grid.hpp"
+#include "flow_field.hpp"
+#include "leaderboard.hpp"
+#include "level.hpp"
+#include "run_log.hpp"
+#include "swarm.hpp"
+
+//Most runs read from the log and checked together
+const int VERIFY_BATCH = 1024;
+
+//Runs a worker takes at a time, a run with its chasers is slow enough that the workers rarely meet on the counter
+const int VERIFY_CHUNK = 1;
+
+//Seconds between looks at a log being followed
+const int VERIFY_POLL_SECONDS = 1;
+
+//Runs being checked, each worker takes the next chunk until none are left
+struct VerifyBatch
+{
+	std::vector<RunLog> runs;
+	int count;
+	std::vector<uint8_t> verdicts;
+	std::atomic<int> next;
+};
+
+//Checks chunks of the batch until it is done
+void verifyRuns( VerifyBatch& batch, int chasers, CollisionGrid& walls, int levelWidth, int levelHeight )
+{
+	//Each worker scatters and chases with its own fields and swarm
+	FlowField spawns;
+	spawns.create( walls );
+	sweepSpawns( spawns );
+	FlowField field;
+	field.create( walls );
+	Swarm swarm;
+
+	for( int first = batch.next.fetch_add( VERIFY_CHUNK ); first < batch.count; first = batch.next.fetch_add( VERIFY_CHUNK ) )
+	{
+		int last = first + VERIFY_CHUNK < batch.count ? first + VERIFY_CHUNK : batch.count;
+		for( int i = first; i < last; ++i )
+		{
+			batch.verdicts[ i ] = verifyRun( batch.runs[ i ], chasers, walls, levelWidth, levelHeight, spawns, field, swarm );
+		}
+	}
+}
+
+int main( int argc, char* args[] )
+{
+	std::string runsPath = runLogPath( "campus" );
+	std::string levelPath = "../levels/campus.lvl";
+	std::string boardPath;
+	int threads = std::thread::hardware_concurrency();
+	int chasers = CHASER_COUNT;
+	bool follow = false;
+	for( int i = 1; i < argc; ++i )
+	{
+		bool value = i + 1 < argc;
+		if( strcmp( args[ i ], "-l" ) == 0 && value ) levelPath = args[ ++i ];
+		else if( strcmp( args[ i ], "-b" ) == 0 && value ) boardPath = args[ ++i ];
+		else if( strcmp( args[ i ], "-j" ) == 0 && value ) threads = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-c" ) == 0 && value ) chasers = atoi( args[ ++i ] );
+		else if( strcmp( args[ i ], "-f" ) == 0 ) follow = true;
+		else if( args[ i ][ 0 ] != '-' ) runsPath = args[ i ];
+		else
+		{
+			fprintf( stderr, "Usage: %s [runs] [-l level] [-b board] [-c chasers] [-j threads] [-f]\n", args[ 0 ] );
+			return 1;
+		}
+	}
+	if( threads < 1 )
+	{
+		threads = 1;
+	}
+
+	//The walls every run collides against, shared read only by the workers
+	Level level;
+	if( !loadLevel( levelPath, level ) )
+	{
+		return 1;
+	}
+	CollisionGrid walls;
+	walls.build( level, COLLISION_CELL );
+
+	FILE* runs = readRunLog( runsPath );
+	if( runs == NULL )
+	{
+		return 1;
+	}
+	Leaderboard board;
+	if( boardPath.size() > 0 && !board.open( boardPath ) )
+	{
+		fclose( runs );
+		return 1;
+	}
+
+	//Runs are read into the same slots every batch, so their keys reuse the memory of the last one
+	VerifyBatch batch;
+	batch.runs.resize( VERIFY_BATCH );
+	batch.verdicts.resize( VERIFY_BATCH );
+	std::vector<ScoreEntry> accepted;
+	long long totals[ 5 ] = {};
+	int damaged = 0;
+	while( true )
+	{
+		batch.count = 0;
+		long long ticks = 0;
+		int damagedBefore = damaged;
+		while( batch.count < VERIFY_BATCH && readRun( runs, batch.runs[ batch.count ], damaged ) )
+		{
+			ticks += batch.runs[ batch.count ].buttons.size();
+			++batch.count;
+		}
+		if( damaged > damagedBefore )
+		{
+			printf( "Skipped %d damaged runs in %s\n", damaged - damagedBefore, runsPath.c_str() );
+		}
+		if( batch.count == 0 )
+		{
+			if( !follow )
+			{
+				break;
+			}
+			sleep( VERIFY_POLL_SECONDS );
+			continue;
+		}
+
+		//Every core plays its share, nothing is drawn and no clock is waited on
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		batch.next = 0;
+		std::vector<std::thread> workers;
+		for( int i = 0; i < threads; ++i )
+		{
+			workers.push_back( std::thread( verifyRuns, std::ref( batch ), chasers, std::ref( walls ), level.width, level.height ) );
+		}
+		for( int i = 0; i < threads; ++i )
+		{
+			workers[ i ].join();
+		}
+		double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+		//Rank what was earned and report what was not
+		int counts[ 5 ] = {};
+		accepted.clear();
+		for( int i = 0; i < batch.count; ++i )
+		{
+			const RunLog& run = batch.runs[ i ];
+			++counts[ batch.verdicts[ i ] ];
+			if( batch.verdicts[ i ] == RUN_ACCEPTED )
+			{
+				accepted.push_back( run.claim );
+			}
+			else
+			{
+				const char* reason = "the keys win with a different result";
+				if( batch.verdicts[ i ] == RUN_NOT_WON ) reason = "the keys do not win";
+				if( batch.verdicts[ i ] == RUN_CAUGHT ) reason = "a chaser catches the dot";
+				if( batch.verdicts[ i ] == RUN_WRONG_ROUND ) reason = "not played in a round this board ranks";
+				printf( "Rejected %s claiming %d with %d energy in %u ms against %d chasers in round %d: %s\n", run.claim.player.c_str(), run.claim.score, run.claim.energy, run.claim.timeMs,
+					run.chasers, run.round, reason );
+			}
+		}
+		if( boardPath.size() > 0 && accepted.size() > 0 && !board.submitAll( accepted ) )
+		{
+			break;
+		}
+
+		printf( "Checked %d runs in %.1f ms on %d threads, %d accepted, %d not won, %d caught, %d wrong rounds, %d wrong claims, %.0f runs/s, %.0fx real time\n",
+			batch.count, seconds * 1000, threads, counts[ RUN_ACCEPTED ], counts[ RUN_NOT_WON ], counts[ RUN_CAUGHT ], counts[ RUN_WRONG_ROUND ], counts[ RUN_WRONG_CLAIM ],
+			batch.count / seconds, ticks / ( seconds * TICKS_PER_SECOND ) );
+		fflush( stdout );
+		for( int i = 0; i < 5; ++i )
+		{
+			totals[ i ] += counts[ i ];
+		}
+	}
+
+	//Anything left unread is a run cut short at the end
+	if( !feof( runs ) && fgetc( runs ) != EOF )
+	{
+		printf( "Stopped at a torn run at the end of %s\n", runsPath.c_str() );
+	}
+	printf( "%lld runs accepted, %lld not won, %lld caught, %lld in wrong rounds, %lld with wrong claims, %d damaged\n",
+		totals[ RUN_ACCEPTED ], totals[ RUN_NOT_WON ], totals[ RUN_CAUGHT ], totals[ RUN_WRONG_ROUND ], totals[ RUN_WRONG_CLAIM ], damaged );
+	fclose( runs );
+	return 0;
+}